@@ -0,0 +1,50 @@
+uniform sampler2D u_texture;
+
+layout(std140) uniform Imm
+{
+    mat4 u_projection;
+    mat4 u_view;
+    mat4 u_model;
+    bool u_usetex;
+};
+
+layout(std140) uniform Kawase
+{
+    vec4 u_kawase; // x = offset
+};
+
+#ifdef VERT_SHADER /*/////////////////////////////////////////////////////////*/
+
+layout (location = 0) in vec4 i_position;
+layout (location = 3) in vec4 i_texcoord;
+
+out vec2 v_texcoord;
+
+void main()
+{
+    gl_Position = u_projection * u_view * u_model * i_position;
+    v_texcoord = i_texcoord.xy;
+}
+
+#endif /* VERT_SHADER ////////////////////////////////////////////////////////*/
+
+#ifdef FRAG_SHADER /*/////////////////////////////////////////////////////////*/
+
+in vec2 v_texcoord;
+
+out vec4 o_fragcolor;
+
+void main()
+{
+    vec2 half_pixel = (0.5 / vec2(textureSize(u_texture, 0))) * u_kawase.x;
+
+    vec4 sum = texture(u_texture, v_texcoord) * 4.0;
+    sum += texture(u_texture, v_texcoord - half_pixel);
+    sum += texture(u_texture, v_texcoord + half_pixel);
+    sum += texture(u_texture, v_texcoord + vec2(half_pixel.x, -half_pixel.y));
+    sum += texture(u_texture, v_texcoord - vec2(half_pixel.x, -half_pixel.y));
+
+    o_fragcolor = sum / 8.0;
+}
+
+#endif /* FRAG_SHADER ////////////////////////////////////////////////////////*/
@@ -0,0 +1,66 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+Texture2D    u_texture;
+SamplerState u_sampler;
+
+cbuffer Imm: register(b0)
+{
+    float4x4 u_projection;
+    float4x4 u_view;
+    float4x4 u_model;
+    bool     u_usetex;
+};
+
+cbuffer Kawase: register(b1)
+{
+    float4 u_kawase; // x = offset
+};
+
+struct VSInput
+{
+    float4 position  : POSITION;
+    float4 normal    : NORMAL;
+    float4 color     : COLOR;
+    float4 texcoord  : TEXCOORD;
+    float4 userdata0 : USERDATA0;
+    float4 userdata1 : USERDATA1;
+    float4 userdata2 : USERDATA2;
+    float4 userdata3 : USERDATA3;
+};
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float2 texcoord : TEXCOORD;
+};
+
+PSInput vs_main(VSInput input)
+{
+    PSInput output;
+    output.position = mul(u_projection, mul(u_view, mul(u_model, input.position)));
+    output.texcoord = input.texcoord.xy;
+    return output;
+}
+
+float2 get_half_pixel()
+{
+    float w,h;
+    u_texture.GetDimensions(w,h);
+    return (0.5 / float2(w,h)) * u_kawase.x;
+}
+
+float4 ps_main(PSInput input) : SV_TARGET
+{
+    float2 uv = input.texcoord;
+    float2 half_pixel = get_half_pixel();
+
+    float4 sum = u_texture.Sample(u_sampler, uv) * 4.0;
+    sum += u_texture.Sample(u_sampler, uv - half_pixel);
+    sum += u_texture.Sample(u_sampler, uv + half_pixel);
+    sum += u_texture.Sample(u_sampler, uv + float2(half_pixel.x, -half_pixel.y));
+    sum += u_texture.Sample(u_sampler, uv - float2(half_pixel.x, -half_pixel.y));
+
+    return sum / 8.0;
+}
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -1,5 +1,16 @@
 args=("$@")
 
+# Pass harfbuzz as an extra argument to the macos, headless or bench targets to build with HarfBuzz text shaping
+# (USE_HARFBUZZ). HarfBuzz isn't bundled so it's found through pkg-config, install it first (e.g. brew install harfbuzz).
+hbuz=""
+hlib=""
+for arg in "${args[@]:1}"; do
+    if [ "$arg" == "harfbuzz" ]; then
+        hbuz="-D USE_HARFBUZZ $(pkg-config --cflags harfbuzz)"
+        hlib="$(pkg-config --libs harfbuzz)"
+    fi
+done
+
 if [ "${args[0]}" == "macos" ]; then
     echo "----------------------------------------"
 
@@ -15,7 +26,7 @@ if [ "${args[0]}" == "macos" ]; then
     fi
 
     cd "../../binary/macos"
-    g++ $cflg $idir $ldir $libs $lflg $defs ../../source/myapp.cpp -o game
+    g++ $cflg $idir $hbuz $ldir $libs $hlib $lflg $defs ../../source/myapp.cpp -o game
 
     # Build the .app package manually.
     if [ -d "game.app" ]; then
@@ -65,6 +76,58 @@ if [ "${args[0]}" == "web" ]; then
     exit 0
 fi
 
+# Headless builds have no window, GPU or audio device so they also work on Linux servers, SDL2 and FreeType are
+# found through the system rather than the bundled frameworks.
+if [ "${args[0]}" == "headless" ]; then
+    echo "----------------------------------------"
+
+    defs="-D BUILD_NATIVE -D BUILD_HEADLESS"
+    idir="$(sdl2-config --cflags) $(pkg-config --cflags freetype2) -I ../../depends/nksdk/nklibs -I ../../depends/stb -I ../../depends/imgui -I ../../source/engine"
+    libs="$(sdl2-config --libs) $(pkg-config --libs freetype2) -lpthread"
+    cflg="-std=c++14 -Wall -Wno-missing-braces -Wno-unused-function"
+
+    if [ "${args[1]}" == "release" ]; then
+        cflg="$cflg -O2"
+    else
+        defs="$defs -D BUILD_DEBUG -D NK_DEBUG"
+        cflg="$cflg -g"
+    fi
+
+    if [ ! -d "../../binary/headless" ];
+        then mkdir -p "../../binary/headless"
+    fi
+
+    cd "../../binary/headless"
+    g++ $cflg $idir $hbuz $defs ../../source/myapp.cpp $libs $hlib -o game
+    cp -r ../../assets assets
+
+    echo "----------------------------------------"
+
+    exit 0
+fi
+
+# The benchmark harness is always an optimized headless build, so the numbers are for the CPU side of the engine.
+if [ "${args[0]}" == "bench" ]; then
+    echo "----------------------------------------"
+
+    defs="-D BUILD_NATIVE -D BUILD_HEADLESS"
+    idir="$(sdl2-config --cflags) $(pkg-config --cflags freetype2) -I ../../depends/nksdk/nklibs -I ../../depends/stb -I ../../depends/imgui -I ../../source/engine"
+    libs="$(sdl2-config --libs) $(pkg-config --libs freetype2) -lpthread"
+    cflg="-std=c++14 -Wall -Wno-missing-braces -Wno-unused-function -O2 -g"
+
+    if [ ! -d "../../binary/bench" ];
+        then mkdir -p "../../binary/bench"
+    fi
+
+    cd "../../binary/bench"
+    g++ $cflg $idir $hbuz $defs ../../source/bench.cpp $libs $hlib -o bench
+    cp -r ../../assets assets
+
+    echo "----------------------------------------"
+
+    exit 0
+fi
+
 if [ "${args[0]}" == "tools" ]; then
     echo "----------------------------------------"
 
@@ -80,4 +143,22 @@ if [ "${args[0]}" == "tools" ]; then
     exit 0
 fi
 
-echo "please specify build target (macos, web, tools)..."
+# Tests for the nk libraries, built with the address sanitizer so memory bugs in the containers fail loudly.
+if [ "${args[0]}" == "tests" ]; then
+    echo "----------------------------------------"
+
+    if [ ! -d "../../binary/tests" ];
+        then mkdir -p "../../binary/tests"
+    fi
+
+    cd "../../binary/tests"
+    g++ -std=c++14 -Wall -Wno-missing-braces -Wno-unused-function -g -fsanitize=address,undefined -D NK_DEBUG ../../source/tests/nklibs_tests.cpp -I ../../depends/nksdk/nklibs -o nklibs_tests
+    ./nklibs_tests
+    result=$?
+
+    echo "----------------------------------------"
+
+    exit $result
+fi
+
+echo "please specify build target (macos, web, headless, bench, tools, tests)..."
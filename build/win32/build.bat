@@ -5,9 +5,12 @@ setlocal
 
 if "%~1"=="win32" goto build_win32
 if "%~1"=="web" goto build_web
+if "%~1"=="headless" goto build_headless
+if "%~1"=="bench" goto build_bench
 if "%~1"=="tools" goto build_tools
+if "%~1"=="tests" goto build_tests
 
-echo please specify build target (win32, web, tools)...
+echo please specify build target (win32, web, headless, bench, tools, tests)...
 goto end
 
 :build_win32
@@ -20,6 +23,8 @@ set libs=SDL2main.lib SDL2.lib SDL2_mixer.lib freetype.lib d3d11.lib d3dcompiler
 set cflg=-std:c++14 -Zc:__cplusplus -W4 -wd4201 -wd4100 -wd4505
 set lflg=-incremental:no -ignore:4099
 
+call :setup_harfbuzz %2 %3
+
 if "%~2"=="release" (
     set cflg=%cflg% -O2
     set lflg=%lflg% -release -subsystem:windows
@@ -78,6 +83,62 @@ popd
 echo ----------------------------------------
 goto end
 
+:build_headless
+echo ----------------------------------------
+
+set defs=-D BUILD_NATIVE -D BUILD_HEADLESS -D _CRT_SECURE_NO_WARNINGS -D SDL_MAIN_HANDLED
+set idir=-I ..\..\depends\sdl\win32\include -I ..\..\depends\freetype\win32\include -I ..\..\depends\nksdk\nklibs -I ..\..\depends\stb -I ..\..\depends\imgui -I ..\..\source\engine
+set ldir=-libpath:..\..\depends\sdl\win32\lib -libpath:..\..\depends\freetype\win32\lib
+set libs=SDL2.lib freetype.lib shell32.lib
+set cflg=-std:c++14 -Zc:__cplusplus -W4 -wd4201 -wd4100 -wd4505
+set lflg=-incremental:no -ignore:4099 -subsystem:console
+
+call :setup_harfbuzz %2 %3
+
+if "%~2"=="release" (
+    set cflg=%cflg% -O2
+    set lflg=%lflg% -release
+) else (
+    set defs=%defs% -D BUILD_DEBUG -D NK_DEBUG
+    set cflg=%cflg% -Z7
+)
+
+if not exist ..\..\binary\headless mkdir ..\..\binary\headless
+
+copy ..\..\depends\sdl\win32\bin\*.dll ..\..\binary\headless\ > NUL
+
+pushd ..\..\binary\headless
+call ..\..\build\win32\timer.bat "cl ..\..\source\myapp.cpp %cflg% %defs% %idir% -Fe:game.exe -link %lflg% %ldir% %libs%"
+popd
+
+echo ----------------------------------------
+goto end
+
+:build_bench
+echo ----------------------------------------
+
+:: The benchmark harness is always an optimized headless build, so the numbers are for the CPU side of the engine.
+set defs=-D BUILD_NATIVE -D BUILD_HEADLESS -D _CRT_SECURE_NO_WARNINGS -D SDL_MAIN_HANDLED
+set idir=-I ..\..\depends\sdl\win32\include -I ..\..\depends\freetype\win32\include -I ..\..\depends\nksdk\nklibs -I ..\..\depends\stb -I ..\..\depends\imgui -I ..\..\source\engine
+set ldir=-libpath:..\..\depends\sdl\win32\lib -libpath:..\..\depends\freetype\win32\lib
+set libs=SDL2.lib freetype.lib shell32.lib
+set cflg=-std:c++14 -Zc:__cplusplus -W4 -wd4201 -wd4100 -wd4505 -O2 -Z7
+set lflg=-incremental:no -ignore:4099 -subsystem:console -release
+
+call :setup_harfbuzz %2 %3
+
+if not exist ..\..\binary\bench mkdir ..\..\binary\bench
+
+copy ..\..\depends\sdl\win32\bin\*.dll ..\..\binary\bench\ > NUL
+if exist ..\..\binary\win32\assets.npak copy ..\..\binary\win32\assets.npak ..\..\binary\bench\ > NUL
+
+pushd ..\..\binary\bench
+call ..\..\build\win32\timer.bat "cl ..\..\source\bench.cpp %cflg% %defs% %idir% -Fe:bench.exe -link %lflg% %ldir% %libs%"
+popd
+
+echo ----------------------------------------
+goto end
+
 :build_tools
 echo ----------------------------------------
 
@@ -91,5 +152,31 @@ popd
 echo ----------------------------------------
 goto end
 
+:build_tests
+echo ----------------------------------------
+
+:: Tests for the nk libraries, built with the address sanitizer so memory bugs in the containers fail loudly.
+if not exist ..\..\binary\tests mkdir ..\..\binary\tests
+
+pushd ..\..\binary\tests
+cl ..\..\source\tests\nklibs_tests.cpp -std:c++14 -Zc:__cplusplus -W4 -wd4201 -wd4100 -wd4505 -Z7 -fsanitize=address -D NK_DEBUG -D _CRT_SECURE_NO_WARNINGS -I ..\..\depends\nksdk\nklibs -Fe:nklibs_tests.exe
+del *.obj
+nklibs_tests.exe
+popd
+
+echo ----------------------------------------
+goto end
+
+:: Pass harfbuzz as an extra argument to the win32, headless or bench targets to build with HarfBuzz text shaping
+:: (USE_HARFBUZZ). HarfBuzz isn't bundled, build it and put its headers (hb.h, hb-ft.h, etc.) in
+:: depends\harfbuzz\win32\include and the static harfbuzz.lib in depends\harfbuzz\win32\lib first.
+:setup_harfbuzz
+if not "%~1"=="harfbuzz" if not "%~2"=="harfbuzz" goto :eof
+set defs=%defs% -D USE_HARFBUZZ
+set idir=%idir% -I ..\..\depends\harfbuzz\win32\include
+set ldir=%ldir% -libpath:..\..\depends\harfbuzz\win32\lib
+set libs=%libs% harfbuzz.lib
+goto :eof
+
 :end
 endlocal
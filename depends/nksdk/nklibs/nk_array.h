@@ -4,6 +4,7 @@
 #include "nk_define.h"
 
 #include <string.h>
+#include <new>
 
 #if !defined(NK_HAS_CPP)
 #error nk_array requires C++ in order to be used
@@ -17,6 +18,11 @@ struct nkArray
 
     T* data = NULL;
 
+    // Where the data gets allocated from, NULL uses the nk memory macros. Set
+    // this before the array allocates anything. Copies always start with the
+    // default allocator, moves bring the allocator along with the data.
+    const nkAllocator* allocator = NULL;
+
     nkArray(void);
     nkArray(nkInitializerList<T> list);
     nkArray(const nkArray<T>& other);
@@ -89,6 +95,7 @@ nkArray<T>::nkArray(const nkArray<T>& other)
 template<typename T>
 nkArray<T>::nkArray(nkArray<T>&& other)
 {
+    allocator = other.allocator;
     nk_array_move(this, &other);
 }
 template<typename T>
@@ -154,6 +161,63 @@ T* nkArray<T>::end(void)
     return (data + length);
 }
 
+// Trivially copyable elements are moved around with realloc/memcpy/memmove, any
+// other type (e.g. nkString, which can point into itself) is copied and moved
+// one element at a time using its constructors, and old elements destroyed.
+#define NK__ARRAY_IS_TRIVIAL(T) __is_trivially_copyable(T)
+
+// Copy constructs count elements into uninitialized memory at dst.
+template<typename T>
+NKINTERNAL void nk__array_construct(T* dst, const T* src, nkU64 count)
+{
+    if(NK__ARRAY_IS_TRIVIAL(T))
+    {
+        memcpy(NK_CAST(void*,dst), src, count * sizeof(T));
+        return;
+    }
+    for(nkU64 i=0; i<count; ++i)
+        new (dst + i) T(src[i]);
+}
+
+// Moves count elements from src to dst, leaving the src elements destroyed. The
+// ranges are allowed to overlap as long as dst doesn't hold any live elements
+// that aren't also in src.
+template<typename T>
+NKINTERNAL void nk__array_relocate(T* dst, T* src, nkU64 count)
+{
+    if(NK__ARRAY_IS_TRIVIAL(T))
+    {
+        memmove(NK_CAST(void*,dst), src, count * sizeof(T));
+        return;
+    }
+    // Go in the direction that moves overlapping elements out before they're written over.
+    if(dst < src)
+    {
+        for(nkU64 i=0; i<count; ++i)
+        {
+            new (dst + i) T(nk_move(src[i]));
+            src[i].~T();
+        }
+    }
+    else if(dst > src)
+    {
+        for(nkU64 i=count; i>0; --i)
+        {
+            new (dst + i-1) T(nk_move(src[i-1]));
+            src[i-1].~T();
+        }
+    }
+}
+
+template<typename T>
+NKINTERNAL void nk__array_destroy(T* elems, nkU64 count)
+{
+    // Explicitally call the destructor because the type for T could internally handle
+    // memory that needs to be freed, a common example of this is using nkString for T.
+    for(nkU64 i=0; i<count; ++i)
+        elems[i].~T();
+}
+
 // Used internally by the array functions to grow the array and should not be
 // used externally. If you want to grow an array use nk_array_reserve instead.
 template<typename T>
@@ -170,14 +234,27 @@ NKINTERNAL void nk__array_grow_if_necessary(nkArray<T>* array, nkU64 new_size)
     nkU64 allocate_size = new_size * 2;
     if(allocate_size < NK_ARRAY_SMALLEST_SIZE)
         allocate_size = NK_ARRAY_SMALLEST_SIZE;
-    array->data = NK_RALLOC_TYPES(T, array->data, allocate_size);
+    if(NK__ARRAY_IS_TRIVIAL(T))
+    {
+        array->data = NK_CAST(T*, NK_ALLOCATOR_RALLOC(array->allocator, array->data, array->allocated * sizeof(T), allocate_size * sizeof(T)));
+    }
+    else
+    {
+        T* data = NK_CAST(T*, NK_ALLOCATOR_MALLOC(array->allocator, allocate_size * sizeof(T)));
+        if(array->data)
+        {
+            nk__array_relocate(data, array->data, array->length);
+            NK_ALLOCATOR_FREE(array->allocator, array->data, array->allocated * sizeof(T));
+        }
+        array->data = data;
+    }
     array->allocated = allocate_size;
 
     // @Improve: Currently we are just doing this so that everything is always
     // zero initialized. We want to handle constructors, etc. properly for
     // more complex types but for now this should work fine for what we want.
     nkU64 empty_space_length = array->allocated - array->length;
-    memset(array->data + array->length, 0, empty_space_length * sizeof(T));
+    memset(NK_CAST(void*,array->data + array->length), 0, empty_space_length * sizeof(T));
 }
 
 template<typename T>
@@ -187,14 +264,8 @@ NKAPI void nk_array_free(nkArray<T>* array)
 
     if(array->data)
     {
-        for(nkU64 i=0; i<array->length; ++i)
-        {
-            // Explicitally call the destructor because the type for T could internally handle
-            // memory that needs to be freed, a common example of this is using nkString for T.
-            T* elem = &array->data[i];
-            elem->~T();
-        }
-        NK_FREE(array->data);
+        nk__array_destroy(array->data, array->length);
+        NK_ALLOCATOR_FREE(array->allocator, array->data, array->allocated * sizeof(T));
     }
 
     array->length    = 0;
@@ -211,8 +282,9 @@ NKAPI void nk_array_fill(nkArray<T>* array, T value, nkU64 count)
     nk__array_grow_if_necessary(array, count);
     for(nkU64 i=0; i<count; ++i)
     {
-        array->data[i] = value;
+        new (array->data + i) T(value);
     }
+    array->length = count;
 }
 
 template<typename T>
@@ -226,6 +298,12 @@ template<typename T>
 NKAPI void nk_array_clear(nkArray<T>* array)
 {
     NK_ASSERT(array);
+
+    if(!NK__ARRAY_IS_TRIVIAL(T) && array->length)
+    {
+        nk__array_destroy(array->data, array->length);
+        memset(NK_CAST(void*,array->data), 0, array->length * sizeof(T));
+    }
     array->length = 0;
 }
 
@@ -340,7 +418,8 @@ NKAPI void nk_array_append(nkArray<T>* array, T elem)
     NK_ASSERT(array);
 
     nk__array_grow_if_necessary(array, array->length + 1);
-    array->data[array->length++] = elem;
+    new (array->data + array->length) T(nk_move(elem));
+    array->length++;
 }
 
 template<typename T>
@@ -353,7 +432,7 @@ NKAPI void nk_array_append(nkArray<T>* array, const T* elems, nkU64 count)
 
     nk__array_grow_if_necessary(array, array->length + count);
 
-    memcpy(array->data + array->length, elems, count * sizeof(T));
+    nk__array_construct(array->data + array->length, elems, count);
     array->length += count;
 }
 
@@ -396,8 +475,8 @@ NKAPI void nk_array_insert(nkArray<T>* array, nkU64 pos, const T* elems, nkU64 c
 
     // Move the contents after pos forward to make room.
     nkU64 length_after_pos = array->length - pos;
-    memmove(array->data + pos + count, array->data + pos, length_after_pos * sizeof(T));
-    memcpy(array->data + pos, elems, count * sizeof(T));
+    nk__array_relocate(array->data + pos + count, array->data + pos, length_after_pos);
+    nk__array_construct(array->data + pos, elems, count);
     array->length += count;
 }
 
@@ -410,8 +489,10 @@ NKAPI void nk_array_remove(nkArray<T>* array, nkU64 pos, nkU64 count)
 
     // Move the contents after pos back by the removal count.
     nkU64 length_after_end = array->length - (pos + count);
-    memmove(array->data + pos, array->data + pos + count, length_after_end * sizeof(T));
+    nk__array_destroy(array->data + pos, count);
+    nk__array_relocate(array->data + pos, array->data + pos + count, length_after_end);
     array->length -= count;
+    memset(NK_CAST(void*,array->data + array->length), 0, count * sizeof(T));
 }
 
 template<typename T>
@@ -429,8 +510,26 @@ NKAPI void nk_array_move(nkArray<T>* array, nkArray<T>* other)
     NK_ASSERT(array);
     NK_ASSERT(other);
 
+    if(array == other) return;
+
     nk_array_free(array);
 
+    // Data can only be handed over if it came from the same allocator, otherwise
+    // the elements are moved across. The other array's elements now belong to this
+    // array so it's emptied before being freed to avoid calling their destructors.
+    if(array->allocator != other->allocator)
+    {
+        if(other->length)
+        {
+            nk__array_grow_if_necessary(array, other->length);
+            nk__array_relocate(array->data, other->data, other->length);
+            array->length = other->length;
+        }
+        other->length = 0;
+        nk_array_free(other);
+        return;
+    }
+
     array->length    = other->length;
     array->allocated = other->allocated;
     array->data      = other->data;
@@ -209,6 +209,37 @@ NK_STATIC_ASSERT(sizeof(nkS64 )==8, nkS64_is_not_the_correct_size);
 NK_STATIC_ASSERT(sizeof(nkF32 )==4, nkF32_is_not_the_correct_size);
 NK_STATIC_ASSERT(sizeof(nkF64 )==8, nkF64_is_not_the_correct_size);
 
+// Containers and some of the other nk libraries can also be handed an allocator
+// to get their memory from rather than using the memory macros (e.g. an arena).
+// The one function handles everything: a new_size of zero frees ptr, otherwise
+// ptr is reallocated to new_size (or allocated if it's NULL). The old_size is
+// passed along so allocators don't need to keep track of allocation sizes.
+typedef void*(*nkAllocatorFunction)(void* user, void* ptr, nkU64 old_size, nkU64 new_size);
+
+typedef struct nkAllocator
+{
+    nkAllocatorFunction function;
+    void*               user;
+}
+nkAllocator;
+
+// Passing a NULL allocator to this uses the memory macros instead.
+NKINTERNAL NKINLINE void* nk_allocator_realloc(const nkAllocator* allocator, void* ptr, nkU64 old_size, nkU64 new_size)
+{
+    if(allocator)
+        return allocator->function(allocator->user, ptr, old_size, new_size);
+    if(new_size == 0)
+    {
+        NK_FREE(ptr);
+        return NULL;
+    }
+    return NK_RALLOC_BYTES(ptr, new_size);
+}
+
+#define NK_ALLOCATOR_MALLOC(a,    n) nk_allocator_realloc(a,NULL,0,n)
+#define NK_ALLOCATOR_RALLOC(a,p,o,n) nk_allocator_realloc(a,p,o,n)
+#define NK_ALLOCATOR_FREE(  a,p,o  ) nk_allocator_realloc(a,p,o,0)
+
 // Custom implementation of initialize_list to avoid the need to include extra
 // code or STL headers. This needs to be in the std namespace or else it will
 // not work, so there is no real way to get around that issue.
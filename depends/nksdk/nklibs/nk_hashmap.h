@@ -4,6 +4,9 @@
 #include "nk_define.h"
 #include "nk_string.h"
 
+#include <string.h>
+#include <new>
+
 #if !defined(NK_HAS_CPP)
 #error nk_hashmap requires C++ in order to be used
 #endif
@@ -34,18 +37,24 @@ struct nkHashMap
 
     struct Slot
     {
-        nkU32 hash;
-        K     key;
-        V     value;
+        K key;
+        V value;
     };
 
     nkF32 load_factor = 0.0f;
     nkU64 count       = 0;
-    nkU64 allocated   = 0;
+    nkU64 freed       = 0;    // Slots left behind by removals that still count towards the load.
+    nkU64 allocated   = 0;    // Always a power of two and at least one group.
+    nkU8* ctrl        = NULL; // One control byte per slot, see the implementation notes below.
     Slot* slots       = NULL;
 
+    // Where the slots get allocated from, NULL uses the nk memory macros. Set
+    // this before the map allocates anything. Copies always start with the
+    // default allocator, moves bring the allocator along with the slots.
+    const nkAllocator* allocator = NULL;
+
     nkHashMap(void);
-    nkHashMap(nkU64 initial_count, nkF32 load_factor = 0.7f);
+    nkHashMap(nkU64 initial_count, nkF32 load_factor = 0.875f);
     nkHashMap(const nkHashMap<K,V>& other);
     nkHashMap(nkHashMap<K,V>&& other);
 
@@ -64,7 +73,7 @@ struct nkHashMap
           Iterator end  (void);
 };
 
-template<typename K, typename V> NKAPI void           nk_hashmap_init    (nkHashMap<K,V>* map, nkU64 initial_count = 32, nkF32 load_factor = 0.7f);
+template<typename K, typename V> NKAPI void           nk_hashmap_init    (nkHashMap<K,V>* map, nkU64 initial_count = 32, nkF32 load_factor = 0.875f);
 template<typename K, typename V> NKAPI void           nk_hashmap_free    (nkHashMap<K,V>* map);
 template<typename K, typename V> NKAPI void           nk_hashmap_clear   (nkHashMap<K,V>* map);
 template<typename K, typename V> NKAPI nkBool         nk_hashmap_empty   (nkHashMap<K,V>* map);
@@ -78,20 +87,253 @@ template<typename K, typename V> NKAPI void           nk_hashmap_move    (nkHash
 template<typename K, typename V> NKAPI nkHashMap<K,V> nk_hashmap_copy    (                     const nkHashMap<K,V>* other);
 template<typename K, typename V> NKAPI nkHashMap<K,V> nk_hashmap_move    (                           nkHashMap<K,V>* other);
 
+// Maps with nkString keys can also be searched with a plain C string, which
+// saves having to build (and allocate) an nkString just to do the lookup.
+template<typename V> NKAPI void   nk_hashmap_remove  (nkHashMap<nkString,V>* map, const nkChar* key);
+template<typename V> NKAPI nkBool nk_hashmap_contains(nkHashMap<nkString,V>* map, const nkChar* key);
+template<typename V> NKAPI V*     nk_hashmap_getptr  (nkHashMap<nkString,V>* map, const nkChar* key);
+template<typename V> NKAPI V&     nk_hashmap_getref  (nkHashMap<nkString,V>* map, const nkChar* key);
+
 /*============================================================================*/
 /*============================== IMPLEMENTATION ==============================*/
 /*============================================================================*/
 
-// We use hash values of 0 and 1 to denote whether a slot is currently empty or
-// freed. Empty slots will be filled when encountered during an insert. Freed
-// slots are used to keep collision runs working when doing a search into the
-// map whilst also providing a way for the insert system to see that the slot
-// is available for re-assignment if it is hit during hashing.
+// The map uses open addressing laid out like Abseil's SwissTable. Alongside
+// the slots there is an array of control bytes, one per slot, holding either
+// NK_HASHMAP_CTRL_EMPTY, NK_HASHMAP_CTRL_FREED, or the bottom 7 bits of the
+// key's hash if the slot is in use. Slots are split into groups of 16 and the
+// upper bits of the hash pick which group to start searching from, then each
+// group's control bytes are checked all at once with SIMD for any that match
+// the bottom bits. Only those slots have their keys compared, so most misses
+// never touch a key at all. A search stops at the first group that has an
+// empty slot in it, as an insert would have put the key there.
 //
-// As a result of this, hash functions that return 0 and 1 as valid hashes will
-// not work with our hash-map because they will be interpreted incorrectly!
-NKINTERNAL NKCONSTEXPR nkU32 NK_HASHMAP_SLOT_EMPTY = 0;
-NKINTERNAL NKCONSTEXPR nkU32 NK_HASHMAP_SLOT_FREED = 1;
+// Keys are hashed with wyhash (https://github.com/wangyi-fudan/wyhash) over
+// their bytes and compared with memcmp, nkString keys hash and compare their
+// characters instead. As the bytes are used any padding in a key type should
+// be zeroed. For other key types provide overloads of nk__hashmap_hash and
+// nk__hashmap_equals, the same as the ones for nkString below.
+NKINTERNAL NKCONSTEXPR nkU8  NK_HASHMAP_CTRL_EMPTY = 0x80;
+NKINTERNAL NKCONSTEXPR nkU8  NK_HASHMAP_CTRL_FREED = 0xFE;
+NKINTERNAL NKCONSTEXPR nkU64 NK_HASHMAP_GROUP_SIZE = 16;
+
+// Load factors above this could leave a probe with no empty slot to stop at.
+NKINTERNAL NKCONSTEXPR nkF32 NK_HASHMAP_MAX_LOAD_FACTOR = 0.875f;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define NK_HASHMAP_SSE2
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define NK_HASHMAP_WASM
+#endif
+
+#if defined(NK_COMPILER_MSVC)
+#include <intrin.h>
+#endif
+
+// Group ======================================================================
+
+// Each of these returns a bitmask with a bit set for every control byte in the
+// group that passed the test, with bit 0 being the first slot of the group.
+
+#if defined(NK_HASHMAP_SSE2)
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match(const nkU8* group, nkU8 h2)
+{
+    __m128i ctrl = _mm_loadu_si128(NK_CAST(const __m128i*, group));
+    return NK_CAST(nkU32, _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(NK_CAST(char, h2)))));
+}
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match_unused(const nkU8* group) // Empty or freed.
+{
+    return NK_CAST(nkU32, _mm_movemask_epi8(_mm_loadu_si128(NK_CAST(const __m128i*, group))));
+}
+#elif defined(NK_HASHMAP_WASM)
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match(const nkU8* group, nkU8 h2)
+{
+    return NK_CAST(nkU32, wasm_i8x16_bitmask(wasm_i8x16_eq(wasm_v128_load(group), wasm_i8x16_splat(NK_CAST(nkS8, h2)))));
+}
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match_unused(const nkU8* group) // Empty or freed.
+{
+    return NK_CAST(nkU32, wasm_i8x16_bitmask(wasm_v128_load(group)));
+}
+#else
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match(const nkU8* group, nkU8 h2)
+{
+    nkU32 mask = 0;
+    for(nkU32 i=0; i<NK_HASHMAP_GROUP_SIZE; ++i)
+        if(group[i] == h2) mask |= (1u << i);
+    return mask;
+}
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match_unused(const nkU8* group) // Empty or freed.
+{
+    nkU32 mask = 0;
+    for(nkU32 i=0; i<NK_HASHMAP_GROUP_SIZE; ++i)
+        if(group[i] & 0x80) mask |= (1u << i);
+    return mask;
+}
+#endif
+
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_group_match_empty(const nkU8* group)
+{
+    return nk__hashmap_group_match(group, NK_HASHMAP_CTRL_EMPTY);
+}
+
+NKINTERNAL NKFORCEINLINE nkU32 nk__hashmap_lowest_bit(nkU32 mask)
+{
+    #if defined(NK_COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return NK_CAST(nkU32, index);
+    #else
+    return NK_CAST(nkU32, __builtin_ctz(mask));
+    #endif
+}
+
+// =============================================================================
+
+// Hashing =====================================================================
+
+NKINTERNAL NKFORCEINLINE void nk__wyhash_mum(nkU64* a, nkU64* b)
+{
+    #if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = NK_CAST(nkU64, r);
+    *b = NK_CAST(nkU64, r >> 64);
+    #elif defined(NK_COMPILER_MSVC) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+    #else
+    nkU64 ha = *a >> 32, hb = *b >> 32, la = NK_CAST(nkU32, *a), lb = NK_CAST(nkU32, *b);
+    nkU64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = (t < rl);
+    nkU64 lo = t + (rm1 << 32);
+    c += (lo < t);
+    nkU64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    *a = lo;
+    *b = hi;
+    #endif
+}
+
+NKINTERNAL NKFORCEINLINE nkU64 nk__wyhash_mix(nkU64 a, nkU64 b)
+{
+    nk__wyhash_mum(&a, &b);
+    return (a ^ b);
+}
+
+NKINTERNAL NKFORCEINLINE nkU64 nk__wyhash_read8(const nkU8* p) { nkU64 v; memcpy(&v, p, 8); return v; }
+NKINTERNAL NKFORCEINLINE nkU64 nk__wyhash_read4(const nkU8* p) { nkU32 v; memcpy(&v, p, 4); return v; }
+NKINTERNAL NKFORCEINLINE nkU64 nk__wyhash_read3(const nkU8* p, nkU64 k)
+{
+    return ((NK_CAST(nkU64, p[0]) << 16) | (NK_CAST(nkU64, p[k >> 1]) << 8) | p[k - 1]);
+}
+
+// Final version 4.2 of wyhash, with the default secret and a seed of zero.
+NKINTERNAL nkU64 nk__wyhash(const void* key, nkU64 length)
+{
+    NKPERSISTENT NKCONSTEXPR nkU64 SECRET[4] =
+    {
+        0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull, 0x4D5A2DA51DE1AA47ull
+    };
+
+    const nkU8* p = NK_CAST(const nkU8*, key);
+
+    nkU64 seed = nk__wyhash_mix(SECRET[0], SECRET[1]);
+    nkU64 a, b;
+
+    if(length <= 16)
+    {
+        if(length >= 4)
+        {
+            a = (nk__wyhash_read4(p) << 32) | nk__wyhash_read4(p + ((length >> 3) << 2));
+            b = (nk__wyhash_read4(p + length - 4) << 32) | nk__wyhash_read4(p + length - 4 - ((length >> 3) << 2));
+        }
+        else if(length > 0)
+        {
+            a = nk__wyhash_read3(p, length);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        nkU64 i = length;
+        if(i > 48)
+        {
+            nkU64 see1 = seed, see2 = seed;
+            do
+            {
+                seed = nk__wyhash_mix(nk__wyhash_read8(p     ) ^ SECRET[1], nk__wyhash_read8(p +  8) ^ seed);
+                see1 = nk__wyhash_mix(nk__wyhash_read8(p + 16) ^ SECRET[2], nk__wyhash_read8(p + 24) ^ see1);
+                see2 = nk__wyhash_mix(nk__wyhash_read8(p + 32) ^ SECRET[3], nk__wyhash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            while(i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while(i > 16)
+        {
+            seed = nk__wyhash_mix(nk__wyhash_read8(p) ^ SECRET[1], nk__wyhash_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = nk__wyhash_read8(p + i - 16);
+        b = nk__wyhash_read8(p + i - 8);
+    }
+
+    a ^= SECRET[1];
+    b ^= seed;
+    nk__wyhash_mum(&a, &b);
+    return nk__wyhash_mix(a ^ SECRET[0] ^ length, b ^ SECRET[1]);
+}
+
+// A C string standing in for an nkString key, the length is worked out once.
+struct nk__HashMapStringKey
+{
+    const nkChar* cstr;
+    nkU64         length;
+};
+
+template<typename K>
+NKINTERNAL NKFORCEINLINE nkU64 nk__hashmap_hash(const K& key)
+{
+    return nk__wyhash(&key, sizeof(K));
+}
+NKINTERNAL NKFORCEINLINE nkU64 nk__hashmap_hash(const nkString& key)
+{
+    return nk__wyhash(key.cstr, key.length);
+}
+NKINTERNAL NKFORCEINLINE nkU64 nk__hashmap_hash(const nk__HashMapStringKey& key)
+{
+    return nk__wyhash(key.cstr, key.length);
+}
+
+template<typename K>
+NKINTERNAL NKFORCEINLINE nkBool nk__hashmap_equals(const K& a, const K& b)
+{
+    return (memcmp(&a, &b, sizeof(K)) == 0);
+}
+NKINTERNAL NKFORCEINLINE nkBool nk__hashmap_equals(const nkString& a, const nkString& b)
+{
+    return ((a.length == b.length) && (a.length == 0 || memcmp(a.cstr, b.cstr, a.length) == 0));
+}
+NKINTERNAL NKFORCEINLINE nkBool nk__hashmap_equals(const nkString& a, const nk__HashMapStringKey& b)
+{
+    return ((a.length == b.length) && (a.length == 0 || memcmp(a.cstr, b.cstr, a.length) == 0));
+}
+
+NKINTERNAL NKFORCEINLINE nk__HashMapStringKey nk__hashmap_string_key(const nkChar* cstr)
+{
+    NK_ASSERT(cstr);
+    nk__HashMapStringKey key;
+    key.cstr   = cstr;
+    key.length = strlen(cstr);
+    return key;
+}
+
+// =============================================================================
 
 // Iterator ====================================================================
 
@@ -141,9 +383,7 @@ nkBool nkHashMap<K,V>::Iterator::operator!=(const Iterator& other) const
 template<typename K, typename V>
 void nkHashMap<K,V>::Iterator::advance(void)
 {
-    while((m_index < m_map->allocated) &&
-          (m_map->slots[m_index].hash == NK_HASHMAP_SLOT_EMPTY ||
-           m_map->slots[m_index].hash == NK_HASHMAP_SLOT_FREED))
+    while((m_index < m_map->allocated) && (m_map->ctrl[m_index] & 0x80))
     {
         ++m_index;
     }
@@ -171,6 +411,7 @@ nkHashMap<K,V>::nkHashMap(const nkHashMap<K,V>& other)
 template<typename K, typename V>
 nkHashMap<K,V>::nkHashMap(nkHashMap<K,V>&& other)
 {
+    allocator = other.allocator;
     nk_hashmap_move(this, &other);
 }
 
@@ -226,83 +467,120 @@ typename nkHashMap<K,V>::Iterator nkHashMap<K,V>::end(void)
     return Iterator(this, allocated);
 }
 
-// The default hashing function will hash using the bytes of the key. There
-// is a built in specializations for the nkString type. If the user wants to
-// add more they are free to create their own specializations for new types.
-template<typename K>
-nkU32 nk__hashmap_hash(const K& key)
+// Groups are probed in triangular steps (1, 2, 3...) from the one picked by the
+// hash, with a power of two group count that visits every group exactly once.
+template<typename K, typename V, typename Q>
+NKINTERNAL typename nkHashMap<K,V>::Slot* nk__hashmap_find(nkHashMap<K,V>* map, const Q& key)
 {
-    const nkU8* bytes = NK_CAST(nkU8*, &key);
-    nkU32 hash = 1;
-    for(nkU64 i=0; i<sizeof(K); ++i)
-         hash = bytes[i] + (hash << 6) + (hash << 16) - hash;
-    return hash;
+    NK_ASSERT(map);
+
+    if(!map->count) return NULL;
+
+    nkU64 hash = nk__hashmap_hash(key);
+    nkU8  h2   = NK_CAST(nkU8, hash & 0x7F);
+
+    nkU64 group_mask = (map->allocated / NK_HASHMAP_GROUP_SIZE) - 1;
+    nkU64 group = (hash >> 7) & group_mask;
+
+    for(nkU64 step=1; step<=group_mask+1; ++step)
+    {
+        nkU64 base = group * NK_HASHMAP_GROUP_SIZE;
+        const nkU8* ctrl = map->ctrl + base;
+
+        nkU32 matches = nk__hashmap_group_match(ctrl, h2);
+        while(matches)
+        {
+            nkU64 index = base + nk__hashmap_lowest_bit(matches);
+            if(nk__hashmap_equals(map->slots[index].key, key))
+                return &map->slots[index];
+            matches &= (matches - 1);
+        }
+
+        if(nk__hashmap_group_match_empty(ctrl))
+            return NULL;
+
+        group = (group + step) & group_mask;
+    }
+
+    return NULL;
 }
-template<>
-nkU32 nk__hashmap_hash(const nkString& key)
+
+// Puts a key that is known not to be in the map into the first unused slot on
+// its probe sequence. Doesn't check the load, callers make sure there's room.
+template<typename K, typename V>
+NKINTERNAL typename nkHashMap<K,V>::Slot* nk__hashmap_claim_slot(nkHashMap<K,V>* map, nkU64 hash)
 {
-    nkU32 hash = 1;
-    const nkChar* cstr = key.cstr;
-    nkS32 c;
-    while((c = *cstr++) != 0)
-        hash = c + (hash << 6) + (hash << 16) - hash;
-    return hash;
+    nkU64 group_mask = (map->allocated / NK_HASHMAP_GROUP_SIZE) - 1;
+    nkU64 group = (hash >> 7) & group_mask;
+
+    for(nkU64 step=1; ; ++step)
+    {
+        nkU64 base = group * NK_HASHMAP_GROUP_SIZE;
+        nkU32 unused = nk__hashmap_group_match_unused(map->ctrl + base);
+        if(unused)
+        {
+            nkU64 index = base + nk__hashmap_lowest_bit(unused);
+            if(map->ctrl[index] == NK_HASHMAP_CTRL_FREED)
+                map->freed--;
+            map->ctrl[index] = NK_CAST(nkU8, hash & 0x7F);
+            map->count++;
+            return &map->slots[index];
+        }
+        group = (group + step) & group_mask;
+    }
 }
 
 template<typename K, typename V>
-NKINTERNAL typename nkHashMap<K,V>::Slot* nk__hashmap_get_slot(nkHashMap<K,V>* map, const K& key)
+NKINTERNAL nkU64 nk__hashmap_block_size(nkHashMap<K,V>* map, nkU64 allocated)
 {
-    NK_ASSERT(map);
-
-    if(!map->slots) return NULL;
-    if(!map->count) return NULL; // Important to check, if the whole map is freed slots then we will inifinite loop otherwise.
+    typedef typename nkHashMap<K,V>::Slot SlotType;
+    return allocated * (sizeof(SlotType) + 1);
+}
 
-    nkU32 hash = nk__hashmap_hash<K>(key);
+template<typename K, typename V>
+NKINTERNAL void nk__hashmap_allocate(nkHashMap<K,V>* map, nkU64 allocated)
+{
+    typedef typename nkHashMap<K,V>::Slot SlotType;
 
-    // Make sure the hash function isn't generating 0 or 1 as values. This will
-    // corrupt the data of the hash map as those values have special meanings.
-    NK_ASSERT(hash != NK_HASHMAP_SLOT_EMPTY);
-    NK_ASSERT(hash != NK_HASHMAP_SLOT_FREED);
+    // Slots and control bytes share one allocation, slots first to keep them aligned.
+    nkU8* block = NK_CAST(nkU8*, NK_ALLOCATOR_MALLOC(map->allocator, nk__hashmap_block_size(map, allocated)));
+    NK_ASSERT(block);
 
-    nkU32 iterations = 0; // Track if we've done a full lap so we can escape the loop if necessary.
-    nkU32 probe = (hash % map->allocated);
-    while(map->slots[probe].hash != hash)
-    {
-        if(map->slots[probe].hash == NK_HASHMAP_SLOT_EMPTY || iterations > map->allocated)
-            return NULL;
-        probe = (probe + 1) % map->allocated;
-        iterations++;
-    }
+    map->slots     = NK_CAST(SlotType*, NK_CAST(void*, block));
+    map->ctrl      = block + allocated * sizeof(SlotType);
+    map->allocated = allocated;
+    map->count     = 0;
+    map->freed     = 0;
 
-    return &map->slots[probe];
+    memset(map->ctrl, NK_HASHMAP_CTRL_EMPTY, allocated);
 }
 
+// Moves every entry into a fresh set of slots, which also drops any freed ones.
 template<typename K, typename V>
-NKINTERNAL void nk__hashmap_grow_and_rehash(nkHashMap<K,V>* map)
+NKINTERNAL void nk__hashmap_rehash(nkHashMap<K,V>* map, nkU64 new_allocated)
 {
     NK_ASSERT(map);
     NK_ASSERT(map->allocated != 0);
 
     typedef typename nkHashMap<K,V>::Slot SlotType;
 
-    SlotType* old_slots = map->slots;
-    nkU64 old_allocated = map->allocated;
-
-    map->count      = 0;
-    map->allocated *= 2;
+    SlotType* old_slots     = map->slots;
+    nkU8*     old_ctrl      = map->ctrl;
+    nkU64     old_allocated = map->allocated;
 
-    map->slots = NK_CALLOC_TYPES(SlotType, map->allocated);
+    nk__hashmap_allocate(map, new_allocated);
 
     for(nkU64 i=0; i<old_allocated; ++i)
     {
-        SlotType* slot = &old_slots[i];
-        if(slot->hash != NK_HASHMAP_SLOT_EMPTY && slot->hash != NK_HASHMAP_SLOT_FREED)
-        {
-            nk_hashmap_insert(map, slot->key, slot->value);
-        }
+        if(old_ctrl[i] & 0x80) continue;
+
+        SlotType* slot = nk__hashmap_claim_slot(map, nk__hashmap_hash(old_slots[i].key));
+        new (&slot->key) K(nk_move(old_slots[i].key));
+        new (&slot->value) V(nk_move(old_slots[i].value));
+        old_slots[i].~Slot();
     }
 
-    NK_FREE(old_slots);
+    NK_ALLOCATOR_FREE(map->allocator, old_slots, nk__hashmap_block_size(map, old_allocated));
 }
 
 template<typename K, typename V>
@@ -310,11 +588,13 @@ NKAPI void nk_hashmap_init(nkHashMap<K,V>* map, nkU64 initial_count, nkF32 load_
 {
     NK_ASSERT(map);
 
-    typedef typename nkHashMap<K,V>::Slot SlotType;
+    nkU64 allocated = NK_HASHMAP_GROUP_SIZE;
+    while(allocated < initial_count)
+        allocated *= 2;
+
+    nk__hashmap_allocate(map, allocated);
 
-    map->slots       = NK_CALLOC_TYPES(SlotType, initial_count);
-    map->load_factor = load_factor;
-    map->allocated   = initial_count;
+    map->load_factor = (load_factor < NK_HASHMAP_MAX_LOAD_FACTOR) ? load_factor : NK_HASHMAP_MAX_LOAD_FACTOR;
 }
 
 template<typename K, typename V>
@@ -322,23 +602,16 @@ NKAPI void nk_hashmap_free(nkHashMap<K,V>* map)
 {
     NK_ASSERT(map);
 
-    typedef typename nkHashMap<K,V>::Slot SlotType;
-
     if(map->slots)
     {
-        for(nkU64 i=0; i<map->allocated; ++i)
-        {
-            // Explicitally call the destructor because types for K or V could internally handle
-            // memory that needs to be freed, a common example of this is using nkString for K.
-            SlotType* slot = &map->slots[i];
-            if(slot->hash != NK_HASHMAP_SLOT_EMPTY)
-                slot->~Slot();
-        }
-        NK_FREE(map->slots);
+        nk_hashmap_clear(map);
+        NK_ALLOCATOR_FREE(map->allocator, map->slots, nk__hashmap_block_size(map, map->allocated));
     }
 
     map->count     = 0;
+    map->freed     = 0;
     map->allocated = 0;
+    map->ctrl      = NULL;
     map->slots     = NULL;
 }
 
@@ -347,14 +620,23 @@ NKAPI void nk_hashmap_clear(nkHashMap<K,V>* map)
 {
     NK_ASSERT(map);
 
-    map->count = 0;
+    typedef typename nkHashMap<K,V>::Slot SlotType;
+
     if(map->slots)
     {
         for(nkU64 i=0; i<map->allocated; ++i)
         {
-            map->slots[i].hash = NK_HASHMAP_SLOT_EMPTY;
+            // Explicitally call the destructor because types for K or V could internally handle
+            // memory that needs to be freed, a common example of this is using nkString for K.
+            SlotType* slot = &map->slots[i];
+            if(!(map->ctrl[i] & 0x80))
+                slot->~Slot();
         }
+        memset(map->ctrl, NK_HASHMAP_CTRL_EMPTY, map->allocated);
     }
+
+    map->count = 0;
+    map->freed = 0;
 }
 
 template<typename K, typename V>
@@ -372,61 +654,74 @@ NKAPI void nk_hashmap_insert(nkHashMap<K,V>* map, const K& key, const V& value)
     // If the nk_hashmap_init hasn't been called yet then we just do it internally.
     if(!map->slots) nk_hashmap_init(map);
 
-    NK_ASSERT(map->load_factor > 0.0f && map->load_factor < 1.0f);
-    nkF32 load_factor = NK_CAST(nkF32, map->count+1) / NK_CAST(nkF32, map->allocated);
-    if(load_factor >= map->load_factor) nk__hashmap_grow_and_rehash(map);
-
-    nkU32 hash = nk__hashmap_hash<K>(key);
+    NK_ASSERT(map->load_factor > 0.0f && map->load_factor <= NK_HASHMAP_MAX_LOAD_FACTOR);
 
-    // Make sure the hash function isn't generating 0 or 1 as values. This will
-    // corrupt the data of the hash map as those values have special meanings.
-    NK_ASSERT(hash != NK_HASHMAP_SLOT_EMPTY);
-    NK_ASSERT(hash != NK_HASHMAP_SLOT_FREED);
-
-    nkU32 probe = (hash % map->allocated);
-    while(map->slots[probe].hash != NK_HASHMAP_SLOT_EMPTY && map->slots[probe].hash != NK_HASHMAP_SLOT_FREED)
+    // Freed slots still count towards the load as searches have to step over them. If that's what pushed the map over
+    // the limit then rehashing at the same size is enough to clear them out, otherwise the map needs to grow.
+    nkF32 limit = NK_CAST(nkF32, map->allocated) * map->load_factor;
+    if(NK_CAST(nkF32, map->count + map->freed + 1) > limit)
     {
-        probe = (probe + 1) % map->allocated;
+        if(NK_CAST(nkF32, map->count + 1) > limit * 0.5f)
+            nk__hashmap_rehash(map, map->allocated * 2);
+        else
+            nk__hashmap_rehash(map, map->allocated);
     }
 
-    map->slots[probe].hash  = hash;
-    map->slots[probe].key   = key;
-    map->slots[probe].value = value;
+    typedef typename nkHashMap<K,V>::Slot SlotType;
 
-    map->count++;
+    SlotType* slot = nk__hashmap_claim_slot(map, nk__hashmap_hash(key));
+    new (&slot->key) K(key);
+    new (&slot->value) V(value);
 }
 
-template<typename K, typename V>
-NKAPI void nk_hashmap_remove(nkHashMap<K,V>* map, const K& key)
+template<typename K, typename V, typename Q>
+NKINTERNAL void nk__hashmap_remove(nkHashMap<K,V>* map, const Q& key)
 {
     NK_ASSERT(map);
 
     typedef typename nkHashMap<K,V>::Slot SlotType;
 
-    SlotType* slot = nk__hashmap_get_slot(map, key);
+    SlotType* slot = nk__hashmap_find(map, key);
     if(slot)
     {
-        slot->hash = NK_HASHMAP_SLOT_FREED;
+        nkU64 index = NK_CAST(nkU64, slot - map->slots);
+        slot->~Slot();
+
+        // If the group still has an empty slot then no search has ever gone past it, so this slot can go straight
+        // back to being empty. Otherwise it has to be marked as freed so searches know to keep going.
+        const nkU8* group = map->ctrl + (index & ~(NK_HASHMAP_GROUP_SIZE - 1));
+        if(nk__hashmap_group_match_empty(group))
+        {
+            map->ctrl[index] = NK_HASHMAP_CTRL_EMPTY;
+        }
+        else
+        {
+            map->ctrl[index] = NK_HASHMAP_CTRL_FREED;
+            map->freed++;
+        }
+
         map->count--;
     }
 }
 
 template<typename K, typename V>
-NKAPI nkBool nk_hashmap_contains(nkHashMap<K,V>* map, const K& key)
+NKAPI void nk_hashmap_remove(nkHashMap<K,V>* map, const K& key)
 {
-    NK_ASSERT(map);
+    nk__hashmap_remove(map, key);
+}
 
-    return (nk_hashmap_getptr(map, key) != NULL);
+template<typename K, typename V>
+NKAPI nkBool nk_hashmap_contains(nkHashMap<K,V>* map, const K& key)
+{
+    return (nk__hashmap_find(map, key) != NULL);
 }
 
 template<typename K, typename V>
 NKAPI V* nk_hashmap_getptr(nkHashMap<K,V>* map, const K& key)
 {
-    NK_ASSERT(map);
-
     typedef typename nkHashMap<K,V>::Slot SlotType;
 
-    SlotType* slot = nk__hashmap_get_slot(map, key);
+    SlotType* slot = nk__hashmap_find(map, key);
     return (!slot) ? NULL : &slot->value;
 }
 
@@ -444,13 +739,46 @@ NKAPI V& nk_hashmap_getref(nkHashMap<K,V>* map, const K& key)
     return dummy;
 }
 
+template<typename V>
+NKAPI void nk_hashmap_remove(nkHashMap<nkString,V>* map, const nkChar* key)
+{
+    nk__hashmap_remove(map, nk__hashmap_string_key(key));
+}
+
+template<typename V>
+NKAPI nkBool nk_hashmap_contains(nkHashMap<nkString,V>* map, const nkChar* key)
+{
+    return (nk__hashmap_find(map, nk__hashmap_string_key(key)) != NULL);
+}
+
+template<typename V>
+NKAPI V* nk_hashmap_getptr(nkHashMap<nkString,V>* map, const nkChar* key)
+{
+    typedef typename nkHashMap<nkString,V>::Slot SlotType;
+
+    SlotType* slot = nk__hashmap_find(map, nk__hashmap_string_key(key));
+    return (!slot) ? NULL : &slot->value;
+}
+
+template<typename V>
+NKAPI V& nk_hashmap_getref(nkHashMap<nkString,V>* map, const nkChar* key)
+{
+    NK_ASSERT(map);
+
+    V* value = nk_hashmap_getptr(map, key);
+    if(value) return (*value);
+
+    NKPERSISTENT V dummy;
+    return dummy;
+}
+
 template<typename K, typename V>
 NKAPI void nk_hashmap_copy(nkHashMap<K,V>* map, const nkHashMap<K,V>* other)
 {
     NK_ASSERT(map);
     NK_ASSERT(other);
 
-    typedef typename nkHashMap<K,V>::Slot SlotType;
+    if(map == other) return;
 
     nk_hashmap_free(map);
 
@@ -459,10 +787,9 @@ NKAPI void nk_hashmap_copy(nkHashMap<K,V>* map, const nkHashMap<K,V>* other)
         nk_hashmap_init(map, other->allocated, other->load_factor);
         for(nkU64 i=0; i<other->allocated; ++i)
         {
-            SlotType* slot = &other->slots[i];
-            if(slot->hash != NK_HASHMAP_SLOT_EMPTY && slot->hash != NK_HASHMAP_SLOT_FREED)
+            if(!(other->ctrl[i] & 0x80))
             {
-                nk_hashmap_insert(map, slot->key, slot->value);
+                nk_hashmap_insert(map, other->slots[i].key, other->slots[i].value);
             }
         }
     }
@@ -474,14 +801,29 @@ NKAPI void nk_hashmap_move(nkHashMap<K,V>* map, nkHashMap<K,V>* other)
     NK_ASSERT(map);
     NK_ASSERT(other);
 
+    if(map == other) return;
+
+    // Slots can only be handed over if they came from the same allocator.
+    if(map->allocator != other->allocator)
+    {
+        nk_hashmap_copy(map, other);
+        nk_hashmap_free(other);
+        return;
+    }
+
     nk_hashmap_free(map);
 
+    map->load_factor = other->load_factor;
     map->count       = other->count;
+    map->freed       = other->freed;
     map->allocated   = other->allocated;
+    map->ctrl        = other->ctrl;
     map->slots       = other->slots;
 
     other->count     = 0;
+    other->freed     = 0;
     other->allocated = 0;
+    other->ctrl      = NULL;
     other->slots     = NULL;
 }
 
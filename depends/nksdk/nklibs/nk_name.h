@@ -0,0 +1,167 @@
+#ifndef NK_NAME_H__ /*////////////////////////////////////////////////////////*/
+#define NK_NAME_H__
+
+#include "nk_define.h"
+#include "nk_string.h"
+#include "nk_hashmap.h"
+
+#include <string.h>
+
+#if !defined(NK_HAS_CPP)
+#error nk_name requires C++ in order to be used
+#endif
+
+// Names are interned strings, every distinct string gets interned exactly once
+// into a global table and names just point at the table's entry. This means
+// names can be compared by pointer, copied for free, and already know their
+// hash, which makes them useful as keys for things looked up by name often
+// (e.g. assets, animations, etc.). The default name is the empty string.
+//
+// Entries live until nk_name_free_all is called, after which any names that
+// are still around are no longer valid. The table is not thread-safe so names
+// should only be interned or found from one thread at a time.
+
+struct nk__NameEntry
+{
+    nkU64  hash;
+    nkU64  length;
+    nkChar cstr[1]; // Allocated along with the entry to fit the whole string.
+};
+
+struct nkName
+{
+    const nk__NameEntry* entry = NULL;
+};
+
+NKAPI NKINLINE nkName        nk_name_intern  (const nkChar* cstr);
+NKAPI NKINLINE nkName        nk_name_intern  (const nkChar* cstr, nkU64 length);
+NKAPI NKINLINE nkName        nk_name_find    (const nkChar* cstr); // Doesn't intern, returns the empty name if the string has never been interned.
+NKAPI NKINLINE const nkChar* nk_name_cstr    (nkName name);
+NKAPI NKINLINE nkU64         nk_name_length  (nkName name);
+NKAPI NKINLINE nkU64         nk_name_hash    (nkName name);
+NKAPI NKINLINE nkBool        nk_name_empty   (nkName name);
+NKAPI NKINLINE void          nk_name_free_all(void);
+
+NKAPI NKFORCEINLINE nkBool operator==(nkName a, nkName b) { return (a.entry == b.entry); }
+NKAPI NKFORCEINLINE nkBool operator!=(nkName a, nkName b) { return (a.entry != b.entry); }
+
+/*============================================================================*/
+/*============================== IMPLEMENTATION ==============================*/
+/*============================================================================*/
+
+NKINTERNAL nkHashMap<nkString,nk__NameEntry*> nk__name_table;
+
+// Names can be used as nkHashMap keys, the stored hash is used rather than
+// hashing the string again and keys only ever need their pointers compared.
+NKINTERNAL NKFORCEINLINE nkU64 nk__hashmap_hash(const nkName& key)
+{
+    return nk_name_hash(key);
+}
+NKINTERNAL NKFORCEINLINE nkBool nk__hashmap_equals(const nkName& a, const nkName& b)
+{
+    return (a.entry == b.entry);
+}
+
+NKAPI NKINLINE nkName nk_name_intern(const nkChar* cstr)
+{
+    NK_ASSERT(cstr);
+    return nk_name_intern(cstr, strlen(cstr));
+}
+
+NKAPI NKINLINE nkName nk_name_intern(const nkChar* cstr, nkU64 length)
+{
+    NK_ASSERT(cstr);
+
+    nkName name;
+    if(length == 0) return name;
+
+    nk__HashMapStringKey key;
+    key.cstr   = cstr;
+    key.length = length;
+
+    typedef nkHashMap<nkString,nk__NameEntry*>::Slot SlotType;
+    SlotType* slot = nk__hashmap_find(&nk__name_table, key);
+    if(slot)
+    {
+        name.entry = slot->value;
+        return name;
+    }
+
+    nk__NameEntry* entry = NK_CAST(nk__NameEntry*, NK_MALLOC_TYPES(nkU8, sizeof(nk__NameEntry) + length));
+    NK_ASSERT(entry);
+    entry->hash   = nk__hashmap_hash(key);
+    entry->length = length;
+    memcpy(entry->cstr, cstr, length * sizeof(nkChar));
+    entry->cstr[length] = '\0';
+
+    nk_hashmap_insert(&nk__name_table, nkString(cstr, length), entry);
+
+    name.entry = entry;
+    return name;
+}
+
+NKAPI NKINLINE nkName nk_name_find(const nkChar* cstr)
+{
+    NK_ASSERT(cstr);
+
+    nkName name;
+    nk__NameEntry** entry = nk_hashmap_getptr(&nk__name_table, cstr);
+    if(entry) name.entry = *entry;
+    return name;
+}
+
+NKAPI NKINLINE const nkChar* nk_name_cstr(nkName name)
+{
+    return (name.entry) ? name.entry->cstr : "";
+}
+
+NKAPI NKINLINE nkU64 nk_name_length(nkName name)
+{
+    return (name.entry) ? name.entry->length : 0;
+}
+
+NKAPI NKINLINE nkU64 nk_name_hash(nkName name)
+{
+    return (name.entry) ? name.entry->hash : 0;
+}
+
+NKAPI NKINLINE nkBool nk_name_empty(nkName name)
+{
+    return (name.entry == NULL);
+}
+
+NKAPI NKINLINE void nk_name_free_all(void)
+{
+    for(auto& slot: nk__name_table)
+    {
+        NK_FREE(slot.value);
+    }
+    nk_hashmap_free(&nk__name_table);
+}
+
+#endif /* NK_NAME_H__ ////////////////////////////////////////////////////////*/
+
+/*******************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2022-2023 Joshua Robertson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+*******************************************************************************/
@@ -33,9 +33,11 @@ nkNPAKEntry;
 
 typedef struct nkNPAK
 {
-    nkNPAKHeader* header;
-    nkNPAKEntry*  entries; // @Speed: Hash map entries for faster file lookups.
-    nkU8*         data_blob;
+    nkNPAKHeader*      header;
+    nkNPAKEntry*       entries; // @Speed: Hash map entries for faster file lookups.
+    nkU8*              data_blob;
+    nkU64              data_size;
+    const nkAllocator* allocator; // Set before loading to pick where the NPAK is allocated, NULL uses the nk memory macros.
 }
 nkNPAK;
 
@@ -178,15 +180,27 @@ NKAPI nkBool nk_npak_unpack(const nkChar* npak_name, const nkChar* dst_path)
 
 NKAPI nkBool nk_npak_load(nkNPAK* npak, const nkChar* npak_name)
 {
-    // @Todo: Custom memory allocators.
-
     NK_ASSERT(npak);
 
-    // Load the entire NPAK into a single data blob.
-    nkFileContent file_content = NK_ZERO_MEM;
-    if(!nk_read_file_content(&file_content, npak_name, nkFileReadMode_Binary))
+    // Load the entire NPAK into a single data blob. This is read directly rather
+    // than with nk_read_file_content so the blob can come from our allocator.
+    FILE* file = fopen(npak_name, "rb");
+    if(!file) return NK_FALSE;
+
+    fseek(file, 0L, SEEK_END);
+    npak->data_size = ftell(file);
+    rewind(file);
+
+    npak->data_blob = NK_CAST(nkU8*, NK_ALLOCATOR_MALLOC(npak->allocator, npak->data_size));
+    if(!npak->data_blob || fread(npak->data_blob, npak->data_size, 1, file) != 1)
+    {
+        fclose(file);
         return NK_FALSE;
-    npak->data_blob = NK_CAST(nkU8*,file_content.data);
+    }
+
+    fclose(file);
+
+    if(npak->data_size < sizeof(nkNPAKHeader)) return NK_FALSE;
 
     // The header can just point into the blob.
     npak->header = NK_CAST(nkNPAKHeader*, npak->data_blob);
@@ -196,7 +210,7 @@ NKAPI nkBool nk_npak_load(nkNPAK* npak, const nkChar* npak_name)
     if(npak->header->fourcc != NK_NPAK_FILE_FOURCC) return NK_FALSE;
 
     // Build the map of entries.
-    npak->entries = NK_MALLOC_TYPES(nkNPAKEntry, npak->header->entries);
+    npak->entries = NK_CAST(nkNPAKEntry*, NK_ALLOCATOR_MALLOC(npak->allocator, npak->header->entries * sizeof(nkNPAKEntry)));
     if(!npak->entries) return NK_FALSE;
 
     nkU64 current_offset = npak->header->table_offset;
@@ -217,12 +231,19 @@ NKAPI nkBool nk_npak_load(nkNPAK* npak, const nkChar* npak_name)
 
 NKAPI void nk_npak_free(nkNPAK* npak)
 {
-    // @Todo: Custom memory allocators.
-
     NK_ASSERT(npak);
 
-    NK_FREE(npak->data_blob);
-    NK_FREE(npak->entries);
+    if(npak->data_blob)
+    {
+        if(npak->entries)
+            NK_ALLOCATOR_FREE(npak->allocator, npak->entries, npak->header->entries * sizeof(nkNPAKEntry));
+        NK_ALLOCATOR_FREE(npak->allocator, npak->data_blob, npak->data_size);
+    }
+
+    npak->header    = NULL;
+    npak->entries   = NULL;
+    npak->data_blob = NULL;
+    npak->data_size = 0;
 }
 
 NKAPI void* nk_npak_get_file_data(nkNPAK* npak, const nkChar* file_name, nkU64* size)
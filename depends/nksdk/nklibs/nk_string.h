@@ -10,13 +10,22 @@
 #error nk_string requires C++ in order to be used
 #endif
 
+// Strings short enough to fit in NK_STRING_SMALL_SIZE (including the null-
+// terminator) are stored inside of the string itself rather than allocated,
+// in which case cstr points at small and allocated is zero. Because of this a
+// string must not be copied or moved with memcpy/realloc, go through the copy
+// and move functions instead. A zeroed string is still a valid empty string.
+NKINTERNAL NKCONSTEXPR nkU64 NK_STRING_SMALL_SIZE = 24;
+
 struct nkString
 {
     nkU64 length    = 0;
-    nkU64 allocated = 0;
+    nkU64 allocated = 0; // Zero unless the characters are on the heap.
 
     nkChar* cstr = NULL;
 
+    nkChar small[NK_STRING_SMALL_SIZE];
+
     nkString(void);
     nkString(const nkString& other);
     nkString(nkString&& other);
@@ -156,6 +165,11 @@ nkChar* nkString::end(void)
     return (cstr + length);
 }
 
+// Catches strings that have been moved around with memcpy/realloc, which
+// leaves cstr pointing into the small buffer of wherever they used to be.
+#define NK__STRING_ASSERT_VALID(string) \
+    NK_ASSERT((string)->allocated || !(string)->cstr || (string)->cstr == (string)->small)
+
 // Used internally by the string functions to grow the string and should not be
 // used externally. If you want to grow an string use nk_string_reserve instead.
 NKINTERNAL void nk__string_grow_if_necessary(nkString* string, nkU64 new_size)
@@ -163,17 +177,38 @@ NKINTERNAL void nk__string_grow_if_necessary(nkString* string, nkU64 new_size)
     NKPERSISTENT NKCONSTEXPR nkU64 NK_STRING_SMALLEST_SIZE = 32;
 
     NK_ASSERT(string);
+    NK__STRING_ASSERT_VALID(string);
 
     new_size +=1; // For the null-terminator.
 
-    // If the requested new size amount is less than our currently allocated size
-    // then we do not need to grow the string data and can just early return here.
-    if(string->allocated >= new_size) return;
+    // If the requested new size amount is less than our current capacity then
+    // we do not need to grow the string data and can just early return here.
+    // Strings that have never held anything start using the small buffer.
+    nkU64 capacity = (string->allocated) ? string->allocated : NK_STRING_SMALL_SIZE;
+    if(capacity >= new_size)
+    {
+        if(!string->cstr)
+        {
+            string->cstr = string->small;
+            string->cstr[string->length] = '\0';
+        }
+        return;
+    }
 
     nkU64 allocate_size = new_size * 2;
     if(allocate_size < NK_STRING_SMALLEST_SIZE)
         allocate_size = NK_STRING_SMALLEST_SIZE;
-    string->cstr = NK_RALLOC_TYPES(nkChar, string->cstr, allocate_size);
+    if(string->allocated)
+    {
+        string->cstr = NK_RALLOC_TYPES(nkChar, string->cstr, allocate_size);
+    }
+    else
+    {
+        nkChar* cstr = NK_MALLOC_TYPES(nkChar, allocate_size);
+        if(string->cstr)
+            memcpy(cstr, string->cstr, string->length * sizeof(nkChar));
+        string->cstr = cstr;
+    }
     string->cstr[string->length] = '\0';
     string->allocated = allocate_size;
 }
@@ -181,8 +216,9 @@ NKINTERNAL void nk__string_grow_if_necessary(nkString* string, nkU64 new_size)
 NKAPI NKINLINE void nk_string_free(nkString* string)
 {
     NK_ASSERT(string);
+    NK__STRING_ASSERT_VALID(string);
 
-    if(string->cstr)
+    if(string->allocated)
         NK_FREE(string->cstr);
     string->cstr = NULL;
 
@@ -303,8 +339,9 @@ NKAPI NKINLINE void nk_string_append(nkString* string, const nkChar* cstr, nkU64
 
     nk__string_grow_if_necessary(string, string->length + length);
 
-    strncat(string->cstr, cstr, length);
+    memcpy(string->cstr + string->length, cstr, length * sizeof(nkChar));
     string->length += length;
+    string->cstr[string->length] = '\0';
 }
 
 NKAPI NKINLINE void nk_string_append(nkString* string, nkChar c)
@@ -381,6 +418,8 @@ NKAPI NKINLINE void nk_string_copy(nkString* string, const nkString* other)
     NK_ASSERT(string);
     NK_ASSERT(other);
 
+    if(string == other) return;
+
     nk_string_assign(string, other);
 }
 
@@ -388,13 +427,23 @@ NKAPI NKINLINE void nk_string_move(nkString* string, nkString* other)
 {
     NK_ASSERT(string);
     NK_ASSERT(other);
+    NK__STRING_ASSERT_VALID(other);
+
+    if(string == other) return;
 
     nk_string_free(string);
 
+    // Heap strings hand over their allocation, small strings have to be copied into our own small buffer.
     string->length    = other->length;
     string->allocated = other->allocated;
     string->cstr      = other->cstr;
 
+    if(!other->allocated && other->cstr)
+    {
+        memcpy(string->small, other->small, (other->length+1) * sizeof(nkChar));
+        string->cstr = string->small;
+    }
+
     other->length     = 0;
     other->allocated  = 0;
     other->cstr       = NULL;
@@ -419,7 +468,10 @@ NKAPI NKINLINE nkBool nk_string_compare(const nkString* string, const nkString*
     NK_ASSERT(string);
     NK_ASSERT(other);
 
-    return (strcmp(string->cstr, other->cstr) == 0);
+    if(string->length != other->length) return NK_FALSE;
+    if(string->length == 0) return NK_TRUE; // Either could have a NULL cstr.
+
+    return (memcmp(string->cstr, other->cstr, string->length * sizeof(nkChar)) == 0);
 }
 
 NKAPI NKINLINE void nk_string_lower(nkString* string)
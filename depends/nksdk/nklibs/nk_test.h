@@ -102,7 +102,7 @@ NKAPI void nk_test_check(nkTestContext* ctx, nkBool expr, const nkChar* expr_str
     else
     {
         nkS32 index = (ctx->checks_performed - ctx->checks_passed);
-        NK_ASSERT(index < NK_ARRAY_SIZE(ctx->failure));
+        NK_ASSERT(index < NK_CAST(nkS32, NK_ARRAY_SIZE(ctx->failure)));
 
         nkTestFailure* failure = &ctx->failure[index];
 
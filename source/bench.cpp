@@ -0,0 +1,588 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+// =============================================================================
+// Runs a fixed set of synthetic scenes one after the other, each for a fixed
+// number of frames, then writes out frame time percentiles and draw call counts
+// as JSON (to stdout and bench.json) so results can be compared across builds.
+//
+// Frame times cover the whole trip round the main loop (input, tick, draw and
+// present). Built headless the draws go to the stub renderer, which measures
+// the CPU side of the engine on its own. Ticks use the fixed timestep and the
+// RNG is seeded the same every run, so each run does exactly the same work.
+// =============================================================================
+
+#include <engine.hpp>
+
+INTERNAL constexpr nkS32 BENCH_WARMUP_FRAMES = 30;
+INTERNAL constexpr nkS32 BENCH_FRAMES        = 600;
+INTERNAL constexpr nkU32 BENCH_SEED          = 0xBE7C4;
+
+INTERNAL constexpr const nkChar* BENCH_RESULTS_FILE = "bench.json";
+
+typedef void(*BenchSceneFunction)(nkS32 count);
+
+struct BenchScene
+{
+    const nkChar*      name;
+    nkS32              count; // How many things the scene draws/loads/tests each frame.
+    BenchSceneFunction init;
+    BenchSceneFunction tick;
+    BenchSceneFunction draw;
+};
+
+struct BenchResult
+{
+    nkArray<nkF32> frame_ms;
+    nkArray<nkU64> draw_calls;
+    nkArray<nkU64> vertices;
+};
+
+struct BenchSprite
+{
+    nkVec2 pos;
+    nkVec2 scale;
+    nkF32  angle;
+    nkF32  spin;
+    nkVec4 color;
+};
+
+// Shapes for the collision scenes, stored as arrays of components so they can be passed to the batch tests.
+struct BenchShapes
+{
+    nkArray<nkF32> x;
+    nkArray<nkF32> y;
+    nkArray<nkF32> w;
+    nkArray<nkF32> h;
+    nkArray<nkF32> r;
+    nkArray<nkU32> hits;
+    nkArray<nkU32> indices;
+    nkU64          hit_count; // Keeps the results used so the tests can't be optimized out.
+};
+
+// Maps and keys for the hashmap scenes, misses are keys that were never inserted.
+struct BenchMaps
+{
+    nkHashMap<nkU32,nkU32>    ints;
+    nkHashMap<nkString,nkU32> names;
+    nkArray<nkU32>            int_keys;
+    nkArray<nkU32>            int_misses;
+    nkString*                 name_keys;
+    nkString*                 name_misses;
+    nkU64                     found; // Keeps the results used so the lookups can't be optimized out.
+};
+
+struct BenchContext
+{
+    nkS32                scene;
+    nkS32                frame;
+    nkU64                last_frame_us;
+    nkF32                timer;
+    nkArray<BenchSprite> sprites;
+    BenchShapes          shapes;
+    BenchMaps            maps;
+    BenchResult          results[16];
+};
+
+INTERNAL BenchContext g_bench;
+
+// Helpers =====================================================================
+INTERNAL void randomize_bench_sprites(nkS32 count)
+{
+    nkF32 sw = NK_CAST(nkF32, get_screen_width());
+    nkF32 sh = NK_CAST(nkF32, get_screen_height());
+
+    nk_array_clear(&g_bench.sprites);
+    nk_array_reserve(&g_bench.sprites, count);
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        nkF32 scale = rng_f32(0.05f, 0.25f);
+
+        BenchSprite sprite;
+        sprite.pos   = { rng_f32(0.0f, sw), rng_f32(0.0f, sh) };
+        sprite.scale = { scale, scale };
+        sprite.angle = rng_f32(0.0f, NK_PI_F32 * 2.0f);
+        sprite.spin  = rng_f32(-2.0f, 2.0f);
+        sprite.color = { rng_f32(0.5f, 1.0f), rng_f32(0.5f, 1.0f), rng_f32(0.5f, 1.0f), 1.0f };
+        nk_array_append(&g_bench.sprites, sprite);
+    }
+}
+
+INTERNAL void tick_bench_sprites(nkF32 dt)
+{
+    for(auto& sprite: g_bench.sprites)
+        sprite.angle += sprite.spin * dt;
+}
+
+INTERNAL void draw_bench_sprites(void)
+{
+    Texture face = asset_manager_load<Texture>("face.png");
+
+    imm_begin_texture_batch(face);
+    for(auto& sprite: g_bench.sprites)
+        imm_texture_batched_ex(sprite.pos.x,sprite.pos.y, sprite.scale.x,sprite.scale.y, sprite.angle, NULL, NULL, sprite.color);
+    imm_end_texture_batch();
+}
+
+INTERNAL void randomize_bench_shapes(nkS32 count)
+{
+    nkF32 sw = NK_CAST(nkF32, get_screen_width());
+    nkF32 sh = NK_CAST(nkF32, get_screen_height());
+
+    BenchShapes& shapes = g_bench.shapes;
+
+    nk_array_clear(&shapes.x);
+    nk_array_clear(&shapes.y);
+    nk_array_clear(&shapes.w);
+    nk_array_clear(&shapes.h);
+    nk_array_clear(&shapes.r);
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        nk_array_append(&shapes.x, rng_f32(0.0f, sw));
+        nk_array_append(&shapes.y, rng_f32(0.0f, sh));
+        nk_array_append(&shapes.w, rng_f32(4.0f, 32.0f));
+        nk_array_append(&shapes.h, rng_f32(4.0f, 32.0f));
+        nk_array_append(&shapes.r, rng_f32(2.0f, 16.0f));
+    }
+
+    nk_array_clear(&shapes.hits);
+    nk_array_clear(&shapes.indices);
+    for(nkU64 i=0, n=get_batch_hit_words(count); i<n; ++i)
+        nk_array_append(&shapes.hits, 0u);
+    for(nkS32 i=0; i<count; ++i)
+        nk_array_append(&shapes.indices, 0u);
+
+    shapes.hit_count = 0;
+}
+
+INTERNAL TrueTypeFont load_bench_font(void)
+{
+    TrueTypeFontDesc ttd;
+    ttd.px_sizes = { 24 };
+    return asset_manager_load<TrueTypeFont>("helsinki.ttf", &ttd);
+}
+// =============================================================================
+
+// Scenes ======================================================================
+INTERNAL void init_sprite_scene(nkS32 count)
+{
+    randomize_bench_sprites(count);
+}
+
+INTERNAL void tick_sprite_scene(nkS32 count)
+{
+    tick_bench_sprites(1.0f / get_app_desc()->tick_rate);
+}
+
+INTERNAL void draw_sprite_scene(nkS32 count)
+{
+    draw_bench_sprites();
+}
+
+INTERNAL void init_text_scene(nkS32 count)
+{
+    load_bench_font();
+}
+
+INTERNAL void draw_text_scene(nkS32 count)
+{
+    TrueTypeFont font = load_bench_font();
+    set_truetype_font_size(font, 24);
+
+    PERSISTENT const nkChar* LINES[] =
+    {
+        "The quick brown fox jumps over the lazy dog.",
+        "Pack my box with five dozen liquor jugs!",
+        "How vexingly quick daft zebras jump?",
+        "0123456789 +-*/=()[]{}<>?!.,:;'\"@#$%^&"
+    };
+
+    nkF32 sw = NK_CAST(nkF32, get_screen_width());
+    nkF32 sh = NK_CAST(nkF32, get_screen_height());
+    nkF32 lh = get_truetype_line_height(font);
+
+    nkS32 rows = nk_max(1, NK_CAST(nkS32, sh / lh));
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        nkF32 x = fmodf(NK_CAST(nkF32, (i / rows) * 37) + g_bench.timer * 60.0f, sw);
+        nkF32 y = NK_CAST(nkF32, i % rows) * lh;
+        draw_truetype_text(font, x,y, LINES[i % NK_ARRAY_SIZE(LINES)], NK_V4_WHITE);
+    }
+}
+
+INTERNAL void draw_circle_scene(nkS32 count)
+{
+    nkF32 sw = NK_CAST(nkF32, get_screen_width());
+    nkF32 sh = NK_CAST(nkF32, get_screen_height());
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        nkF32 t = NK_CAST(nkF32, i) / NK_CAST(nkF32, count);
+        nkF32 x = nk_sin_range(0.0f, sw, g_bench.timer + t * 97.0f);
+        nkF32 y = nk_sin_range(0.0f, sh, g_bench.timer * 0.7f + t * 61.0f);
+        imm_circle_filled(x,y, 4.0f + t * 12.0f, 32, { t, 1.0f-t, 0.5f, 1.0f });
+    }
+}
+
+INTERNAL void tick_post_process_scene(nkS32 count)
+{
+    tick_bench_sprites(1.0f / get_app_desc()->tick_rate);
+
+    // Effects are cleared before each tick so they have to be pushed again every time.
+    push_post_process_resample("bench_half", 0.5f);
+    push_post_process_blur("bench_blur", 4);
+    push_post_process_resample("bench_full", 2.0f);
+}
+
+INTERNAL void init_asset_scene(nkS32 count)
+{
+    randomize_bench_sprites(64);
+}
+
+INTERNAL void draw_asset_scene(nkS32 count)
+{
+    // Unload and reload the same assets over and over, alternating between a texture and a font so both the image
+    // decoding and the glyph rasterization paths get hit. Assets come from the NPAK when there is one.
+    for(nkS32 i=0; i<count; ++i)
+    {
+        if(i % 2 == 0)
+        {
+            asset_manager_free<Texture>("face.png");
+            asset_manager_load<Texture>("face.png");
+        }
+        else
+        {
+            asset_manager_free<TrueTypeFont>("helsinki.ttf");
+            load_bench_font();
+        }
+    }
+
+    draw_bench_sprites();
+}
+
+// The two collision scenes do the same work, every shape's circle against every other circle and rect collecting the
+// indices of whatever it hits, one through the scalar tests and one through the batch tests so they can be compared.
+INTERNAL void init_collision_scene(nkS32 count)
+{
+    randomize_bench_shapes(count);
+}
+
+INTERNAL void tick_collision_scalar_scene(nkS32 count)
+{
+    BenchShapes& shapes = g_bench.shapes;
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        fCircle c = { shapes.x[i], shapes.y[i], shapes.r[i] };
+
+        nkU64 hits = 0;
+        for(nkS32 j=0; j<count; ++j)
+            if(circle_vs_circle(c, { shapes.x[j], shapes.y[j], shapes.r[j] }))
+                shapes.indices[hits++] = j;
+        shapes.hit_count += hits;
+
+        hits = 0;
+        for(nkS32 j=0; j<count; ++j)
+            if(circle_vs_rect(c, { shapes.x[j], shapes.y[j], shapes.w[j], shapes.h[j] }))
+                shapes.indices[hits++] = j;
+        shapes.hit_count += hits;
+    }
+}
+
+INTERNAL void tick_collision_batch_scene(nkS32 count)
+{
+    BenchShapes& shapes = g_bench.shapes;
+
+    fCircleSoA circles = { shapes.x.data, shapes.y.data, shapes.r.data };
+    fRectSoA   rects   = { shapes.x.data, shapes.y.data, shapes.w.data, shapes.h.data };
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        fCircle c = { shapes.x[i], shapes.y[i], shapes.r[i] };
+
+        circle_vs_circles(c, circles, count, shapes.hits.data);
+        shapes.hit_count += get_batch_hit_indices(shapes.hits.data, count, shapes.indices.data);
+        circle_vs_rects(c, rects, count, shapes.hits.data);
+        shapes.hit_count += get_batch_hit_indices(shapes.hits.data, count, shapes.indices.data);
+    }
+}
+
+// Each frame the maps are emptied, then every key is inserted and looked up, along with the same number of misses.
+INTERNAL void init_hashmap_scene(nkS32 count)
+{
+    BenchMaps& maps = g_bench.maps;
+
+    nk_array_clear(&maps.int_keys);
+    nk_array_clear(&maps.int_misses);
+
+    delete[] maps.name_keys;
+    delete[] maps.name_misses;
+
+    maps.name_keys   = new nkString[count];
+    maps.name_misses = new nkString[count];
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        // Multiplying by an odd number never maps two numbers to the same key, so evens and odds can't overlap.
+        nk_array_append(&maps.int_keys,   NK_CAST(nkU32, i*2+0) * 2654435761u);
+        nk_array_append(&maps.int_misses, NK_CAST(nkU32, i*2+1) * 2654435761u);
+
+        nkChar buffer[64];
+        snprintf(buffer, sizeof(buffer), "textures/sprite_%d.png", i);
+        maps.name_keys[i] = buffer;
+        snprintf(buffer, sizeof(buffer), "textures/sprite_%d.jpg", i);
+        maps.name_misses[i] = buffer;
+    }
+
+    maps.found = 0;
+}
+
+INTERNAL void tick_hashmap_scene(nkS32 count)
+{
+    BenchMaps& maps = g_bench.maps;
+
+    nk_hashmap_clear(&maps.ints);
+    nk_hashmap_clear(&maps.names);
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        nk_hashmap_insert(&maps.ints, maps.int_keys[i], NK_CAST(nkU32, i));
+        nk_hashmap_insert(&maps.names, maps.name_keys[i], NK_CAST(nkU32, i));
+    }
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        maps.found += (nk_hashmap_getptr(&maps.ints,  maps.int_keys   [i]) != NULL);
+        maps.found += (nk_hashmap_getptr(&maps.ints,  maps.int_misses [i]) != NULL);
+        maps.found += (nk_hashmap_getptr(&maps.names, maps.name_keys  [i]) != NULL);
+        maps.found += (nk_hashmap_getptr(&maps.names, maps.name_misses[i]) != NULL);
+    }
+}
+
+INTERNAL const BenchScene BENCH_SCENES[] =
+{
+    { "sprites",          10000, init_sprite_scene,    tick_sprite_scene,           draw_sprite_scene },
+    { "text",              2000, init_text_scene,      NULL,                        draw_text_scene   },
+    { "circles",           2000, NULL,                 NULL,                        draw_circle_scene },
+    { "post_process",      1000, init_sprite_scene,    tick_post_process_scene,     draw_sprite_scene },
+    { "asset_storm",         16, init_asset_scene,     NULL,                        draw_asset_scene  },
+    { "collision_scalar",  1000, init_collision_scene, tick_collision_scalar_scene, NULL              },
+    { "collision_batch",   1000, init_collision_scene, tick_collision_batch_scene,  NULL              },
+    { "hashmap_1k",        1000, init_hashmap_scene,   tick_hashmap_scene,          NULL              },
+    { "hashmap_100k",    100000, init_hashmap_scene,   tick_hashmap_scene,          NULL              }
+};
+
+INTERNAL constexpr nkS32 BENCH_SCENE_COUNT = NK_CAST(nkS32, NK_ARRAY_SIZE(BENCH_SCENES));
+
+NK_STATIC_ASSERT(BENCH_SCENE_COUNT <= NK_ARRAY_SIZE(g_bench.results), too_many_bench_scenes);
+// =============================================================================
+
+// Results =====================================================================
+INTERNAL int compare_f32(const void* a, const void* b)
+{
+    nkF32 x = *NK_CAST(const nkF32*, a);
+    nkF32 y = *NK_CAST(const nkF32*, b);
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+INTERNAL nkF32 get_percentile(const nkArray<nkF32>& sorted, nkF32 percentile)
+{
+    if(sorted.length == 0) return 0.0f;
+    nkU64 index = NK_CAST(nkU64, percentile * NK_CAST(nkF32, sorted.length - 1) + 0.5f);
+    return sorted.data[nk_min(index, sorted.length - 1)];
+}
+
+INTERNAL void write_bench_results(FILE* file)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "    \"frames\": %d,\n", BENCH_FRAMES);
+    fprintf(file, "    \"headless\": %s,\n",
+    #if defined(BUILD_HEADLESS)
+        "true"
+    #else
+        "false"
+    #endif // BUILD_HEADLESS
+    );
+    fprintf(file, "    \"scenes\":\n");
+    fprintf(file, "    [\n");
+
+    for(nkS32 i=0; i<BENCH_SCENE_COUNT; ++i)
+    {
+        BenchResult& result = g_bench.results[i];
+
+        nkF32 total_ms = 0.0f;
+        for(auto& ms: result.frame_ms)
+            total_ms += ms;
+
+        nkU64 total_draw_calls = 0, max_draw_calls = 0;
+        for(auto& calls: result.draw_calls)
+        {
+            total_draw_calls += calls;
+            max_draw_calls = nk_max(max_draw_calls, calls);
+        }
+
+        nkU64 total_vertices = 0;
+        for(auto& verts: result.vertices)
+            total_vertices += verts;
+
+        nkF32 frames = NK_CAST(nkF32, nk_max(result.frame_ms.length, NK_CAST(nkU64, 1)));
+
+        qsort(result.frame_ms.data, result.frame_ms.length, sizeof(nkF32), compare_f32);
+
+        fprintf(file, "        {\n");
+        fprintf(file, "            \"name\": \"%s\",\n", BENCH_SCENES[i].name);
+        fprintf(file, "            \"count\": %d,\n", BENCH_SCENES[i].count);
+        fprintf(file, "            \"cpu_frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            total_ms / frames,
+            get_percentile(result.frame_ms, 0.50f),
+            get_percentile(result.frame_ms, 0.90f),
+            get_percentile(result.frame_ms, 0.99f),
+            get_percentile(result.frame_ms, 1.00f));
+        fprintf(file, "            \"draw_calls\": { \"mean\": %.2f, \"max\": %llu },\n",
+            NK_CAST(nkF32, total_draw_calls) / frames, NK_CAST(unsigned long long, max_draw_calls));
+        fprintf(file, "            \"vertices\": { \"mean\": %.2f }\n",
+            NK_CAST(nkF32, total_vertices) / frames);
+        fprintf(file, "        }%s\n", (i+1 < BENCH_SCENE_COUNT) ? "," : "");
+    }
+
+    fprintf(file, "    ]\n");
+    fprintf(file, "}\n");
+}
+
+INTERNAL void finish_bench(void)
+{
+    write_bench_results(stdout);
+
+    FILE* file = fopen(BENCH_RESULTS_FILE, "w");
+    if(!file)
+    {
+        printf("[Bench]: Failed to open results file: %s\n", BENCH_RESULTS_FILE);
+    }
+    else
+    {
+        write_bench_results(file);
+        fclose(file);
+    }
+
+    terminate_app();
+}
+
+INTERNAL void start_bench_scene(nkS32 scene)
+{
+    g_bench.scene = scene;
+    g_bench.frame = 0;
+    g_bench.timer = 0.0f;
+
+    if(scene >= BENCH_SCENE_COUNT)
+    {
+        finish_bench();
+        return;
+    }
+
+    printf("[Bench]: Running scene %s...\n", BENCH_SCENES[scene].name);
+
+    rng_seed(BENCH_SEED); // Each scene gets the same random numbers however many scenes ran before it.
+
+    if(BENCH_SCENES[scene].init)
+        BENCH_SCENES[scene].init(BENCH_SCENES[scene].count);
+}
+// =============================================================================
+
+// Application =================================================================
+GLOBAL void app_main(AppDesc* desc)
+{
+    desc->title         = "Benchmark";
+    desc->name          = "bench";
+    desc->screen_mode   = ScreenMode_Stretch; // Post-processing only happens with a screen target, this one stays a fixed size.
+    desc->vsync         = VSyncMode_Off; // We want to know how long frames take, not how long we wait for the display.
+    desc->frame_cap     = 0.0f;
+    desc->max_ticks     = 1;
+    desc->headless_rate = 0.0f;
+    desc->headless_draw = NK_TRUE;
+}
+
+GLOBAL void app_init(void)
+{
+    start_bench_scene(0);
+}
+
+GLOBAL void app_quit(void)
+{
+    for(auto& result: g_bench.results)
+    {
+        nk_array_free(&result.frame_ms);
+        nk_array_free(&result.draw_calls);
+        nk_array_free(&result.vertices);
+    }
+    nk_array_free(&g_bench.sprites);
+    nk_array_free(&g_bench.shapes.x);
+    nk_array_free(&g_bench.shapes.y);
+    nk_array_free(&g_bench.shapes.w);
+    nk_array_free(&g_bench.shapes.h);
+    nk_array_free(&g_bench.shapes.r);
+    nk_array_free(&g_bench.shapes.hits);
+    nk_array_free(&g_bench.shapes.indices);
+    nk_hashmap_free(&g_bench.maps.ints);
+    nk_hashmap_free(&g_bench.maps.names);
+    nk_array_free(&g_bench.maps.int_keys);
+    nk_array_free(&g_bench.maps.int_misses);
+    delete[] g_bench.maps.name_keys;
+    delete[] g_bench.maps.name_misses;
+    g_bench.maps.name_keys   = NULL;
+    g_bench.maps.name_misses = NULL;
+}
+
+GLOBAL void app_tick(nkF32 dt)
+{
+    if(g_bench.scene >= BENCH_SCENE_COUNT) return;
+
+    g_bench.timer += dt;
+
+    const BenchScene& scene = BENCH_SCENES[g_bench.scene];
+    if(scene.tick)
+        scene.tick(scene.count);
+}
+
+GLOBAL void app_draw(void)
+{
+    if(g_bench.scene >= BENCH_SCENE_COUNT) return;
+
+    // Time from the start of one draw to the next covers a whole frame. The stats are for the last presented frame.
+    nkU64 now_us = get_system_time_us();
+    if(g_bench.frame > BENCH_WARMUP_FRAMES)
+    {
+        BenchResult& result = g_bench.results[g_bench.scene];
+        RenderStats stats = get_render_stats();
+        nk_array_append(&result.frame_ms, NK_CAST(nkF32, now_us - g_bench.last_frame_us) / 1000.0f);
+        nk_array_append(&result.draw_calls, stats.draw_calls);
+        nk_array_append(&result.vertices, stats.vertices);
+    }
+    g_bench.last_frame_us = now_us;
+
+    if(g_bench.frame >= BENCH_WARMUP_FRAMES + BENCH_FRAMES)
+    {
+        start_bench_scene(g_bench.scene + 1);
+        if(g_bench.scene >= BENCH_SCENE_COUNT) return;
+    }
+
+    g_bench.frame++;
+
+    nkF32 sw = NK_CAST(nkF32, get_screen_width());
+    nkF32 sh = NK_CAST(nkF32, get_screen_height());
+
+    imm_set_color_target(get_screen());
+
+    imm_clear(0.1f, 0.1f, 0.1f);
+
+    imm_set_projection(nk_orthographic(0.0f,sw,sh,0.0f));
+    imm_set_viewport(0.0f,0.0f,sw,sh);
+
+    const BenchScene& scene = BENCH_SCENES[g_bench.scene];
+    if(scene.draw)
+        scene.draw(scene.count);
+}
+// =============================================================================
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -13,7 +13,7 @@ GLOBAL AnimGroup* create_animation_group(void* data, nkU64 size)
     NK_DEFER(NK_FREE(buffer));
 
     // Parse the content of the animation group file line-by-line.
-    nkString anim_name;
+    nkName anim_name;
 
     nkChar* cursor = buffer;
     while(*cursor)
@@ -50,7 +50,7 @@ GLOBAL AnimGroup* create_animation_group(void* data, nkU64 size)
                 if(strcmp(ident, "NAME") == 0)
                 {
                     str_eat_space(&line);
-                    nk_string_assign(&anim_name, line);
+                    anim_name = nk_name_intern(line);
                     continue;
                 }
                 if(strcmp(ident, "LOOP") == 0)
@@ -111,12 +111,18 @@ GLOBAL AnimState create_animation_state(const nkChar* group_name)
 }
 
 GLOBAL void set_animation(AnimState* state, const nkChar* anim_name, nkBool reset)
+{
+    // Names that have never been interned can't be in any group so this is fine.
+    set_animation(state, nk_name_find(anim_name), reset);
+}
+
+GLOBAL void set_animation(AnimState* state, nkName anim_name, nkBool reset)
 {
     NK_ASSERT(state);
     NK_ASSERT(state->anims);
 
     // Early out if neceesary.
-    Anim* anim = nk_hashmap_getptr(&state->anims->anims, nkString(anim_name));
+    Anim* anim = nk_hashmap_getptr(&state->anims->anims, anim_name);
     if(!anim || (state->current == anim && !reset)) return;
 
     state->current = anim;
@@ -192,11 +198,16 @@ GLOBAL void reset_animation(AnimState* state)
 }
 
 GLOBAL nkBool has_animation(AnimState* state, const nkChar* anim_name)
+{
+    return has_animation(state, nk_name_find(anim_name));
+}
+
+GLOBAL nkBool has_animation(AnimState* state, nkName anim_name)
 {
     NK_ASSERT(state);
     NK_ASSERT(state->anims);
 
-    return nk_hashmap_contains(&state->anims->anims, nkString(anim_name));
+    return nk_hashmap_contains(&state->anims->anims, anim_name);
 }
 
 GLOBAL nkBool is_animation_done(AnimState* state)
@@ -10,6 +10,14 @@ NK_ENUM(ScreenMode, nkS32)
     ScreenMode_TOTAL
 };
 
+NK_ENUM(VSyncMode, nkS32)
+{
+    VSyncMode_Off,      // Present as soon as a frame is ready, can tear.
+    VSyncMode_On,       // Wait for the display's vertical blank before presenting (default).
+    VSyncMode_Adaptive, // Wait for the vertical blank, unless the frame is late in which case present straight away.
+    VSyncMode_TOTAL
+};
+
 struct AppDesc
 {
     const nkChar* title         = "Template Game";         // Display name of the game (shown in the title bar).
@@ -20,6 +28,15 @@ struct AppDesc
     ScreenMode    screen_mode   = ScreenMode_Window;       // How the screen should be rendered to the window.
     ImmSampler    screen_filter = ImmSampler_ClampNearest; // How the screen should be filtered when rendered to the window.
     nkF32         tick_rate     = 60.0f;                   // How many times to run the tick callback each second.
+    nkS32         max_ticks     = 5;                       // Most ticks run in one frame (zero for no limit), past this the game slows down rather than catching up.
+    nkBool        render_thread = NK_FALSE;                // Replay rendering on its own thread, one frame behind the game (ignored on web).
+    VSyncMode     vsync         = VSyncMode_On;            // How presenting should sync up with the display's refresh.
+    nkF32         frame_cap     = 0.0f;                    // Max frames drawn each second, zero for no cap (works with or without vsync).
+    nkBool        frame_pacing  = NK_FALSE;                // Keep the GPU at most a frame behind, and cap to the display's refresh when vsync is off.
+    nkF32         headless_rate = 0.0f;                    // Headless builds only, how many times faster than real time to tick (zero ticks as fast as possible).
+    nkBool        headless_draw = NK_FALSE;                // Headless builds only, still draw each frame with the stub renderer (to profile the CPU side of drawing).
+    const nkChar* record_input  = NULL;                    // Record the session's input to this file (can also be set with -record <file>).
+    const nkChar* replay_input  = NULL;                    // Replay the session's input from this file (can also be set with -replay <file>).
 };
 
 // External user-defined functions!
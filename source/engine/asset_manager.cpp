@@ -109,10 +109,9 @@ template<typename T>
 GLOBAL void asset_manager_free(const nkChar* name)
 {
     if(!asset_manager_has<T>(name)) return; // Asset doesn't exist so it can't be freed.
-    nkString asset_name = name;
-    Asset<T>* asset = NK_CAST(Asset<T>*, nk_hashmap_getref(&g_asset_manager.assets, asset_name));
+    Asset<T>* asset = NK_CAST(Asset<T>*, nk_hashmap_getref(&g_asset_manager.assets, name));
     delete asset;
-    nk_hashmap_remove(&g_asset_manager.assets, asset_name);
+    nk_hashmap_remove(&g_asset_manager.assets, name);
 }
 
 template<typename T>
@@ -123,14 +122,14 @@ GLOBAL T asset_manager_get(const nkChar* name)
         printf("[Assets]: Attempting to find data for unknown asset: %s\n", name);
         return NK_ZERO_MEM;
     }
-    Asset<T>* asset = NK_CAST(Asset<T>*, nk_hashmap_getref(&g_asset_manager.assets, nkString(name)));
+    Asset<T>* asset = NK_CAST(Asset<T>*, nk_hashmap_getref(&g_asset_manager.assets, name));
     return asset->data;
 }
 
 template<typename T>
 GLOBAL nkBool asset_manager_has(const nkChar* name)
 {
-    return nk_hashmap_contains(&g_asset_manager.assets, nkString(name));
+    return nk_hashmap_contains(&g_asset_manager.assets, name);
 }
 
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -0,0 +1,190 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+// =============================================================================
+// Used by headless builds where there's no audio device to play through. Sound
+// and music handles are still handed out so game code doesn't need to care, and
+// volumes are kept so they still get saved and restored with the program state.
+// =============================================================================
+
+struct AudioContext
+{
+    nkF32 sound_volume;
+    nkF32 music_volume;
+};
+
+INTERNAL AudioContext g_audio;
+
+GLOBAL void init_audio_system(void)
+{
+    set_sound_volume(0.8f);
+    set_music_volume(0.7f);
+}
+
+GLOBAL void quit_audio_system(void)
+{
+    // Nothing...
+}
+
+// Audio =======================================================================
+
+GLOBAL void set_sound_volume(nkF32 volume)
+{
+    g_audio.sound_volume = nk_clamp(volume, 0.0f, 1.0f);
+}
+
+GLOBAL void set_music_volume(nkF32 volume)
+{
+    g_audio.music_volume = nk_clamp(volume, 0.0f, 1.0f);
+}
+
+GLOBAL nkF32 get_sound_volume(void)
+{
+    return g_audio.sound_volume;
+}
+
+GLOBAL nkF32 get_music_volume(void)
+{
+    return g_audio.music_volume;
+}
+
+GLOBAL nkBool is_sound_on(void)
+{
+    return (g_audio.sound_volume > 0.0f);
+}
+
+GLOBAL nkBool is_music_on(void)
+{
+    return (g_audio.music_volume > 0.0f);
+}
+
+GLOBAL nkBool is_music_playing(void)
+{
+    return NK_FALSE;
+}
+
+// =============================================================================
+
+// Sound =======================================================================
+
+DEFINE_PRIVATE_TYPE(Sound)
+{
+    // Nothing...
+};
+
+GLOBAL Sound create_sound_from_file(const nkChar* file_name)
+{
+    Sound sound = ALLOCATE_PRIVATE_TYPE(Sound);
+    if(!sound)
+        fatal_error("Failed to allocate sound!");
+    return sound;
+}
+
+GLOBAL Sound create_sound_from_data(void* data, nkU64 size)
+{
+    Sound sound = ALLOCATE_PRIVATE_TYPE(Sound);
+    if(!sound)
+        fatal_error("Failed to allocate sound!");
+    return sound;
+}
+
+GLOBAL void free_sound(Sound sound)
+{
+    if(!sound) return;
+    NK_FREE(sound);
+}
+
+GLOBAL SoundRef play_sound(Sound sound, nkS32 loops)
+{
+    return play_sound_on_channel(sound, loops, -1);
+}
+
+GLOBAL SoundRef play_sound_on_channel(Sound sound, nkS32 loops, nkS32 channel)
+{
+    NK_ASSERT(sound);
+    return INVALID_SOUND_REF;
+}
+
+GLOBAL void resume_sound(SoundRef sound_ref)
+{
+    // Nothing...
+}
+
+GLOBAL void pause_sound(SoundRef sound_ref)
+{
+    // Nothing...
+}
+
+GLOBAL void stop_sound(SoundRef sound_ref)
+{
+    // Nothing...
+}
+
+GLOBAL void fade_out_sound(SoundRef sound_ref, nkF32 seconds)
+{
+    // Nothing...
+}
+
+// =============================================================================
+
+// Music =======================================================================
+
+DEFINE_PRIVATE_TYPE(Music)
+{
+    // Nothing...
+};
+
+GLOBAL Music create_music_from_file(const nkChar* file_name)
+{
+    Music music = ALLOCATE_PRIVATE_TYPE(Music);
+    if(!music)
+        fatal_error("Failed to allocate music!");
+    return music;
+}
+
+GLOBAL Music create_music_from_data(void* data, nkU64 size)
+{
+    Music music = ALLOCATE_PRIVATE_TYPE(Music);
+    if(!music)
+        fatal_error("Failed to allocate music!");
+    return music;
+}
+
+GLOBAL void free_music(Music music)
+{
+    if(!music) return;
+    NK_FREE(music);
+}
+
+GLOBAL void play_music(Music music, nkS32 loops)
+{
+    NK_ASSERT(music);
+}
+
+GLOBAL void play_music_fade_in(Music music, nkS32 loops, nkF32 seconds)
+{
+    NK_ASSERT(music);
+}
+
+GLOBAL void resume_music(void)
+{
+    // Nothing...
+}
+
+GLOBAL void pause_music(void)
+{
+    // Nothing...
+}
+
+GLOBAL void stop_music(void)
+{
+    // Nothing...
+}
+
+GLOBAL void stop_music_fade_out(nkF32 seconds)
+{
+    // Nothing...
+}
+
+// =============================================================================
+
+/*////////////////////////////////////////////////////////////////////////////*/
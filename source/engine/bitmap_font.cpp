@@ -1,12 +1,70 @@
 /*////////////////////////////////////////////////////////////////////////////*/
 
+// Glyphs store their texture coordinates pre-divided by the atlas size so drawing doesn't have to query the texture.
+struct BitmapGlyph
+{
+    ImmClip clip;
+    nkF32   s1,t1,s2,t2;
+};
+
 DEFINE_PRIVATE_TYPE(BitmapFont)
 {
-    nkF32   px_height;
-    Texture atlas;
-    ImmClip glyphs[128];
+    nkF32                        px_height;
+    Texture                      atlas;
+    BitmapGlyph                  ascii[128]; // The ASCII range is always present so it gets a direct lookup.
+    nkHashMap<nkU32,BitmapGlyph> extended;   // Any extra codepoint ranges specified by the font file.
+};
+
+// Bitmap font files are made up of the atlas texture name, the glyph cell size, and then the width of each glyph in
+// the ASCII range. After that there can optionally be any number of extra ranges, each one is a start and end codepoint
+// followed by the widths of each glyph in that range. Glyphs are laid out in the atlas in the same order they appear.
+//
+//   font.png
+//   <cell w> <cell h>
+//   <128 ascii widths...>
+//   <start> <end> <widths...>
+//
+// All of the numbers are in hexadecimal.
+
+struct BitmapGlyphLayout
+{
+    nkS32 x,y;
+    nkS32 cell_w,cell_h;
+    nkS32 atlas_w,atlas_h;
 };
 
+INTERNAL BitmapGlyph read_bitmap_glyph(nkChar** ptr, BitmapGlyphLayout* layout)
+{
+    str_eat_space(ptr);
+
+    nkS32 w = str_get_s32(ptr, 16);
+
+    nkF32 tw = NK_CAST(nkF32, layout->atlas_w);
+    nkF32 th = NK_CAST(nkF32, layout->atlas_h);
+
+    BitmapGlyph glyph;
+
+    glyph.clip.x = NK_CAST(nkF32, layout->x);
+    glyph.clip.y = NK_CAST(nkF32, layout->y);
+    glyph.clip.w = NK_CAST(nkF32, w);
+    glyph.clip.h = NK_CAST(nkF32, layout->cell_h);
+
+    glyph.s1 = (glyph.clip.x               ) / tw;
+    glyph.t1 = (glyph.clip.y               ) / th;
+    glyph.s2 = (glyph.clip.x + glyph.clip.w) / tw;
+    glyph.t2 = (glyph.clip.y + glyph.clip.h) / th;
+
+    layout->x += layout->cell_w;
+
+    if(layout->x >= layout->atlas_w)
+    {
+        layout->x = 0;
+        layout->y += layout->cell_h;
+    }
+
+    return glyph;
+}
+
 GLOBAL BitmapFont create_bitmap_font(void* data, nkU64 bytes)
 {
     BitmapFont font = ALLOCATE_PRIVATE_TYPE(BitmapFont);
@@ -33,27 +91,35 @@ GLOBAL BitmapFont create_bitmap_font(void* data, nkU64 bytes)
     font->px_height = NK_CAST(nkF32, gh);
 
     // Build the glyph map.
-    nkS32 x = 0;
-    nkS32 y = 0;
+    BitmapGlyphLayout layout = NK_ZERO_MEM;
+    layout.cell_w = gw;
+    layout.cell_h = gh;
+    layout.atlas_w = get_texture_width(font->atlas);
+    layout.atlas_h = get_texture_height(font->atlas);
 
-    nkS32 tw = get_texture_width(font->atlas);
-    for(nkS32 i=0; i<NK_ARRAY_SIZE(font->glyphs); ++i)
+    for(nkS32 i=0; i<NK_ARRAY_SIZE(font->ascii); ++i)
     {
-        str_eat_space(&ptr);
-
-        nkS32 w = str_get_s32(&ptr, 16);
+        font->ascii[i] = read_bitmap_glyph(&ptr, &layout);
+    }
 
-        font->glyphs[i].x = NK_CAST(nkF32, x);
-        font->glyphs[i].y = NK_CAST(nkF32, y);
-        font->glyphs[i].w = NK_CAST(nkF32, w);
-        font->glyphs[i].h = NK_CAST(nkF32,gh);
+    // Load any extra ranges.
+    while(*str_eat_space(&ptr) != '\0')
+    {
+        nkU32 start = NK_CAST(nkU32, str_get_s32(&ptr, 16));
+        nkU32 end   = NK_CAST(nkU32, str_get_s32(&ptr, 16));
 
-        x += gw;
+        if(start < NK_ARRAY_SIZE(font->ascii) || end < start)
+        {
+            fatal_error("Invalid bitmap font glyph range: %X-%X", start, end);
+        }
 
-        if(x >= tw)
+        for(nkU32 codepoint=start; codepoint<=end; ++codepoint)
         {
-            x = 0;
-            y += gh;
+            BitmapGlyph glyph = read_bitmap_glyph(&ptr, &layout);
+            if(!nk_hashmap_contains(&font->extended, codepoint))
+            {
+                nk_hashmap_insert(&font->extended, codepoint, glyph);
+            }
         }
     }
 
@@ -65,30 +131,73 @@ GLOBAL BitmapFont create_bitmap_font(void* data, nkU64 bytes)
 GLOBAL void free_bitmap_font(BitmapFont font)
 {
     NK_ASSERT(font);
+    nk_hashmap_free(&font->extended);
     NK_FREE(font);
 }
 
-GLOBAL nkVec2 get_bitmap_text_bounds(BitmapFont font, const nkChar* text)
+// Anything not in the ASCII range or one of the font's extra ranges is treated as an empty glyph.
+INTERNAL const BitmapGlyph* get_bitmap_glyph(BitmapFont font, nkU32 codepoint)
+{
+    if(codepoint < NK_ARRAY_SIZE(font->ascii)) return &font->ascii[codepoint];
+    return nk_hashmap_getptr(&font->extended, codepoint);
+}
+
+// Measuring and drawing share the same pass, when drawing the bounds are worked out for free as the glyphs are emitted.
+// The whole string gets emitted as one batch of triangles so it only ever costs a single draw.
+INTERNAL nkVec2 process_bitmap_text(BitmapFont font, nkF32 x, nkF32 y, const nkChar* text, nkVec4 color, nkBool draw)
 {
     NK_ASSERT(font);
 
+    nkF32 start_x = x;
+
     nkF32 line_w = 0.0f;
 
     nkF32 w = 0.0f;
     nkF32 h = font->px_height;
 
-    for(nkU64 i=0,n=strlen(text); i<n; ++i)
+    TextIterator iter = text_iterator_begin(text);
+    nkU32 c;
+
+    if(draw) imm_begin_texture_batch(font->atlas);
+    while(text_iterator_next(&iter, &c))
     {
-        nkChar c = text[i];
-        if(c != '\n')
-            line_w += font->glyphs[NK_CAST(nkS32, c)].w;
-        else
+        if(c == '\n')
         {
             w = nk_max(w,line_w);
             line_w = 0.0f;
             h += font->px_height;
+
+            x = start_x;
+            y += font->px_height;
+        }
+        else
+        {
+            const BitmapGlyph* glyph = get_bitmap_glyph(font, c);
+            if(glyph)
+            {
+                line_w += glyph->clip.w;
+
+                if(draw)
+                {
+                    // Glyphs are drawn centered on their position, the same as imm_texture_batched.
+                    nkF32 x1 = x;
+                    nkF32 y1 = y - (glyph->clip.h * 0.5f);
+                    nkF32 x2 = x1 + glyph->clip.w;
+                    nkF32 y2 = y1 + glyph->clip.h;
+
+                    imm_position(x1,y2); imm_texcoord(glyph->s1,glyph->t2); imm_color(color.x,color.y,color.z,color.w); // BL
+                    imm_position(x1,y1); imm_texcoord(glyph->s1,glyph->t1); imm_color(color.x,color.y,color.z,color.w); // TL
+                    imm_position(x2,y1); imm_texcoord(glyph->s2,glyph->t1); imm_color(color.x,color.y,color.z,color.w); // TR
+                    imm_position(x2,y1); imm_texcoord(glyph->s2,glyph->t1); imm_color(color.x,color.y,color.z,color.w); // TR
+                    imm_position(x2,y2); imm_texcoord(glyph->s2,glyph->t2); imm_color(color.x,color.y,color.z,color.w); // BR
+                    imm_position(x1,y2); imm_texcoord(glyph->s1,glyph->t2); imm_color(color.x,color.y,color.z,color.w); // BL
+                }
+
+                x += glyph->clip.w;
+            }
         }
     }
+    if(draw) imm_end_texture_batch();
 
     w = nk_max(w,line_w);
 
@@ -98,6 +207,12 @@ GLOBAL nkVec2 get_bitmap_text_bounds(BitmapFont font, const nkChar* text)
     return bounds;
 }
 
+GLOBAL nkVec2 get_bitmap_text_bounds(BitmapFont font, const nkChar* text)
+{
+    NK_ASSERT(font);
+    return process_bitmap_text(font, 0.0f,0.0f, text, NK_V4_WHITE, NK_FALSE);
+}
+
 GLOBAL nkF32 get_bitmap_text_width(BitmapFont font, const nkChar* text)
 {
     NK_ASSERT(font);
@@ -116,37 +231,20 @@ GLOBAL nkF32 get_bitmap_font_px_height(BitmapFont font)
     return font->px_height;
 }
 
-GLOBAL void draw_bitmap_text(BitmapFont font, nkF32 x, nkF32 y, const nkChar* text, nkVec4 color)
+GLOBAL nkVec2 draw_bitmap_text(BitmapFont font, nkF32 x, nkF32 y, const nkChar* text, nkVec4 color)
 {
     NK_ASSERT(font);
     NK_ASSERT(text);
 
-    nkF32 start_x = x;
-
-    if(strlen(text) == 0)
+    if(*text == '\0')
     {
-        return;
+        nkVec2 bounds;
+        bounds.x = 0.0f;
+        bounds.y = font->px_height;
+        return bounds;
     }
 
-    imm_begin_texture_batch(font->atlas);
-    while(*text)
-    {
-        if(*text == '\n')
-        {
-            x = start_x;
-            y += font->px_height;
-        }
-        else
-        {
-            ImmClip* clip = &font->glyphs[NK_CAST(nkS32, *text)];
-            x += clip->w * 0.5f;
-            imm_texture_batched(x,y, clip, color);
-            x += clip->w * 0.5f;
-        }
-
-        ++text;
-    }
-    imm_end_texture_batch();
+    return process_bitmap_text(font, x,y, text, color, NK_TRUE);
 }
 
 GLOBAL void draw_bitmap_char(BitmapFont font, nkF32 x, nkF32 y, nkChar chr, nkVec4 color)
@@ -0,0 +1,1002 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+INTERNAL constexpr nkS32 BROADPHASE_NULL = -1;
+
+// Bounds are stored as separate arrays of each component rather than an array of rects, so scanning through them for
+// overlap tests only pulls the bounds into the cache and not all of the other data that goes with them.
+struct BroadphaseBounds
+{
+    nkArray<nkF32> min_x;
+    nkArray<nkF32> min_y;
+    nkArray<nkF32> max_x;
+    nkArray<nkF32> max_y;
+};
+
+struct BroadphaseBox
+{
+    nkF32 min_x;
+    nkF32 min_y;
+    nkF32 max_x;
+    nkF32 max_y;
+};
+
+struct BroadphaseProxyData
+{
+    void*  user_data;
+    nkS32  next_free;
+    nkBool alive;
+    nkU32  query_stamp; // Used to avoid returning the same proxy twice from one query.
+    nkS32  leaf;        // Tree only.
+    nkS32  cell_x0;     // Grid only, the range of cells the proxy covers.
+    nkS32  cell_y0;
+    nkS32  cell_x1;
+    nkS32  cell_y1;
+};
+
+// Each cell a proxy covers gets an entry in the list of the bucket the cell hashes to. Different cells can end up in
+// the same bucket so the cell is stored as well, letting the entries for other cells be skipped without a bounds test.
+struct GridEntry
+{
+    nkS32 proxy;
+    nkS32 cell_x;
+    nkS32 cell_y;
+    nkS32 next;
+};
+
+// Unlike the proxies the node bounds are kept with the rest of the node, walking the tree jumps around between nodes
+// and each step needs both the bounds and the children so keeping them together means only one cache line per step.
+struct TreeNode
+{
+    BroadphaseBox box;    // Fattened by the margin for leaves.
+    nkS32         parent; // Next free node when the node isn't in use.
+    nkS32         child1;
+    nkS32         child2;
+    nkS32         height; // Leaves are zero.
+    nkS32         proxy;
+};
+
+DEFINE_PRIVATE_TYPE(Broadphase)
+{
+    BroadphaseType               type;
+    BroadphaseBounds             bounds; // The actual bounds of each proxy.
+    nkArray<BroadphaseProxyData> proxies;
+    nkS32                        free_proxy;
+    nkS32                        proxy_count;
+    nkU32                        query_stamp;
+
+    // Grid.
+    nkF32                        inv_cell_size;
+    nkU32                        bucket_mask;
+    nkArray<nkS32>               buckets;
+    nkArray<GridEntry>           entries;
+    nkS32                        free_entry;
+
+    // Tree.
+    nkArray<TreeNode>            nodes;
+    nkS32                        root;
+    nkS32                        free_node;
+    nkF32                        margin;
+    nkArray<nkS32>               stack; // Kept big enough to walk the whole tree so queries never have to grow it.
+};
+
+// Helpers =====================================================================
+INTERNAL void append_broadphase_bounds(BroadphaseBounds* bounds, const BroadphaseBox& box)
+{
+    nk_array_append(&bounds->min_x, box.min_x);
+    nk_array_append(&bounds->min_y, box.min_y);
+    nk_array_append(&bounds->max_x, box.max_x);
+    nk_array_append(&bounds->max_y, box.max_y);
+}
+
+INTERNAL void reserve_broadphase_bounds(BroadphaseBounds* bounds, nkU64 count)
+{
+    nk_array_reserve(&bounds->min_x, count);
+    nk_array_reserve(&bounds->min_y, count);
+    nk_array_reserve(&bounds->max_x, count);
+    nk_array_reserve(&bounds->max_y, count);
+}
+
+INTERNAL void free_broadphase_bounds(BroadphaseBounds* bounds)
+{
+    nk_array_free(&bounds->min_x);
+    nk_array_free(&bounds->min_y);
+    nk_array_free(&bounds->max_x);
+    nk_array_free(&bounds->max_y);
+}
+
+INTERNAL NKFORCEINLINE void set_broadphase_box(BroadphaseBounds* bounds, nkS32 index, const BroadphaseBox& box)
+{
+    bounds->min_x.data[index] = box.min_x;
+    bounds->min_y.data[index] = box.min_y;
+    bounds->max_x.data[index] = box.max_x;
+    bounds->max_y.data[index] = box.max_y;
+}
+
+INTERNAL NKFORCEINLINE BroadphaseBox get_broadphase_box(const BroadphaseBounds* bounds, nkS32 index)
+{
+    return { bounds->min_x.data[index], bounds->min_y.data[index], bounds->max_x.data[index], bounds->max_y.data[index] };
+}
+
+// Same test as rect_vs_rect, touching edges don't count as overlapping.
+INTERNAL NKFORCEINLINE nkBool broadphase_boxes_overlap(const BroadphaseBox& a, const BroadphaseBox& b)
+{
+    return ((a.min_x < b.max_x) && (a.max_x > b.min_x) && (a.min_y < b.max_y) && (a.max_y > b.min_y));
+}
+
+INTERNAL NKFORCEINLINE nkBool broadphase_box_overlap(const BroadphaseBounds* bounds, nkS32 index, const BroadphaseBox& box)
+{
+    return ((bounds->min_x.data[index] < box.max_x) && (bounds->max_x.data[index] > box.min_x) &&
+            (bounds->min_y.data[index] < box.max_y) && (bounds->max_y.data[index] > box.min_y));
+}
+
+INTERNAL NKFORCEINLINE BroadphaseBox rect_to_broadphase_box(const fRect& rect)
+{
+    return { rect.x, rect.y, rect.x + rect.w, rect.y + rect.h };
+}
+
+INTERNAL NKFORCEINLINE fRect broadphase_box_to_rect(const BroadphaseBox& box)
+{
+    return { box.min_x, box.min_y, box.max_x - box.min_x, box.max_y - box.min_y };
+}
+
+INTERNAL NKFORCEINLINE BroadphaseBox broadphase_box_union(const BroadphaseBox& a, const BroadphaseBox& b)
+{
+    return { nk_min(a.min_x, b.min_x), nk_min(a.min_y, b.min_y), nk_max(a.max_x, b.max_x), nk_max(a.max_y, b.max_y) };
+}
+
+// The 2D equivalent of surface area, used as the cost when picking where to insert into the tree.
+INTERNAL NKFORCEINLINE nkF32 broadphase_box_perimeter(const BroadphaseBox& box)
+{
+    return 2.0f * ((box.max_x - box.min_x) + (box.max_y - box.min_y));
+}
+
+INTERNAL NKFORCEINLINE nkBool broadphase_box_contains(const BroadphaseBox& outer, const BroadphaseBox& inner)
+{
+    return ((outer.min_x <= inner.min_x) && (outer.min_y <= inner.min_y) && (outer.max_x >= inner.max_x) && (outer.max_y >= inner.max_y));
+}
+
+// Clips the range [t0,t1] of the ray to the part inside the slab between lo and hi on one axis.
+INTERNAL NKFORCEINLINE nkBool clip_ray_to_slab(nkF32 origin, nkF32 dir, nkF32 lo, nkF32 hi, nkF32* t0, nkF32* t1)
+{
+    if(dir == 0.0f) return ((origin >= lo) && (origin <= hi));
+
+    nkF32 inv = 1.0f / dir;
+    nkF32 a = (lo - origin) * inv;
+    nkF32 b = (hi - origin) * inv;
+    if(a > b) { nkF32 tmp = a; a = b; b = tmp; }
+
+    *t0 = nk_max(*t0, a);
+    *t1 = nk_min(*t1, b);
+
+    return (*t0 <= *t1);
+}
+
+INTERNAL NKFORCEINLINE nkBool ray_vs_broadphase_box(const fLine& ray, const BroadphaseBox& box, nkF32* t)
+{
+    nkF32 t0 = 0.0f;
+    nkF32 t1 = 1.0f;
+    if(!clip_ray_to_slab(ray.x1, ray.x2 - ray.x1, box.min_x, box.max_x, &t0, &t1)) return NK_FALSE;
+    if(!clip_ray_to_slab(ray.y1, ray.y2 - ray.y1, box.min_y, box.max_y, &t0, &t1)) return NK_FALSE;
+    *t = t0;
+    return NK_TRUE;
+}
+
+// Starts a new query, returns the stamp to mark visited proxies with.
+INTERNAL nkU32 begin_broadphase_query(Broadphase broadphase)
+{
+    if(++broadphase->query_stamp == 0)
+    {
+        for(auto& proxy: broadphase->proxies)
+            proxy.query_stamp = 0;
+        broadphase->query_stamp = 1;
+    }
+    return broadphase->query_stamp;
+}
+// =============================================================================
+
+// Grid ========================================================================
+INTERNAL NKFORCEINLINE nkS32 get_grid_cell(Broadphase broadphase, nkF32 x)
+{
+    return NK_CAST(nkS32, floorf(x * broadphase->inv_cell_size));
+}
+
+INTERNAL NKFORCEINLINE nkU32 get_grid_bucket(Broadphase broadphase, nkS32 cell_x, nkS32 cell_y)
+{
+    return (((NK_CAST(nkU32, cell_x) * 73856093u) ^ (NK_CAST(nkU32, cell_y) * 19349663u)) & broadphase->bucket_mask);
+}
+
+INTERNAL void insert_grid_cells(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    BroadphaseProxyData& data = broadphase->proxies.data[proxy];
+    BroadphaseBox box = get_broadphase_box(&broadphase->bounds, proxy);
+
+    data.cell_x0 = get_grid_cell(broadphase, box.min_x);
+    data.cell_y0 = get_grid_cell(broadphase, box.min_y);
+    data.cell_x1 = get_grid_cell(broadphase, box.max_x);
+    data.cell_y1 = get_grid_cell(broadphase, box.max_y);
+
+    for(nkS32 cy=data.cell_y0; cy<=data.cell_y1; ++cy)
+    {
+        for(nkS32 cx=data.cell_x0; cx<=data.cell_x1; ++cx)
+        {
+            nkS32 entry = broadphase->free_entry;
+            if(entry != BROADPHASE_NULL)
+            {
+                broadphase->free_entry = broadphase->entries.data[entry].next;
+            }
+            else
+            {
+                entry = NK_CAST(nkS32, broadphase->entries.length);
+                nk_array_append(&broadphase->entries, GridEntry());
+            }
+
+            nkU32 bucket = get_grid_bucket(broadphase, cx, cy);
+
+            GridEntry& e = broadphase->entries.data[entry];
+            e.proxy  = proxy;
+            e.cell_x = cx;
+            e.cell_y = cy;
+            e.next   = broadphase->buckets.data[bucket];
+
+            broadphase->buckets.data[bucket] = entry;
+        }
+    }
+}
+
+INTERNAL void remove_grid_cells(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    const BroadphaseProxyData& data = broadphase->proxies.data[proxy];
+
+    for(nkS32 cy=data.cell_y0; cy<=data.cell_y1; ++cy)
+    {
+        for(nkS32 cx=data.cell_x0; cx<=data.cell_x1; ++cx)
+        {
+            nkS32* link = &broadphase->buckets.data[get_grid_bucket(broadphase, cx, cy)];
+            while(*link != BROADPHASE_NULL)
+            {
+                GridEntry& e = broadphase->entries.data[*link];
+                if(e.proxy == proxy && e.cell_x == cx && e.cell_y == cy)
+                {
+                    nkS32 entry = *link;
+                    *link = e.next;
+                    e.next = broadphase->free_entry;
+                    broadphase->free_entry = entry;
+                    break;
+                }
+                link = &e.next;
+            }
+        }
+    }
+}
+
+// Returns false once the output is full.
+INTERNAL NKFORCEINLINE nkBool query_grid_bucket(Broadphase broadphase, nkU32 bucket, nkS32 cell_x, nkS32 cell_y, nkBool any_cell,
+    const BroadphaseBox& box, const fCircle* circle, nkU32 stamp, BroadphaseProxy* out, nkS32 max_out, nkS32* count)
+{
+    for(nkS32 entry=broadphase->buckets.data[bucket]; entry!=BROADPHASE_NULL; entry=broadphase->entries.data[entry].next)
+    {
+        const GridEntry& e = broadphase->entries.data[entry];
+        if(!any_cell && (e.cell_x != cell_x || e.cell_y != cell_y)) continue;
+
+        BroadphaseProxyData& data = broadphase->proxies.data[e.proxy];
+        if(data.query_stamp == stamp) continue;
+        data.query_stamp = stamp;
+
+        if(!broadphase_box_overlap(&broadphase->bounds, e.proxy, box)) continue;
+        if(circle && !circle_vs_rect(*circle, broadphase_box_to_rect(get_broadphase_box(&broadphase->bounds, e.proxy)))) continue;
+
+        if(*count >= max_out) return NK_FALSE;
+        out[(*count)++] = e.proxy;
+    }
+    return NK_TRUE;
+}
+
+INTERNAL nkS32 query_grid(Broadphase broadphase, const BroadphaseBox& box, const fCircle* circle, BroadphaseProxy* out, nkS32 max_out)
+{
+    nkU32 stamp = begin_broadphase_query(broadphase);
+    nkS32 count = 0;
+
+    nkS32 x0 = get_grid_cell(broadphase, box.min_x);
+    nkS32 y0 = get_grid_cell(broadphase, box.min_y);
+    nkS32 x1 = get_grid_cell(broadphase, box.max_x);
+    nkS32 y1 = get_grid_cell(broadphase, box.max_y);
+
+    // If the region covers more cells than there are buckets it's quicker to just go through every bucket once.
+    nkF32 cell_count = (NK_CAST(nkF32, x1) - x0 + 1.0f) * (NK_CAST(nkF32, y1) - y0 + 1.0f);
+    if(cell_count > NK_CAST(nkF32, broadphase->buckets.length))
+    {
+        for(nkU32 bucket=0; bucket<broadphase->buckets.length; ++bucket)
+            if(!query_grid_bucket(broadphase, bucket, 0, 0, NK_TRUE, box, circle, stamp, out, max_out, &count))
+                return count;
+        return count;
+    }
+
+    for(nkS32 cy=y0; cy<=y1; ++cy)
+        for(nkS32 cx=x0; cx<=x1; ++cx)
+            if(!query_grid_bucket(broadphase, get_grid_bucket(broadphase, cx, cy), cx, cy, NK_FALSE, box, circle, stamp, out, max_out, &count))
+                return count;
+
+    return count;
+}
+
+// Walks the cells the ray passes through in order (Amanatides and Woo).
+INTERNAL nkS32 ray_cast_grid(Broadphase broadphase, const fLine& ray, BroadphaseRayHit* out, nkS32 max_out)
+{
+    nkU32 stamp = begin_broadphase_query(broadphase);
+    nkS32 count = 0;
+
+    nkF32 dx = ray.x2 - ray.x1;
+    nkF32 dy = ray.y2 - ray.y1;
+
+    nkS32 cx = get_grid_cell(broadphase, ray.x1);
+    nkS32 cy = get_grid_cell(broadphase, ray.y1);
+    nkS32 end_x = get_grid_cell(broadphase, ray.x2);
+    nkS32 end_y = get_grid_cell(broadphase, ray.y2);
+
+    nkS32 step_x = (dx > 0.0f) ? 1 : -1;
+    nkS32 step_y = (dy > 0.0f) ? 1 : -1;
+
+    nkF32 cell_size = 1.0f / broadphase->inv_cell_size;
+
+    // How far along the ray the next cell boundary on each axis is, and how far it is between boundaries.
+    nkF32 next_x = FLT_MAX;
+    nkF32 next_y = FLT_MAX;
+    nkF32 delta_x = FLT_MAX;
+    nkF32 delta_y = FLT_MAX;
+    if(dx != 0.0f)
+    {
+        nkF32 boundary = NK_CAST(nkF32, cx + ((step_x > 0) ? 1 : 0)) * cell_size;
+        next_x = (boundary - ray.x1) / dx;
+        delta_x = cell_size / fabsf(dx);
+    }
+    if(dy != 0.0f)
+    {
+        nkF32 boundary = NK_CAST(nkF32, cy + ((step_y > 0) ? 1 : 0)) * cell_size;
+        next_y = (boundary - ray.y1) / dy;
+        delta_y = cell_size / fabsf(dy);
+    }
+
+    // Limit the walk to the number of cells between the ends in case rounding makes it miss the end cell.
+    nkS32 remaining = abs(end_x - cx) + abs(end_y - cy) + 1;
+
+    while(remaining-- > 0)
+    {
+        nkU32 bucket = get_grid_bucket(broadphase, cx, cy);
+        for(nkS32 entry=broadphase->buckets.data[bucket]; entry!=BROADPHASE_NULL; entry=broadphase->entries.data[entry].next)
+        {
+            const GridEntry& e = broadphase->entries.data[entry];
+            if(e.cell_x != cx || e.cell_y != cy) continue;
+
+            BroadphaseProxyData& data = broadphase->proxies.data[e.proxy];
+            if(data.query_stamp == stamp) continue;
+            data.query_stamp = stamp;
+
+            nkF32 t;
+            if(!ray_vs_broadphase_box(ray, get_broadphase_box(&broadphase->bounds, e.proxy), &t)) continue;
+
+            if(count >= max_out) return count;
+            out[count].proxy = e.proxy;
+            out[count].t = t;
+            count++;
+        }
+
+        if(next_x < next_y)
+        {
+            if(next_x > 1.0f) break;
+            cx += step_x;
+            next_x += delta_x;
+        }
+        else
+        {
+            if(next_y > 1.0f) break;
+            cy += step_y;
+            next_y += delta_y;
+        }
+    }
+
+    return count;
+}
+
+INTERNAL nkS32 find_grid_pairs(Broadphase broadphase, BroadphasePair* out, nkS32 max_out)
+{
+    nkS32 count = 0;
+
+    for(nkU32 bucket=0; bucket<broadphase->buckets.length; ++bucket)
+    {
+        for(nkS32 i=broadphase->buckets.data[bucket]; i!=BROADPHASE_NULL; i=broadphase->entries.data[i].next)
+        {
+            const GridEntry& a = broadphase->entries.data[i];
+            BroadphaseBox box = get_broadphase_box(&broadphase->bounds, a.proxy);
+
+            for(nkS32 j=a.next; j!=BROADPHASE_NULL; j=broadphase->entries.data[j].next)
+            {
+                const GridEntry& b = broadphase->entries.data[j];
+                if(b.cell_x != a.cell_x || b.cell_y != a.cell_y) continue;
+                if(!broadphase_box_overlap(&broadphase->bounds, b.proxy, box)) continue;
+
+                // Proxies that overlap share more than one cell when their overlap spans a cell boundary, only report
+                // the pair from the cell holding the top-left corner of the overlap so it's only reported once.
+                nkF32 corner_x = nk_max(box.min_x, broadphase->bounds.min_x.data[b.proxy]);
+                nkF32 corner_y = nk_max(box.min_y, broadphase->bounds.min_y.data[b.proxy]);
+                if(get_grid_cell(broadphase, corner_x) != a.cell_x || get_grid_cell(broadphase, corner_y) != a.cell_y) continue;
+
+                if(count >= max_out) return count;
+                out[count].a = nk_min(a.proxy, b.proxy);
+                out[count].b = nk_max(a.proxy, b.proxy);
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+// =============================================================================
+
+// Tree ========================================================================
+//
+// This is the same approach as the dynamic tree in Box2D. Leaves are inserted next to whichever node gives the lowest
+// increase in total perimeter and the tree is kept balanced using rotations as it's walked back up after each change.
+//
+INTERNAL NKFORCEINLINE nkBool is_tree_leaf(Broadphase broadphase, nkS32 node)
+{
+    return (broadphase->nodes.data[node].child1 == BROADPHASE_NULL);
+}
+
+// Finding pairs keeps two entries per item on the stack and can hold a few per level of the tree, so this leaves plenty
+// of room over the node count (which is always more than the height) with some extra for when the tree is tiny.
+INTERNAL NKFORCEINLINE nkU64 get_tree_stack_size(nkU64 node_count)
+{
+    return (node_count * 4) + 64;
+}
+
+INTERNAL nkS32 allocate_tree_node(Broadphase broadphase)
+{
+    nkS32 node = broadphase->free_node;
+    if(node != BROADPHASE_NULL)
+    {
+        broadphase->free_node = broadphase->nodes.data[node].parent;
+    }
+    else
+    {
+        node = NK_CAST(nkS32, broadphase->nodes.length);
+        nk_array_append(&broadphase->nodes, TreeNode());
+        nk_array_reserve(&broadphase->stack, get_tree_stack_size(broadphase->nodes.length));
+    }
+
+    TreeNode& n = broadphase->nodes.data[node];
+    n.parent = BROADPHASE_NULL;
+    n.child1 = BROADPHASE_NULL;
+    n.child2 = BROADPHASE_NULL;
+    n.height = 0;
+    n.proxy  = BROADPHASE_NULL;
+
+    return node;
+}
+
+INTERNAL void free_tree_node(Broadphase broadphase, nkS32 node)
+{
+    broadphase->nodes.data[node].parent = broadphase->free_node;
+    broadphase->nodes.data[node].height = -1;
+    broadphase->free_node = node;
+}
+
+INTERNAL void refit_tree_node(Broadphase broadphase, nkS32 node)
+{
+    TreeNode& n = broadphase->nodes.data[node];
+    n.height = 1 + nk_max(broadphase->nodes.data[n.child1].height, broadphase->nodes.data[n.child2].height);
+    n.box = broadphase_box_union(broadphase->nodes.data[n.child1].box, broadphase->nodes.data[n.child2].box);
+}
+
+// If one side of the node is more than one level taller than the other then the taller child gets rotated up to take
+// its place. Returns the node that is now at the original node's position.
+INTERNAL nkS32 balance_tree_node(Broadphase broadphase, nkS32 a)
+{
+    TreeNode* nodes = broadphase->nodes.data;
+
+    if(is_tree_leaf(broadphase, a) || nodes[a].height < 2) return a;
+
+    nkS32 b = nodes[a].child1;
+    nkS32 c = nodes[a].child2;
+
+    nkS32 balance = nodes[c].height - nodes[b].height;
+    if(balance >= -1 && balance <= 1) return a;
+
+    // The child being rotated up (up) and the one staying below the original node (other).
+    nkS32 up    = (balance > 1) ? c : b;
+    nkS32 other = (balance > 1) ? b : c;
+
+    nkS32 f = nodes[up].child1;
+    nkS32 g = nodes[up].child2;
+
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+
+    if(nodes[up].parent != BROADPHASE_NULL)
+    {
+        TreeNode& parent = nodes[nodes[up].parent];
+        if(parent.child1 == a) parent.child1 = up;
+        else                   parent.child2 = up;
+    }
+    else
+    {
+        broadphase->root = up;
+    }
+
+    // The taller grandchild stays under the rotated node and the shorter one moves over to the original node.
+    nkS32 keep = (nodes[f].height > nodes[g].height) ? f : g;
+    nkS32 move = (nodes[f].height > nodes[g].height) ? g : f;
+
+    nodes[up].child2 = keep;
+    if(balance > 1) { nodes[a].child1 = other; nodes[a].child2 = move; }
+    else            { nodes[a].child1 = move; nodes[a].child2 = other; }
+    nodes[move].parent = a;
+
+    refit_tree_node(broadphase, a);
+    refit_tree_node(broadphase, up);
+
+    return up;
+}
+
+// Walks up from the node refitting bounds and rebalancing along the way.
+INTERNAL void refit_tree_ancestors(Broadphase broadphase, nkS32 node)
+{
+    while(node != BROADPHASE_NULL)
+    {
+        node = balance_tree_node(broadphase, node);
+        refit_tree_node(broadphase, node);
+        node = broadphase->nodes.data[node].parent;
+    }
+}
+
+INTERNAL void insert_tree_leaf(Broadphase broadphase, nkS32 leaf)
+{
+    if(broadphase->root == BROADPHASE_NULL)
+    {
+        broadphase->root = leaf;
+        broadphase->nodes.data[leaf].parent = BROADPHASE_NULL;
+        return;
+    }
+
+    BroadphaseBox leaf_box = broadphase->nodes.data[leaf].box;
+
+    // Find the best sibling by walking down, at each step the cost of pairing with this node is compared against the
+    // lowest possible cost of going down into either of the children.
+    nkS32 index = broadphase->root;
+    while(!is_tree_leaf(broadphase, index))
+    {
+        const TreeNode& node = broadphase->nodes.data[index];
+
+        BroadphaseBox box = broadphase->nodes.data[index].box;
+        nkF32 perimeter = broadphase_box_perimeter(box);
+        nkF32 combined = broadphase_box_perimeter(broadphase_box_union(box, leaf_box));
+
+        nkF32 cost = 2.0f * combined; // Cost of creating a new parent for this node and the leaf.
+        nkF32 inheritance = 2.0f * (combined - perimeter); // Minimum cost of pushing the leaf further down.
+
+        nkF32 child_cost[2];
+        nkS32 children[2] = { node.child1, node.child2 };
+        for(nkS32 i=0; i<2; ++i)
+        {
+            BroadphaseBox child_box = broadphase->nodes.data[children[i]].box;
+            nkF32 child_combined = broadphase_box_perimeter(broadphase_box_union(child_box, leaf_box));
+            if(is_tree_leaf(broadphase, children[i])) child_cost[i] = child_combined + inheritance;
+            else child_cost[i] = (child_combined - broadphase_box_perimeter(child_box)) + inheritance;
+        }
+
+        if(cost < child_cost[0] && cost < child_cost[1]) break;
+
+        index = (child_cost[0] < child_cost[1]) ? children[0] : children[1];
+    }
+
+    nkS32 sibling = index;
+    nkS32 new_parent = allocate_tree_node(broadphase); // May move the node data, so nothing is held across this.
+    nkS32 old_parent = broadphase->nodes.data[sibling].parent;
+
+    TreeNode& parent = broadphase->nodes.data[new_parent];
+    parent.parent = old_parent;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+
+    if(old_parent != BROADPHASE_NULL)
+    {
+        TreeNode& grandparent = broadphase->nodes.data[old_parent];
+        if(grandparent.child1 == sibling) grandparent.child1 = new_parent;
+        else                              grandparent.child2 = new_parent;
+    }
+    else
+    {
+        broadphase->root = new_parent;
+    }
+
+    broadphase->nodes.data[sibling].parent = new_parent;
+    broadphase->nodes.data[leaf].parent = new_parent;
+
+    refit_tree_ancestors(broadphase, new_parent);
+}
+
+INTERNAL void remove_tree_leaf(Broadphase broadphase, nkS32 leaf)
+{
+    if(leaf == broadphase->root)
+    {
+        broadphase->root = BROADPHASE_NULL;
+        return;
+    }
+
+    TreeNode* nodes = broadphase->nodes.data;
+
+    nkS32 parent = nodes[leaf].parent;
+    nkS32 grandparent = nodes[parent].parent;
+    nkS32 sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    // The sibling takes the place of the parent.
+    nodes[sibling].parent = grandparent;
+    free_tree_node(broadphase, parent);
+
+    if(grandparent != BROADPHASE_NULL)
+    {
+        if(nodes[grandparent].child1 == parent) nodes[grandparent].child1 = sibling;
+        else                                    nodes[grandparent].child2 = sibling;
+        refit_tree_ancestors(broadphase, grandparent);
+    }
+    else
+    {
+        broadphase->root = sibling;
+    }
+}
+
+INTERNAL void set_tree_leaf_bounds(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    BroadphaseBox box = get_broadphase_box(&broadphase->bounds, proxy);
+    box.min_x -= broadphase->margin;
+    box.min_y -= broadphase->margin;
+    box.max_x += broadphase->margin;
+    box.max_y += broadphase->margin;
+    broadphase->nodes.data[broadphase->proxies.data[proxy].leaf].box = box;
+}
+
+INTERNAL nkS32 query_tree(Broadphase broadphase, const BroadphaseBox& box, const fCircle* circle, BroadphaseProxy* out, nkS32 max_out)
+{
+    if(broadphase->root == BROADPHASE_NULL) return 0;
+
+    nkS32* stack = broadphase->stack.data;
+    nkS32 top = 0;
+    nkS32 count = 0;
+
+    stack[top++] = broadphase->root;
+    while(top > 0)
+    {
+        const TreeNode& n = broadphase->nodes.data[stack[--top]];
+        if(!broadphase_boxes_overlap(n.box, box)) continue;
+
+        if(n.child1 == BROADPHASE_NULL)
+        {
+            if(!broadphase_box_overlap(&broadphase->bounds, n.proxy, box)) continue;
+            if(circle && !circle_vs_rect(*circle, broadphase_box_to_rect(get_broadphase_box(&broadphase->bounds, n.proxy)))) continue;
+            if(count >= max_out) break;
+            out[count++] = n.proxy;
+        }
+        else
+        {
+            stack[top++] = n.child1;
+            stack[top++] = n.child2;
+        }
+    }
+
+    return count;
+}
+
+INTERNAL nkS32 ray_cast_tree(Broadphase broadphase, const fLine& ray, BroadphaseRayHit* out, nkS32 max_out)
+{
+    if(broadphase->root == BROADPHASE_NULL) return 0;
+
+    nkS32* stack = broadphase->stack.data;
+    nkS32 top = 0;
+    nkS32 count = 0;
+
+    stack[top++] = broadphase->root;
+    while(top > 0)
+    {
+        const TreeNode& n = broadphase->nodes.data[stack[--top]];
+
+        nkF32 t;
+        if(!ray_vs_broadphase_box(ray, n.box, &t)) continue;
+
+        if(n.child1 == BROADPHASE_NULL)
+        {
+            if(!ray_vs_broadphase_box(ray, get_broadphase_box(&broadphase->bounds, n.proxy), &t)) continue;
+            if(count >= max_out) break;
+            out[count].proxy = n.proxy;
+            out[count].t = t;
+            count++;
+        }
+        else
+        {
+            stack[top++] = n.child1;
+            stack[top++] = n.child2;
+        }
+    }
+
+    return count;
+}
+
+// Rather than querying the tree once per proxy the tree is tested against itself. Each entry on the stack is a pair of
+// nodes to find overlaps between (or a single node against itself when both are the same), so whole subtrees that don't
+// overlap each other get skipped in one test.
+INTERNAL nkS32 find_tree_pairs(Broadphase broadphase, BroadphasePair* out, nkS32 max_out)
+{
+    if(broadphase->root == BROADPHASE_NULL) return 0;
+
+    const TreeNode* nodes = broadphase->nodes.data;
+
+    nkS32* stack = broadphase->stack.data;
+    nkS32 top = 0;
+    nkS32 count = 0;
+
+    stack[top++] = broadphase->root;
+    stack[top++] = broadphase->root;
+
+    while(top > 0)
+    {
+        nkS32 b = stack[--top];
+        nkS32 a = stack[--top];
+
+        const TreeNode& na = nodes[a];
+        const TreeNode& nb = nodes[b];
+
+        if(a == b)
+        {
+            if(na.child1 == BROADPHASE_NULL) continue;
+            stack[top++] = na.child1; stack[top++] = na.child1;
+            stack[top++] = na.child2; stack[top++] = na.child2;
+            stack[top++] = na.child1; stack[top++] = na.child2;
+            continue;
+        }
+
+        if(!broadphase_boxes_overlap(na.box, nb.box)) continue;
+
+        nkBool a_leaf = (na.child1 == BROADPHASE_NULL);
+        nkBool b_leaf = (nb.child1 == BROADPHASE_NULL);
+
+        if(a_leaf && b_leaf)
+        {
+            if(!broadphase_box_overlap(&broadphase->bounds, nb.proxy, get_broadphase_box(&broadphase->bounds, na.proxy))) continue;
+            if(count >= max_out) return count;
+            out[count].a = nk_min(na.proxy, nb.proxy);
+            out[count].b = nk_max(na.proxy, nb.proxy);
+            count++;
+        }
+        else if(b_leaf || (!a_leaf && na.height >= nb.height)) // Descend into the taller side.
+        {
+            stack[top++] = na.child1; stack[top++] = b;
+            stack[top++] = na.child2; stack[top++] = b;
+        }
+        else
+        {
+            stack[top++] = a; stack[top++] = nb.child1;
+            stack[top++] = a; stack[top++] = nb.child2;
+        }
+    }
+
+    return count;
+}
+// =============================================================================
+
+// Broadphase ==================================================================
+GLOBAL Broadphase create_broadphase(const BroadphaseDesc& desc)
+{
+    NK_ASSERT(desc.type >= 0 && desc.type < BroadphaseType_TOTAL);
+
+    Broadphase broadphase = ALLOCATE_PRIVATE_TYPE(Broadphase);
+    if(!broadphase)
+        fatal_error("Failed to allocate broadphase!");
+
+    broadphase->type       = desc.type;
+    broadphase->free_proxy = BROADPHASE_NULL;
+
+    nk_array_reserve(&broadphase->proxies, nk_max(desc.capacity, 1));
+    reserve_broadphase_bounds(&broadphase->bounds, nk_max(desc.capacity, 1));
+
+    if(desc.type == BroadphaseType_Grid)
+    {
+        NK_ASSERT(desc.cell_size > 0.0f);
+
+        nkU32 bucket_count = 1;
+        while(bucket_count < NK_CAST(nkU32, nk_max(desc.bucket_count, 1)))
+            bucket_count <<= 1;
+
+        broadphase->inv_cell_size = 1.0f / desc.cell_size;
+        broadphase->bucket_mask   = bucket_count - 1;
+        broadphase->free_entry    = BROADPHASE_NULL;
+
+        for(nkU32 i=0; i<bucket_count; ++i)
+            nk_array_append(&broadphase->buckets, BROADPHASE_NULL);
+        nk_array_reserve(&broadphase->entries, nk_max(desc.capacity, 1) * 4);
+    }
+    else
+    {
+        broadphase->root      = BROADPHASE_NULL;
+        broadphase->free_node = BROADPHASE_NULL;
+        broadphase->margin    = desc.margin;
+
+        nkU64 node_capacity = nk_max(desc.capacity, 1) * 2;
+        nk_array_reserve(&broadphase->nodes, node_capacity);
+        nk_array_reserve(&broadphase->stack, get_tree_stack_size(node_capacity));
+    }
+
+    return broadphase;
+}
+
+GLOBAL void free_broadphase(Broadphase broadphase)
+{
+    if(!broadphase) return;
+
+    free_broadphase_bounds(&broadphase->bounds);
+    nk_array_free(&broadphase->proxies);
+    nk_array_free(&broadphase->buckets);
+    nk_array_free(&broadphase->entries);
+    nk_array_free(&broadphase->nodes);
+    nk_array_free(&broadphase->stack);
+
+    NK_FREE(broadphase);
+}
+
+GLOBAL BroadphaseProxy insert_broadphase_proxy(Broadphase broadphase, const fRect& bounds, void* user_data)
+{
+    NK_ASSERT(broadphase);
+
+    BroadphaseProxy proxy = broadphase->free_proxy;
+    if(proxy != BROADPHASE_NULL)
+    {
+        broadphase->free_proxy = broadphase->proxies.data[proxy].next_free;
+        set_broadphase_box(&broadphase->bounds, proxy, rect_to_broadphase_box(bounds));
+    }
+    else
+    {
+        proxy = NK_CAST(BroadphaseProxy, broadphase->proxies.length);
+        nk_array_append(&broadphase->proxies, BroadphaseProxyData());
+        append_broadphase_bounds(&broadphase->bounds, rect_to_broadphase_box(bounds));
+    }
+
+    BroadphaseProxyData& data = broadphase->proxies.data[proxy];
+    data = BroadphaseProxyData();
+    data.user_data = user_data;
+    data.next_free = BROADPHASE_NULL;
+    data.alive     = NK_TRUE;
+
+    broadphase->proxy_count++;
+
+    if(broadphase->type == BroadphaseType_Grid)
+    {
+        insert_grid_cells(broadphase, proxy);
+    }
+    else
+    {
+        nkS32 leaf = allocate_tree_node(broadphase);
+        broadphase->nodes.data[leaf].proxy = proxy;
+        broadphase->proxies.data[proxy].leaf = leaf;
+        set_tree_leaf_bounds(broadphase, proxy);
+        insert_tree_leaf(broadphase, leaf);
+    }
+
+    return proxy;
+}
+
+GLOBAL void update_broadphase_proxy(Broadphase broadphase, BroadphaseProxy proxy, const fRect& bounds)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(proxy >= 0 && proxy < NK_CAST(BroadphaseProxy, broadphase->proxies.length) && broadphase->proxies.data[proxy].alive);
+
+    BroadphaseBox box = rect_to_broadphase_box(bounds);
+    set_broadphase_box(&broadphase->bounds, proxy, box);
+
+    if(broadphase->type == BroadphaseType_Grid)
+    {
+        // Only touch the buckets if the proxy has moved into a different set of cells.
+        const BroadphaseProxyData& data = broadphase->proxies.data[proxy];
+        if(get_grid_cell(broadphase, box.min_x) == data.cell_x0 && get_grid_cell(broadphase, box.min_y) == data.cell_y0 &&
+           get_grid_cell(broadphase, box.max_x) == data.cell_x1 && get_grid_cell(broadphase, box.max_y) == data.cell_y1)
+        {
+            return;
+        }
+        remove_grid_cells(broadphase, proxy);
+        insert_grid_cells(broadphase, proxy);
+    }
+    else
+    {
+        // Only touch the tree if the proxy has moved outside of its fattened bounds.
+        nkS32 leaf = broadphase->proxies.data[proxy].leaf;
+        if(broadphase_box_contains(broadphase->nodes.data[leaf].box, box))
+        {
+            return;
+        }
+        remove_tree_leaf(broadphase, leaf);
+        set_tree_leaf_bounds(broadphase, proxy);
+        insert_tree_leaf(broadphase, leaf);
+    }
+}
+
+GLOBAL void remove_broadphase_proxy(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(proxy >= 0 && proxy < NK_CAST(BroadphaseProxy, broadphase->proxies.length) && broadphase->proxies.data[proxy].alive);
+
+    if(broadphase->type == BroadphaseType_Grid)
+    {
+        remove_grid_cells(broadphase, proxy);
+    }
+    else
+    {
+        nkS32 leaf = broadphase->proxies.data[proxy].leaf;
+        remove_tree_leaf(broadphase, leaf);
+        free_tree_node(broadphase, leaf);
+    }
+
+    BroadphaseProxyData& data = broadphase->proxies.data[proxy];
+    data.alive     = NK_FALSE;
+    data.next_free = broadphase->free_proxy;
+
+    broadphase->free_proxy = proxy;
+    broadphase->proxy_count--;
+}
+
+GLOBAL void* get_broadphase_user_data(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(proxy >= 0 && proxy < NK_CAST(BroadphaseProxy, broadphase->proxies.length));
+    return broadphase->proxies.data[proxy].user_data;
+}
+
+GLOBAL fRect get_broadphase_bounds(Broadphase broadphase, BroadphaseProxy proxy)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(proxy >= 0 && proxy < NK_CAST(BroadphaseProxy, broadphase->proxies.length));
+    return broadphase_box_to_rect(get_broadphase_box(&broadphase->bounds, proxy));
+}
+
+GLOBAL nkS32 get_broadphase_count(Broadphase broadphase)
+{
+    NK_ASSERT(broadphase);
+    return broadphase->proxy_count;
+}
+
+GLOBAL nkS32 query_broadphase_rect(Broadphase broadphase, const fRect& region, BroadphaseProxy* out, nkS32 max_out)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(out || max_out == 0);
+
+    BroadphaseBox box = rect_to_broadphase_box(region);
+    if(broadphase->type == BroadphaseType_Grid) return query_grid(broadphase, box, NULL, out, max_out);
+    return query_tree(broadphase, box, NULL, out, max_out);
+}
+
+GLOBAL nkS32 query_broadphase_circle(Broadphase broadphase, const fCircle& region, BroadphaseProxy* out, nkS32 max_out)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(out || max_out == 0);
+
+    BroadphaseBox box = { region.x - region.r, region.y - region.r, region.x + region.r, region.y + region.r };
+    if(broadphase->type == BroadphaseType_Grid) return query_grid(broadphase, box, &region, out, max_out);
+    return query_tree(broadphase, box, &region, out, max_out);
+}
+
+GLOBAL nkS32 ray_cast_broadphase(Broadphase broadphase, const fLine& ray, BroadphaseRayHit* out, nkS32 max_out)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(out || max_out == 0);
+
+    if(broadphase->type == BroadphaseType_Grid) return ray_cast_grid(broadphase, ray, out, max_out);
+    return ray_cast_tree(broadphase, ray, out, max_out);
+}
+
+GLOBAL nkS32 find_broadphase_pairs(Broadphase broadphase, BroadphasePair* out, nkS32 max_out)
+{
+    NK_ASSERT(broadphase);
+    NK_ASSERT(out || max_out == 0);
+
+    if(broadphase->type == BroadphaseType_Grid) return find_grid_pairs(broadphase, out, max_out);
+    return find_tree_pairs(broadphase, out, max_out);
+}
+// =============================================================================
+
+/*////////////////////////////////////////////////////////////////////////////*/
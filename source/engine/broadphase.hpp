@@ -0,0 +1,71 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+// =============================================================================
+// Broadphase for collision queries, so rather than testing every shape against
+// every other shape only the ones with nearby bounds get looked at. Shapes are
+// added as proxies with an axis-aligned bounding box and some user data, then
+// the exact tests in collision.hpp can be run on whatever the queries return.
+//
+// There are two types to pick between depending on the scene:
+//
+//  - Grid: A uniform grid hashed into a fixed number of buckets, so the world
+//    doesn't need to have bounds. Works best when most shapes are around the
+//    size of a cell, moving within a cell costs nothing to update.
+//  - Tree: A dynamic AABB tree, proxy bounds are fattened by a margin so small
+//    movements don't have to touch the tree. Copes better than the grid with
+//    shapes of mixed sizes and worlds that are large and sparse.
+//
+// The queries write into buffers given by the caller and don't allocate, they
+// all return how many results were written and stop once the buffer is full.
+// The scratch state used by queries lives in the broadphase so don't query the
+// same broadphase from multiple threads at once.
+// =============================================================================
+
+DECLARE_PRIVATE_TYPE(Broadphase);
+
+typedef nkS32 BroadphaseProxy;
+
+INTERNAL constexpr BroadphaseProxy INVALID_BROADPHASE_PROXY = -1;
+
+NK_ENUM(BroadphaseType, nkS32)
+{
+    BroadphaseType_Grid,
+    BroadphaseType_Tree,
+    BroadphaseType_TOTAL
+};
+
+struct BroadphaseDesc
+{
+    BroadphaseType type         = BroadphaseType_Grid;
+    nkS32          capacity     = 256;   // Number of proxies to allocate space for up front.
+    nkF32          cell_size    = 64.0f; // Grid only.
+    nkS32          bucket_count = 4096;  // Grid only, gets rounded up to a power of two.
+    nkF32          margin       = 4.0f;  // Tree only, how far the bounds stored in the tree are fattened by.
+};
+
+struct BroadphasePair
+{
+    BroadphaseProxy a; // Always the lower of the two.
+    BroadphaseProxy b;
+};
+
+struct BroadphaseRayHit
+{
+    BroadphaseProxy proxy;
+    nkF32           t; // How far along the ray the bounds were entered, from 0 to 1.
+};
+
+GLOBAL Broadphase      create_broadphase       (const BroadphaseDesc& desc = BroadphaseDesc());
+GLOBAL void            free_broadphase         (Broadphase broadphase);
+GLOBAL BroadphaseProxy insert_broadphase_proxy (Broadphase broadphase, const fRect& bounds, void* user_data = NULL);
+GLOBAL void            update_broadphase_proxy (Broadphase broadphase, BroadphaseProxy proxy, const fRect& bounds);
+GLOBAL void            remove_broadphase_proxy (Broadphase broadphase, BroadphaseProxy proxy);
+GLOBAL void*           get_broadphase_user_data(Broadphase broadphase, BroadphaseProxy proxy);
+GLOBAL fRect           get_broadphase_bounds   (Broadphase broadphase, BroadphaseProxy proxy);
+GLOBAL nkS32           get_broadphase_count    (Broadphase broadphase);
+GLOBAL nkS32           query_broadphase_rect   (Broadphase broadphase, const fRect&   region, BroadphaseProxy* out, nkS32 max_out);
+GLOBAL nkS32           query_broadphase_circle (Broadphase broadphase, const fCircle& region, BroadphaseProxy* out, nkS32 max_out);
+GLOBAL nkS32           ray_cast_broadphase     (Broadphase broadphase, const fLine&   ray,    BroadphaseRayHit* out, nkS32 max_out); // Hits are unsorted.
+GLOBAL nkS32           find_broadphase_pairs   (Broadphase broadphase, BroadphasePair* out, nkS32 max_out); // Proxies with overlapping bounds.
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -8,7 +8,9 @@ GLOBAL NKFORCEINLINE nkBool point_vs_point(const fPoint& a, const fPoint& b)
 }
 GLOBAL NKFORCEINLINE nkBool point_vs_circle(const fPoint& p, const fCircle& c)
 {
-    return (distance_between_points({ p.x,p.y }, { c.x,c.y }) < c.r);
+    nkF32 dx = p.x - c.x;
+    nkF32 dy = p.y - c.y;
+    return ((dx*dx + dy*dy) < (c.r*c.r));
 }
 GLOBAL NKFORCEINLINE nkBool point_vs_rect(const fPoint& p, const fRect& r)
 {
@@ -32,10 +34,7 @@ GLOBAL NKFORCEINLINE nkBool rect_vs_circle(const fRect& r, const fCircle& c)
     ray.x = nearest.x - c.x;
     ray.y = nearest.y - c.y;
 
-    nkF32 overlap = (c.r - nk_length(ray));
-    if(isnan(overlap))
-        overlap = 0.0f;
-    return (overlap > 0.0f);
+    return ((ray.x*ray.x + ray.y*ray.y) < (c.r*c.r));
 }
 GLOBAL NKFORCEINLINE nkBool rect_vs_rect(const fRect& a, const fRect& b)
 {
@@ -46,27 +45,570 @@ GLOBAL NKFORCEINLINE nkBool rect_vs_rect(const fRect& a, const fRect& b)
 //
 GLOBAL NKFORCEINLINE nkBool circle_vs_point(const fCircle& c, const fPoint& p)
 {
-    return (distance_between_points({ p.x,p.y }, { c.x,c.y }) < c.r);
+    return point_vs_circle(p, c);
 }
 GLOBAL NKFORCEINLINE nkBool circle_vs_circle(const fCircle& a, const fCircle& b)
 {
-    return (nk_length(nkVec2{ a.x-b.x, a.y-b.y }) < (a.r + b.r));
+    nkF32 dx = a.x - b.x;
+    nkF32 dy = a.y - b.y;
+    nkF32 r  = a.r + b.r;
+    return ((dx*dx + dy*dy) < (r*r));
 }
-GLOBAL NKFORCEINLINE nkBool circle_vs_rect(const fCircle& c, const fRect&  r)
+GLOBAL NKFORCEINLINE nkBool circle_vs_rect(const fCircle& c, const fRect& r)
 {
-    nkVec2 nearest;
-    nkVec2 ray;
+    return rect_vs_circle(r, c);
+}
 
-    nearest.x = nk_max(r.x, nk_min(c.x, r.x+r.w));
-    nearest.y = nk_max(r.y, nk_min(c.y, r.y+r.h));
 
-    ray.x = nearest.x - c.x;
-    ray.y = nearest.y - c.y;
+// Batch =======================================================================
+
+// The batch tests go through a small SIMD layer like the noise one, but only need float operations so plain AVX will
+// do for the 8 lane version. Min and max are written so they pick the same operand as nk_min and nk_max would when
+// the values compare equal or are NaN, so every lane gives exactly the same answer as the scalar function.
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define COLLISION_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define COLLISION_SIMD_SSE2
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define COLLISION_SIMD_WASM
+#endif
+
+#if defined(COLLISION_SIMD_AVX) || defined(COLLISION_SIMD_SSE2) || defined(COLLISION_SIMD_WASM)
+#define COLLISION_SIMD
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h> // _BitScanForward
+#endif
+
+#if defined(COLLISION_SIMD_AVX)
+
+INTERNAL constexpr nkU64 COLLISION_LANES = 8;
+
+typedef __m256 CollisionLanes;
+
+INTERNAL NKFORCEINLINE CollisionLanes clanes_load(const nkF32* p)                    { return _mm256_loadu_ps(p);                 }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_set (nkF32 a)                           { return _mm256_set1_ps(a);                  }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_add (CollisionLanes a, CollisionLanes b) { return _mm256_add_ps(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_sub (CollisionLanes a, CollisionLanes b) { return _mm256_sub_ps(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_mul (CollisionLanes a, CollisionLanes b) { return _mm256_mul_ps(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_min (CollisionLanes a, CollisionLanes b) { return _mm256_min_ps(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_max (CollisionLanes a, CollisionLanes b) { return _mm256_max_ps(b, a);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_lt  (CollisionLanes a, CollisionLanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ);    }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_le  (CollisionLanes a, CollisionLanes b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ);    }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_and (CollisionLanes a, CollisionLanes b) { return _mm256_and_ps(a, b);                }
+INTERNAL NKFORCEINLINE nkU32          clanes_mask(CollisionLanes a)                   { return NK_CAST(nkU32, _mm256_movemask_ps(a)); }
+
+#elif defined(COLLISION_SIMD_SSE2)
+
+INTERNAL constexpr nkU64 COLLISION_LANES = 4;
+
+typedef __m128 CollisionLanes;
+
+INTERNAL NKFORCEINLINE CollisionLanes clanes_load(const nkF32* p)                    { return _mm_loadu_ps(p);                    }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_set (nkF32 a)                           { return _mm_set1_ps(a);                     }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_add (CollisionLanes a, CollisionLanes b) { return _mm_add_ps(a, b);                   }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_sub (CollisionLanes a, CollisionLanes b) { return _mm_sub_ps(a, b);                   }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_mul (CollisionLanes a, CollisionLanes b) { return _mm_mul_ps(a, b);                   }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_min (CollisionLanes a, CollisionLanes b) { return _mm_min_ps(a, b);                   }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_max (CollisionLanes a, CollisionLanes b) { return _mm_max_ps(b, a);                   }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_lt  (CollisionLanes a, CollisionLanes b) { return _mm_cmplt_ps(a, b);                 }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_le  (CollisionLanes a, CollisionLanes b) { return _mm_cmple_ps(a, b);                 }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_and (CollisionLanes a, CollisionLanes b) { return _mm_and_ps(a, b);                   }
+INTERNAL NKFORCEINLINE nkU32          clanes_mask(CollisionLanes a)                   { return NK_CAST(nkU32, _mm_movemask_ps(a)); }
+
+#elif defined(COLLISION_SIMD_WASM)
+
+INTERNAL constexpr nkU64 COLLISION_LANES = 4;
+
+typedef v128_t CollisionLanes;
+
+INTERNAL NKFORCEINLINE CollisionLanes clanes_load(const nkF32* p)                    { return wasm_v128_load(p);                  }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_set (nkF32 a)                           { return wasm_f32x4_splat(a);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_add (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_add(a, b);               }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_sub (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_sub(a, b);               }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_mul (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_mul(a, b);               }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_min (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_pmin(b, a);              }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_max (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_pmax(a, b);              }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_lt  (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_lt(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_le  (CollisionLanes a, CollisionLanes b) { return wasm_f32x4_le(a, b);                }
+INTERNAL NKFORCEINLINE CollisionLanes clanes_and (CollisionLanes a, CollisionLanes b) { return wasm_v128_and(a, b);                }
+INTERNAL NKFORCEINLINE nkU32          clanes_mask(CollisionLanes a)                   { return wasm_i32x4_bitmask(a);              }
+
+#endif
+
+// Each batch test is a small struct with the scalar test for a single shape and, when there is SIMD, the same test for
+// a register's worth of shapes returning one bit per lane. run_collision_batch does the looping and packs the bits.
+
+template<typename T>
+INTERNAL void run_collision_batch(const T& test, nkU64 count, nkU32* hits)
+{
+    memset(hits, 0, get_batch_hit_words(count) * sizeof(nkU32));
+
+    nkU64 i = 0;
+
+    #if defined(COLLISION_SIMD)
+    // The lane count divides 32 so a register's worth of bits never straddles two words.
+    for(; i+COLLISION_LANES<=count; i+=COLLISION_LANES)
+        hits[i/32] |= (test.lanes(i) << (i%32));
+    #endif // COLLISION_SIMD
+
+    for(; i<count; ++i)
+        if(test.scalar(i))
+            hits[i/32] |= (1u << (i%32));
+}
+
+struct PointVsRects
+{
+    fPoint   p;
+    fRectSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return point_vs_rect(p, { b.x[i], b.y[i], b.w[i], b.h[i] });
+    }
+
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes px = clanes_set(p.x), py = clanes_set(p.y);
+        CollisionLanes bx = clanes_load(b.x+i), by = clanes_load(b.y+i);
+        CollisionLanes bw = clanes_load(b.w+i), bh = clanes_load(b.h+i);
+
+        CollisionLanes m = clanes_and(clanes_le(bx, px), clanes_lt(px, clanes_add(bx, bw)));
+        m = clanes_and(m, clanes_and(clanes_le(by, py), clanes_lt(py, clanes_add(by, bh))));
+        return clanes_mask(m);
+    }
+    #endif // COLLISION_SIMD
+};
+
+struct PointVsCircles
+{
+    fPoint     p;
+    fCircleSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return point_vs_circle(p, { b.x[i], b.y[i], b.r[i] });
+    }
 
-    nkF32 overlap = (c.r - nk_length(ray));
-    if(isnan(overlap))
-        overlap = 0.0f;
-    return (overlap > 0.0f);
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes dx = clanes_sub(clanes_set(p.x), clanes_load(b.x+i));
+        CollisionLanes dy = clanes_sub(clanes_set(p.y), clanes_load(b.y+i));
+        CollisionLanes r  = clanes_load(b.r+i);
+        return clanes_mask(clanes_lt(clanes_add(clanes_mul(dx, dx), clanes_mul(dy, dy)), clanes_mul(r, r)));
+    }
+    #endif // COLLISION_SIMD
+};
+
+struct RectVsRects
+{
+    fRect    a;
+    fRectSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return rect_vs_rect(a, { b.x[i], b.y[i], b.w[i], b.h[i] });
+    }
+
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes ax = clanes_set(a.x), ax2 = clanes_set(a.x + a.w);
+        CollisionLanes ay = clanes_set(a.y), ay2 = clanes_set(a.y + a.h);
+        CollisionLanes bx = clanes_load(b.x+i), by = clanes_load(b.y+i);
+
+        CollisionLanes m = clanes_and(clanes_lt(ax, clanes_add(bx, clanes_load(b.w+i))), clanes_lt(bx, ax2));
+        m = clanes_and(m, clanes_and(clanes_lt(ay, clanes_add(by, clanes_load(b.h+i))), clanes_lt(by, ay2)));
+        return clanes_mask(m);
+    }
+    #endif // COLLISION_SIMD
+};
+
+struct RectVsCircles
+{
+    fRect      a;
+    fCircleSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return rect_vs_circle(a, { b.x[i], b.y[i], b.r[i] });
+    }
+
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes cx = clanes_load(b.x+i);
+        CollisionLanes cy = clanes_load(b.y+i);
+        CollisionLanes cr = clanes_load(b.r+i);
+
+        CollisionLanes dx = clanes_sub(clanes_max(clanes_set(a.x), clanes_min(cx, clanes_set(a.x + a.w))), cx);
+        CollisionLanes dy = clanes_sub(clanes_max(clanes_set(a.y), clanes_min(cy, clanes_set(a.y + a.h))), cy);
+        return clanes_mask(clanes_lt(clanes_add(clanes_mul(dx, dx), clanes_mul(dy, dy)), clanes_mul(cr, cr)));
+    }
+    #endif // COLLISION_SIMD
+};
+
+struct CircleVsRects
+{
+    fCircle  a;
+    fRectSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return circle_vs_rect(a, { b.x[i], b.y[i], b.w[i], b.h[i] });
+    }
+
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes cx = clanes_set(a.x);
+        CollisionLanes cy = clanes_set(a.y);
+        CollisionLanes rx = clanes_load(b.x+i);
+        CollisionLanes ry = clanes_load(b.y+i);
+
+        CollisionLanes dx = clanes_sub(clanes_max(rx, clanes_min(cx, clanes_add(rx, clanes_load(b.w+i)))), cx);
+        CollisionLanes dy = clanes_sub(clanes_max(ry, clanes_min(cy, clanes_add(ry, clanes_load(b.h+i)))), cy);
+        return clanes_mask(clanes_lt(clanes_add(clanes_mul(dx, dx), clanes_mul(dy, dy)), clanes_set(a.r * a.r)));
+    }
+    #endif // COLLISION_SIMD
+};
+
+struct CircleVsCircles
+{
+    fCircle    a;
+    fCircleSoA b;
+
+    NKFORCEINLINE nkBool scalar(nkU64 i) const
+    {
+        return circle_vs_circle(a, { b.x[i], b.y[i], b.r[i] });
+    }
+
+    #if defined(COLLISION_SIMD)
+    NKFORCEINLINE nkU32 lanes(nkU64 i) const
+    {
+        CollisionLanes dx = clanes_sub(clanes_set(a.x), clanes_load(b.x+i));
+        CollisionLanes dy = clanes_sub(clanes_set(a.y), clanes_load(b.y+i));
+        CollisionLanes r  = clanes_add(clanes_set(a.r), clanes_load(b.r+i));
+        return clanes_mask(clanes_lt(clanes_add(clanes_mul(dx, dx), clanes_mul(dy, dy)), clanes_mul(r, r)));
+    }
+    #endif // COLLISION_SIMD
+};
+
+INTERNAL NKFORCEINLINE nkU32 count_trailing_zeros(nkU32 x)
+{
+    #if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return NK_CAST(nkU32, index);
+    #else
+    return NK_CAST(nkU32, __builtin_ctz(x));
+    #endif // _MSC_VER
+}
+
+GLOBAL NKFORCEINLINE nkU64 get_batch_hit_words(nkU64 count)
+{
+    return ((count + 31) / 32);
+}
+
+GLOBAL void point_vs_rects(const fPoint& p, const fRectSoA& rects, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(PointVsRects { p, rects }, count, hits);
+}
+
+GLOBAL void point_vs_circles(const fPoint& p, const fCircleSoA& circles, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(PointVsCircles { p, circles }, count, hits);
+}
+
+GLOBAL void rect_vs_rects(const fRect& r, const fRectSoA& rects, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(RectVsRects { r, rects }, count, hits);
+}
+
+GLOBAL void rect_vs_circles(const fRect& r, const fCircleSoA& circles, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(RectVsCircles { r, circles }, count, hits);
+}
+
+GLOBAL void circle_vs_rects(const fCircle& c, const fRectSoA& rects, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(CircleVsRects { c, rects }, count, hits);
 }
 
+GLOBAL void circle_vs_circles(const fCircle& c, const fCircleSoA& circles, nkU64 count, nkU32* hits)
+{
+    run_collision_batch(CircleVsCircles { c, circles }, count, hits);
+}
+
+GLOBAL nkU64 get_batch_hit_indices(const nkU32* hits, nkU64 count, nkU32* indices)
+{
+    nkU64 written = 0;
+    for(nkU64 i=0, n=get_batch_hit_words(count); i<n; ++i)
+    {
+        nkU32 word = hits[i];
+        while(word)
+        {
+            indices[written++] = NK_CAST(nkU32, i * 32 + count_trailing_zeros(word));
+            word &= (word - 1);
+        }
+    }
+    return written;
+}
+
+// =============================================================================
+
+
+// Sweep =======================================================================
+
+// Everything below is done as a ray from the moving shape's origin tested against the static shape grown by the size
+// of the moving one. The ray helpers only count hits that actually pass through the inside of the shape, so grazing
+// along an edge doesn't stop anything, and they don't report anything if the ray starts inside.
+
+INTERNAL nkBool ray_enter_rect(const nkVec2& o, const nkVec2& d, const fRect& r, CollisionHit* hit)
+{
+    nkF32  t_enter = -FLT_MAX;
+    nkF32  t_exit  =  FLT_MAX;
+    nkVec2 normal  = { 0.0f, 0.0f };
+
+    const nkF32 origin[2] = { o.x, o.y };
+    const nkF32 dir   [2] = { d.x, d.y };
+    const nkF32 lo    [2] = { r.x, r.y };
+    const nkF32 hi    [2] = { r.x + r.w, r.y + r.h };
+
+    for(nkS32 axis=0; axis<2; ++axis)
+    {
+        if(dir[axis] == 0.0f)
+        {
+            if(origin[axis] <= lo[axis] || origin[axis] >= hi[axis])
+                return NK_FALSE;
+            continue;
+        }
+
+        nkF32 t0 = (lo[axis] - origin[axis]) / dir[axis];
+        nkF32 t1 = (hi[axis] - origin[axis]) / dir[axis];
+        nkF32 n  = -1.0f;
+        if(t0 > t1)
+        {
+            nkF32 tmp = t0; t0 = t1; t1 = tmp;
+            n = 1.0f;
+        }
+        if(t0 > t_enter)
+        {
+            t_enter = t0;
+            normal = (axis == 0) ? nkVec2{ n, 0.0f } : nkVec2{ 0.0f, n };
+        }
+        t_exit = nk_min(t_exit, t1);
+    }
+
+    if(t_enter >= t_exit || t_enter < 0.0f || t_enter > 1.0f)
+        return NK_FALSE;
+
+    hit->t      = t_enter;
+    hit->normal = normal;
+    return NK_TRUE;
+}
+
+INTERNAL nkBool ray_enter_circle(const nkVec2& o, const nkVec2& d, const nkVec2& c, nkF32 r, CollisionHit* hit)
+{
+    nkVec2 m = { o.x - c.x, o.y - c.y };
+
+    nkF32 a = d.x*d.x + d.y*d.y;
+    nkF32 b = m.x*d.x + m.y*d.y;
+    nkF32 e = m.x*m.x + m.y*m.y - r*r;
+
+    if(a == 0.0f || b >= 0.0f) // Not moving or moving away.
+        return NK_FALSE;
+
+    nkF32 discriminant = b*b - a*e;
+    if(discriminant <= 0.0f)
+        return NK_FALSE;
+
+    nkF32 t = (-b - sqrtf(discriminant)) / a;
+    if(t < 0.0f || t > 1.0f)
+        return NK_FALSE;
+
+    hit->t      = t;
+    hit->normal = nk_normalize(nkVec2{ m.x + d.x*t, m.y + d.y*t });
+    return NK_TRUE;
+}
+
+// Which way to push a circle centre out of a rect, used when it's already overlapping at the start of a sweep.
+INTERNAL nkVec2 get_rect_exit_normal(const fRect& r, const nkVec2& p)
+{
+    nkF32 left   = p.x - r.x;
+    nkF32 right  = (r.x + r.w) - p.x;
+    nkF32 top    = p.y - r.y;
+    nkF32 bottom = (r.y + r.h) - p.y;
+
+    nkF32 x = nk_min(left, right);
+    nkF32 y = nk_min(top, bottom);
+
+    if(x < y) return (left < right) ? nkVec2{ -1.0f, 0.0f } : nkVec2{ 1.0f, 0.0f };
+    else      return (top < bottom) ? nkVec2{ 0.0f, -1.0f } : nkVec2{ 0.0f, 1.0f };
+}
+
+INTERNAL NKFORCEINLINE nkBool report_collision_hit(CollisionHit* hit, const CollisionHit& result)
+{
+    if(hit) *hit = result;
+    return NK_TRUE;
+}
+
+GLOBAL nkBool sweep_rect_vs_rect(const fRect& a, const nkVec2& move, const fRect& b, CollisionHit* hit)
+{
+    if(rect_vs_rect(a, b))
+    {
+        // Push out along whichever axis has the least overlap.
+        nkF32 left   = (a.x + a.w) - b.x;
+        nkF32 right  = (b.x + b.w) - a.x;
+        nkF32 top    = (a.y + a.h) - b.y;
+        nkF32 bottom = (b.y + b.h) - a.y;
+
+        CollisionHit result;
+        result.t = 0.0f;
+        if(nk_min(left, right) < nk_min(top, bottom))
+            result.normal = (left < right) ? nkVec2{ -1.0f, 0.0f } : nkVec2{ 1.0f, 0.0f };
+        else
+            result.normal = (top < bottom) ? nkVec2{ 0.0f, -1.0f } : nkVec2{ 0.0f, 1.0f };
+        return report_collision_hit(hit, result);
+    }
+
+    fRect grown = { b.x - a.w, b.y - a.h, b.w + a.w, b.h + a.h };
+
+    CollisionHit result;
+    if(!ray_enter_rect({ a.x, a.y }, move, grown, &result))
+        return NK_FALSE;
+    return report_collision_hit(hit, result);
+}
+
+GLOBAL nkBool sweep_rect_vs_circle(const fRect& a, const nkVec2& move, const fCircle& b, CollisionHit* hit)
+{
+    // The same as the circle moving the opposite way into the rect, with the normal flipped to face the rect.
+    CollisionHit result;
+    if(!sweep_circle_vs_rect(b, { -move.x, -move.y }, a, &result))
+        return NK_FALSE;
+    result.normal = { -result.normal.x, -result.normal.y };
+    return report_collision_hit(hit, result);
+}
+
+GLOBAL nkBool sweep_circle_vs_rect(const fCircle& a, const nkVec2& move, const fRect& b, CollisionHit* hit)
+{
+    nkVec2 centre = { a.x, a.y };
+
+    if(circle_vs_rect(a, b))
+    {
+        nkVec2 nearest = { nk_max(b.x, nk_min(a.x, b.x+b.w)), nk_max(b.y, nk_min(a.y, b.y+b.h)) };
+        nkVec2 ray = { a.x - nearest.x, a.y - nearest.y };
+
+        CollisionHit result;
+        result.t = 0.0f;
+        if(ray.x == 0.0f && ray.y == 0.0f) // Centre is inside the rect.
+            result.normal = get_rect_exit_normal(b, centre);
+        else
+            result.normal = nk_normalize(ray);
+        return report_collision_hit(hit, result);
+    }
+
+    // The rect grown by the radius has rounded corners, so test against the two rects making the cross through the
+    // middle of that shape and the four corner circles, the first one entered is where the circle hits.
+    fRect wide = { b.x - a.r, b.y, b.w + a.r*2.0f, b.h };
+    fRect tall = { b.x, b.y - a.r, b.w, b.h + a.r*2.0f };
+
+    const nkVec2 corners[4] = { { b.x,b.y }, { b.x+b.w,b.y }, { b.x,b.y+b.h }, { b.x+b.w,b.y+b.h } };
+
+    CollisionHit best;
+    CollisionHit test;
+
+    best.t = FLT_MAX;
+
+    if(ray_enter_rect(centre, move, wide, &test) && test.t < best.t) best = test;
+    if(ray_enter_rect(centre, move, tall, &test) && test.t < best.t) best = test;
+
+    for(auto& corner: corners)
+        if(ray_enter_circle(centre, move, corner, a.r, &test) && test.t < best.t)
+            best = test;
+
+    if(best.t > 1.0f)
+        return NK_FALSE;
+    return report_collision_hit(hit, best);
+}
+
+GLOBAL nkBool sweep_circle_vs_circle(const fCircle& a, const nkVec2& move, const fCircle& b, CollisionHit* hit)
+{
+    if(circle_vs_circle(a, b))
+    {
+        nkVec2 ray = { a.x - b.x, a.y - b.y };
+
+        CollisionHit result;
+        result.t = 0.0f;
+        if(ray.x == 0.0f && ray.y == 0.0f) // Same centre so any direction is as good as any other.
+            result.normal = { 0.0f, -1.0f };
+        else
+            result.normal = nk_normalize(ray);
+        return report_collision_hit(hit, result);
+    }
+
+    CollisionHit result;
+    if(!ray_enter_circle({ a.x, a.y }, move, { b.x, b.y }, a.r + b.r, &result))
+        return NK_FALSE;
+    return report_collision_hit(hit, result);
+}
+
+GLOBAL nkBool line_vs_line(const fLine& a, const fLine& b, CollisionHit* hit)
+{
+    nkVec2 r = { a.x2 - a.x1, a.y2 - a.y1 };
+    nkVec2 s = { b.x2 - b.x1, b.y2 - b.y1 };
+    nkVec2 q = { b.x1 - a.x1, b.y1 - a.y1 };
+
+    nkF32 denom = r.x*s.y - r.y*s.x;
+    if(denom == 0.0f) // Parallel, or one of the lines has no length.
+        return NK_FALSE;
+
+    nkF32 t = (q.x*s.y - q.y*s.x) / denom;
+    nkF32 u = (q.x*r.y - q.y*r.x) / denom;
+
+    if(t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f)
+        return NK_FALSE;
+
+    // Perpendicular to the line that was hit, facing back towards the start of the other.
+    nkVec2 normal = nk_normalize(nkVec2{ -s.y, s.x });
+    if(normal.x*r.x + normal.y*r.y > 0.0f)
+        normal = { -normal.x, -normal.y };
+
+    CollisionHit result;
+    result.t      = t;
+    result.normal = normal;
+    return report_collision_hit(hit, result);
+}
+
+GLOBAL nkBool line_vs_rect(const fLine& l, const fRect& r, CollisionHit* hit)
+{
+    if(point_vs_rect({ l.x1, l.y1 }, r))
+        return report_collision_hit(hit, { 0.0f, { 0.0f, 0.0f } });
+
+    CollisionHit result;
+    if(!ray_enter_rect({ l.x1, l.y1 }, { l.x2-l.x1, l.y2-l.y1 }, r, &result))
+        return NK_FALSE;
+    return report_collision_hit(hit, result);
+}
+
+GLOBAL nkBool line_vs_circle(const fLine& l, const fCircle& c, CollisionHit* hit)
+{
+    if(point_vs_circle({ l.x1, l.y1 }, c))
+        return report_collision_hit(hit, { 0.0f, { 0.0f, 0.0f } });
+
+    CollisionHit result;
+    if(!ray_enter_circle({ l.x1, l.y1 }, { l.x2-l.x1, l.y2-l.y1 }, { c.x, c.y }, c.r, &result))
+        return NK_FALSE;
+    return report_collision_hit(hit, result);
+}
+
+// =============================================================================
+
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -12,4 +12,75 @@ GLOBAL NKFORCEINLINE nkBool circle_vs_point (const fCircle& c, const fPoint&  p)
 GLOBAL NKFORCEINLINE nkBool circle_vs_circle(const fCircle& a, const fCircle& b);
 GLOBAL NKFORCEINLINE nkBool circle_vs_rect  (const fCircle& c, const fRect&   r);
 
+// =============================================================================
+// Batch tests for checking one shape against lots of others at once, which is
+// the common case after a broadphase query or when testing a bullet against a
+// whole pool of enemies. The shapes being tested against are passed as arrays
+// of components (SoA) so they can be loaded straight into SIMD registers, SSE
+// or AVX on x86 and Wasm SIMD on the web, picked at compile time the same way
+// as the noise functions. The results always match the scalar functions.
+//
+// Hits are written as a bitmask with one bit for each shape, bit (i % 32) of
+// word (i / 32), so the mask needs get_batch_hit_words(count) words. If a list
+// of indices is more useful then get_batch_hit_indices will convert the mask.
+// =============================================================================
+
+struct fRectSoA
+{
+    const nkF32* x;
+    const nkF32* y;
+    const nkF32* w;
+    const nkF32* h;
+};
+
+struct fCircleSoA
+{
+    const nkF32* x;
+    const nkF32* y;
+    const nkF32* r;
+};
+
+GLOBAL NKFORCEINLINE nkU64 get_batch_hit_words(nkU64 count);
+
+GLOBAL void  point_vs_rects       (const fPoint&  p, const fRectSoA&   rects,   nkU64 count, nkU32* hits);
+GLOBAL void  point_vs_circles     (const fPoint&  p, const fCircleSoA& circles, nkU64 count, nkU32* hits);
+GLOBAL void  rect_vs_rects        (const fRect&   r, const fRectSoA&   rects,   nkU64 count, nkU32* hits);
+GLOBAL void  rect_vs_circles      (const fRect&   r, const fCircleSoA& circles, nkU64 count, nkU32* hits);
+GLOBAL void  circle_vs_rects      (const fCircle& c, const fRectSoA&   rects,   nkU64 count, nkU32* hits);
+GLOBAL void  circle_vs_circles    (const fCircle& c, const fCircleSoA& circles, nkU64 count, nkU32* hits);
+GLOBAL nkU64 get_batch_hit_indices(const nkU32* hits, nkU64 count, nkU32* indices); // Returns the number of indices written.
+
+// =============================================================================
+// Swept tests for shapes that move far enough in a tick to pass straight over
+// something thin, the movement is treated as continuous so nothing tunnels no
+// matter how fast it goes. The moving shape is swept along move (the distance
+// it travels this tick) against a shape that is staying still. If two shapes
+// are both moving then sweep one with the difference of their movements.
+//
+// On a hit the time of impact is how far along move the shapes first touch,
+// from 0 to 1, and the normal is of the surface that was hit, pointing back
+// towards the moving shape. Moving the shape by move * t puts it in contact.
+// If the shapes already overlap before moving the hit is at t 0, the normal
+// then points the quickest way out.
+//
+// The line tests cast a segment from (x1,y1) to (x2,y2), with t being how far
+// along the segment the first hit is. A segment starting inside a shape hits
+// it at t 0 with a zero normal.
+// =============================================================================
+
+struct CollisionHit
+{
+    nkF32  t      = 0.0f;
+    nkVec2 normal = {};
+};
+
+GLOBAL nkBool sweep_rect_vs_rect    (const fRect&   a, const nkVec2& move, const fRect&   b, CollisionHit* hit = NULL);
+GLOBAL nkBool sweep_rect_vs_circle  (const fRect&   a, const nkVec2& move, const fCircle& b, CollisionHit* hit = NULL);
+GLOBAL nkBool sweep_circle_vs_rect  (const fCircle& a, const nkVec2& move, const fRect&   b, CollisionHit* hit = NULL);
+GLOBAL nkBool sweep_circle_vs_circle(const fCircle& a, const nkVec2& move, const fCircle& b, CollisionHit* hit = NULL);
+
+GLOBAL nkBool line_vs_line  (const fLine& a, const fLine&   b, CollisionHit* hit = NULL);
+GLOBAL nkBool line_vs_rect  (const fLine& l, const fRect&   r, CollisionHit* hit = NULL);
+GLOBAL nkBool line_vs_circle(const fLine& l, const fCircle& c, CollisionHit* hit = NULL);
+
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -9,7 +9,7 @@
 // This rendering implementation is based off of imgui_impl_opengl3.
 // =============================================================================
 
-#if defined(BUILD_DEBUG)
+#if defined(BUILD_DEBUG) && !defined(BUILD_HEADLESS)
 
 #define IMGUI_DEFINE_MATH_OPERATORS
 
@@ -313,6 +313,6 @@ GLOBAL nkBool is_debug_ui_enabled(void)
     return g_debug_ui.enabled;
 }
 
-#endif // BUILD_DEBUG
+#endif // BUILD_DEBUG && !BUILD_HEADLESS
 
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -1,7 +1,8 @@
 /*////////////////////////////////////////////////////////////////////////////*/
 
 // Debug UI is only available in debug builds, so wrap ImGui code in BUILD_DEBUG!
-#if defined(BUILD_DEBUG)
+// Headless builds have no window for it to go in, so it is left out of those too.
+#if defined(BUILD_DEBUG) && !defined(BUILD_HEADLESS)
 
 GLOBAL void   init_debug_ui_system   (void);
 GLOBAL void   quit_debug_ui_system   (void);
@@ -21,6 +22,6 @@ GLOBAL nkBool is_debug_ui_enabled    (void);
 #define render_debug_ui_frame()        ((void)0 )
 #define is_debug_ui_enabled()          (NK_FALSE)
 
-#endif // BUILD_DEBUG
+#endif // BUILD_DEBUG && !BUILD_HEADLESS
 
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -15,6 +15,7 @@
 #include <nk_array.h>
 #include <nk_string.h>
 #include <nk_hashmap.h>
+#include <nk_name.h>
 #include <nk_stack.h>
 #include <nk_defer.h>
 
@@ -29,8 +30,11 @@
 #include <wchar.h>
 
 #include "utility.hpp"
+#include "memory.hpp"
+#include "jobs.hpp"
 #include "noise.hpp"
 #include "collision.hpp"
+#include "broadphase.hpp"
 #include "asset_manager.hpp"
 #include "audio.hpp"
 #include "input.hpp"
@@ -48,9 +52,16 @@
 #include "utility.cpp"
 #include "noise.cpp"
 #include "collision.cpp"
+#include "broadphase.cpp"
 #include "platform.cpp"
+#include "memory.cpp"
+#include "jobs.cpp"
 #include "asset_manager.cpp"
+#if defined(BUILD_HEADLESS)
+#include "audio_null.cpp"
+#else
 #include "audio.cpp"
+#endif // BUILD_HEADLESS
 #include "input.cpp"
 #include "bitmap_font.cpp"
 #include "truetype_font.cpp"
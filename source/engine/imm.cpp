@@ -596,7 +596,11 @@ GLOBAL void imm_rect_filled(nkF32 x, nkF32 y, nkF32 w, nkF32 h, nkVec4 color)
 
 GLOBAL void imm_circle_outline(nkF32 x, nkF32 y, nkF32 r, nkS32 n, nkVec4 color)
 {
-    nkArray<nkVec2> points; // @Speed: Memory allocation and free for every call to this function.
+    Scratch scratch = begin_scratch();
+    NK_DEFER(end_scratch(scratch));
+
+    nkArray<nkVec2> points;
+    points.allocator = &scratch.arena->allocator;
     nk_array_reserve(&points, n);
 
     for(nkS32 i=0; i<n; ++i)
@@ -621,7 +625,11 @@ GLOBAL void imm_circle_outline(nkF32 x, nkF32 y, nkF32 r, nkS32 n, nkVec4 color)
 
 GLOBAL void imm_circle_filled(nkF32 x, nkF32 y, nkF32 r, nkS32 n, nkVec4 color)
 {
-    nkArray<nkVec2> points; // @Speed: Memory allocation and free for every call to this function.
+    Scratch scratch = begin_scratch();
+    NK_DEFER(end_scratch(scratch));
+
+    nkArray<nkVec2> points;
+    points.allocator = &scratch.arena->allocator;
     nk_array_reserve(&points, n);
 
     nkVec2 center = { x,y };
@@ -78,6 +78,32 @@ struct InputState
 
 INTERNAL InputState g_input;
 
+// Everything about the input that can affect a tick, this is what gets recorded.
+struct InputFrame
+{
+    nkBool key_state[KeyCode_TOTAL];
+    nkBool mouse_state[MouseButton_TOTAL];
+    nkBool pad_state[GamepadButton_TOTAL];
+    nkS16  axis_state[GamepadAxis_TOTAL];
+    nkVec2 mouse_pos;
+    nkVec2 mouse_pos_relative;
+    nkVec2 mouse_wheel;
+    nkChar text_input[256];
+};
+
+struct InputRecording
+{
+    FILE*         file;
+    nkU32         seed;
+    nkU32         ticks;
+    InputFrame    last_frame; // Frames are stored as changes from the last one.
+    nkFileContent replay;
+    nkU8*         replay_cursor;
+    nkBool        replaying;
+};
+
+INTERNAL InputRecording g_input_recording;
+
 INTERNAL void remove_gamepad(void)
 {
     if(g_input.gamepad)
@@ -111,6 +137,9 @@ GLOBAL void init_input_system(void)
 
 GLOBAL void quit_input_system(void)
 {
+    stop_input_recording();
+    stop_input_replay();
+
     remove_gamepad();
 }
 
@@ -124,6 +153,8 @@ GLOBAL void process_input_events(void* event)
 
         case SDL_TEXTINPUT:
         {
+            if(g_input_recording.replaying) break; // Text comes from the recording instead.
+
             nkU32 new_length = NK_CAST(nkU32, strlen(g_input.text_input) + strlen(sdl_event->text.text));
             if(new_length < NK_ARRAY_SIZE(g_input.text_input))
             {
@@ -133,14 +164,26 @@ GLOBAL void process_input_events(void* event)
 
         case SDL_MOUSEWHEEL:
         {
+            if(g_input_recording.replaying) break; // The wheel comes from the recording instead.
+
             g_input.mouse_wheel.x = NK_CAST(nkF32, sdl_event->wheel.x);
             g_input.mouse_wheel.y = NK_CAST(nkF32, sdl_event->wheel.y);
         } break;
     }
 }
 
+INTERNAL void record_input_frame(void);
+INTERNAL void replay_input_frame(void);
+
 GLOBAL void update_input_state()
 {
+    // When replaying the live input is ignored completely, the recording is the only source of input.
+    if(g_input_recording.replaying)
+    {
+        replay_input_frame();
+        return;
+    }
+
     // Update the keyboard state.
     memcpy(g_input.prev_key_state, g_input.curr_key_state, sizeof(g_input.prev_key_state));
     const nkU8* sdl_keyboard_state = SDL_GetKeyboardState(NULL);
@@ -186,6 +229,11 @@ GLOBAL void update_input_state()
         memset(g_input.curr_pad_state, 0, sizeof(g_input.curr_pad_state));
         memset(g_input.curr_axis_state, 0, sizeof(g_input.curr_axis_state));
     }
+
+    if(g_input_recording.file)
+    {
+        record_input_frame();
+    }
 }
 
 GLOBAL void reset_input_state(void)
@@ -196,6 +244,351 @@ GLOBAL void reset_input_state(void)
     g_input.mouse_wheel.y = 0.0f;
 }
 
+//
+// Recording/Replay
+//
+
+INTERNAL constexpr nkU32 INPUT_RECORDING_MAGIC   = NK_FOURCC('NKIR');
+INTERNAL constexpr nkU32 INPUT_RECORDING_VERSION = 1;
+
+// A recording is this header followed by a frame for each tick. Each frame starts with a byte of flags saying what
+// changed since the previous frame, followed by only the changed parts. Buttons are packed down to one bit each.
+struct InputRecordingHeader
+{
+    nkU32 magic;
+    nkU32 version;
+    nkU32 seed;
+    nkF32 tick_rate;
+    nkU32 tick_count; // Filled in when the recording is stopped, zero if it never was (the ticks are still all there).
+};
+
+NK_ENUM(InputFrameFlags, nkU8)
+{
+    InputFrameFlags_None             = 0,
+    InputFrameFlags_Keys             = (1 << 0),
+    InputFrameFlags_MouseButtons     = (1 << 1),
+    InputFrameFlags_PadButtons       = (1 << 2),
+    InputFrameFlags_Axes             = (1 << 3),
+    InputFrameFlags_MousePos         = (1 << 4),
+    InputFrameFlags_MousePosRelative = (1 << 5),
+    InputFrameFlags_MouseWheel       = (1 << 6),
+    InputFrameFlags_TextInput        = (1 << 7)
+};
+
+INTERNAL void pack_input_bits(nkU8* bits, const nkBool* state, nkS32 count)
+{
+    memset(bits, 0, (count+7)/8);
+    for(nkS32 i=0; i<count; ++i)
+        if(state[i]) bits[i/8] |= NK_CAST(nkU8, 1 << (i%8));
+}
+
+INTERNAL void unpack_input_bits(nkBool* state, const nkU8* bits, nkS32 count)
+{
+    for(nkS32 i=0; i<count; ++i)
+        state[i] = ((bits[i/8] & (1 << (i%8))) != 0);
+}
+
+INTERNAL nkBool write_input_bits(FILE* file, const nkBool* state, nkS32 count)
+{
+    nkU8 bits[(KeyCode_TOTAL+7)/8]; // Keys are the largest set of buttons.
+    NK_ASSERT(count <= KeyCode_TOTAL);
+    pack_input_bits(bits, state, count);
+    return (fwrite(bits, (count+7)/8, 1, file) == 1);
+}
+
+INTERNAL nkBool read_input_bytes(void* data, nkU64 size)
+{
+    nkU8* end = NK_CAST(nkU8*, g_input_recording.replay.data) + g_input_recording.replay.size;
+    if(NK_CAST(nkU64, end - g_input_recording.replay_cursor) < size) return NK_FALSE;
+    memcpy(data, g_input_recording.replay_cursor, size);
+    g_input_recording.replay_cursor += size;
+    return NK_TRUE;
+}
+
+INTERNAL nkBool read_input_bits(nkBool* state, nkS32 count)
+{
+    nkU8 bits[(KeyCode_TOTAL+7)/8];
+    NK_ASSERT(count <= KeyCode_TOTAL);
+    if(!read_input_bytes(bits, (count+7)/8)) return NK_FALSE;
+    unpack_input_bits(state, bits, count);
+    return NK_TRUE;
+}
+
+INTERNAL void get_input_frame(InputFrame* frame)
+{
+    memcpy(frame->key_state,   g_input.curr_key_state,   sizeof(frame->key_state));
+    memcpy(frame->mouse_state, g_input.curr_mouse_state, sizeof(frame->mouse_state));
+    memcpy(frame->pad_state,   g_input.curr_pad_state,   sizeof(frame->pad_state));
+    memcpy(frame->axis_state,  g_input.curr_axis_state,  sizeof(frame->axis_state));
+    memcpy(frame->text_input,  g_input.text_input,       sizeof(frame->text_input));
+
+    frame->mouse_pos          = g_input.mouse_pos;
+    frame->mouse_pos_relative = g_input.mouse_pos_relative;
+    frame->mouse_wheel        = g_input.mouse_wheel;
+}
+
+INTERNAL void set_input_frame(const InputFrame* frame)
+{
+    memcpy(g_input.curr_key_state,   frame->key_state,   sizeof(frame->key_state));
+    memcpy(g_input.curr_mouse_state, frame->mouse_state, sizeof(frame->mouse_state));
+    memcpy(g_input.curr_pad_state,   frame->pad_state,   sizeof(frame->pad_state));
+    memcpy(g_input.curr_axis_state,  frame->axis_state,  sizeof(frame->axis_state));
+    memcpy(g_input.text_input,       frame->text_input,  sizeof(frame->text_input));
+
+    g_input.mouse_pos          = frame->mouse_pos;
+    g_input.mouse_pos_relative = frame->mouse_pos_relative;
+    g_input.mouse_wheel        = frame->mouse_wheel;
+}
+
+INTERNAL nkBool input_vec2_changed(nkVec2 a, nkVec2 b)
+{
+    return (a.x != b.x || a.y != b.y);
+}
+
+INTERNAL void record_input_frame(void)
+{
+    InputFrame  frame; get_input_frame(&frame);
+    InputFrame& last = g_input_recording.last_frame;
+
+    nkU8 flags = InputFrameFlags_None;
+
+    if(memcmp(frame.key_state,   last.key_state,   sizeof(frame.key_state))   != 0) flags |= InputFrameFlags_Keys;
+    if(memcmp(frame.mouse_state, last.mouse_state, sizeof(frame.mouse_state)) != 0) flags |= InputFrameFlags_MouseButtons;
+    if(memcmp(frame.pad_state,   last.pad_state,   sizeof(frame.pad_state))   != 0) flags |= InputFrameFlags_PadButtons;
+    if(memcmp(frame.axis_state,  last.axis_state,  sizeof(frame.axis_state))  != 0) flags |= InputFrameFlags_Axes;
+
+    if(input_vec2_changed(frame.mouse_pos,          last.mouse_pos))          flags |= InputFrameFlags_MousePos;
+    if(input_vec2_changed(frame.mouse_pos_relative, last.mouse_pos_relative)) flags |= InputFrameFlags_MousePosRelative;
+    if(input_vec2_changed(frame.mouse_wheel,        last.mouse_wheel))        flags |= InputFrameFlags_MouseWheel;
+
+    if(strcmp(frame.text_input, last.text_input) != 0) flags |= InputFrameFlags_TextInput;
+
+    FILE* file = g_input_recording.file;
+
+    nkBool success = (fwrite(&flags, sizeof(flags), 1, file) == 1);
+
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_Keys))
+        success = success && write_input_bits(file, frame.key_state, KeyCode_TOTAL);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_MouseButtons))
+        success = success && write_input_bits(file, frame.mouse_state, MouseButton_TOTAL);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_PadButtons))
+        success = success && write_input_bits(file, frame.pad_state, GamepadButton_TOTAL);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_Axes))
+        success = success && (fwrite(frame.axis_state, sizeof(frame.axis_state), 1, file) == 1);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_MousePos))
+        success = success && (fwrite(&frame.mouse_pos, sizeof(frame.mouse_pos), 1, file) == 1);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_MousePosRelative))
+        success = success && (fwrite(&frame.mouse_pos_relative, sizeof(frame.mouse_pos_relative), 1, file) == 1);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_MouseWheel))
+        success = success && (fwrite(&frame.mouse_wheel, sizeof(frame.mouse_wheel), 1, file) == 1);
+    if(NK_CHECK_FLAGS(flags, InputFrameFlags_TextInput))
+    {
+        // The text buffer is null-terminated so the length always fits in a byte.
+        nkU8 length = NK_CAST(nkU8, strlen(frame.text_input));
+        success = success && (fwrite(&length, sizeof(length), 1, file) == 1);
+        success = success && (length == 0 || fwrite(frame.text_input, length, 1, file) == 1);
+    }
+
+    if(!success)
+    {
+        printf("[Input]: Failed to write input recording, stopping recording!\n");
+        stop_input_recording();
+        return;
+    }
+
+    g_input_recording.last_frame = frame;
+    g_input_recording.ticks++;
+}
+
+INTERNAL void replay_input_frame(void)
+{
+    memcpy(g_input.prev_key_state,   g_input.curr_key_state,   sizeof(g_input.prev_key_state));
+    memcpy(g_input.prev_mouse_state, g_input.curr_mouse_state, sizeof(g_input.prev_mouse_state));
+    memcpy(g_input.prev_pad_state,   g_input.curr_pad_state,   sizeof(g_input.prev_pad_state));
+    memcpy(g_input.prev_axis_state,  g_input.curr_axis_state,  sizeof(g_input.prev_axis_state));
+
+    InputFrame& frame = g_input_recording.last_frame;
+
+    nkU8 flags = InputFrameFlags_None;
+
+    nkBool success = read_input_bytes(&flags, sizeof(flags));
+    if(success)
+    {
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_Keys))
+            success = success && read_input_bits(frame.key_state, KeyCode_TOTAL);
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_MouseButtons))
+            success = success && read_input_bits(frame.mouse_state, MouseButton_TOTAL);
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_PadButtons))
+            success = success && read_input_bits(frame.pad_state, GamepadButton_TOTAL);
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_Axes))
+            success = success && read_input_bytes(frame.axis_state, sizeof(frame.axis_state));
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_MousePos))
+            success = success && read_input_bytes(&frame.mouse_pos, sizeof(frame.mouse_pos));
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_MousePosRelative))
+            success = success && read_input_bytes(&frame.mouse_pos_relative, sizeof(frame.mouse_pos_relative));
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_MouseWheel))
+            success = success && read_input_bytes(&frame.mouse_wheel, sizeof(frame.mouse_wheel));
+        if(NK_CHECK_FLAGS(flags, InputFrameFlags_TextInput))
+        {
+            nkU8 length = 0;
+            success = success && read_input_bytes(&length, sizeof(length));
+            success = success && read_input_bytes(frame.text_input, length);
+            if(success) frame.text_input[length] = '\0';
+        }
+    }
+
+    // Once the recording runs out (or turns out to be cut short) hand control back to the live input from the next tick.
+    if(!success)
+    {
+        printf("[Input]: Replay finished after %u ticks!\n", g_input_recording.ticks);
+        memset(&frame, 0, sizeof(frame));
+        stop_input_replay();
+    }
+    else
+    {
+        g_input_recording.ticks++;
+    }
+
+    set_input_frame(&frame);
+}
+
+GLOBAL nkBool start_input_recording(const nkChar* file_name, nkU32 seed)
+{
+    NK_ASSERT(file_name);
+
+    stop_input_recording();
+    stop_input_replay();
+
+    FILE* file = fopen(file_name, "wb");
+    if(!file)
+    {
+        printf("[Input]: Failed to open input recording file: %s\n", file_name);
+        return NK_FALSE;
+    }
+
+    InputRecordingHeader header = NK_ZERO_MEM;
+    header.magic      = INPUT_RECORDING_MAGIC;
+    header.version    = INPUT_RECORDING_VERSION;
+    header.seed       = seed;
+    header.tick_rate  = get_app_desc()->tick_rate;
+    header.tick_count = 0;
+
+    if(fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        printf("[Input]: Failed to write input recording file: %s\n", file_name);
+        fclose(file);
+        return NK_FALSE;
+    }
+
+    memset(&g_input_recording.last_frame, 0, sizeof(g_input_recording.last_frame));
+
+    g_input_recording.file  = file;
+    g_input_recording.seed  = seed;
+    g_input_recording.ticks = 0;
+
+    rng_seed(seed);
+
+    printf("[Input]: Recording input to %s (seed %u)\n", file_name, seed);
+
+    return NK_TRUE;
+}
+
+GLOBAL void stop_input_recording(void)
+{
+    if(!g_input_recording.file) return;
+
+    // Go back and fill in the final tick count now that we know it.
+    InputRecordingHeader header = NK_ZERO_MEM;
+    header.magic      = INPUT_RECORDING_MAGIC;
+    header.version    = INPUT_RECORDING_VERSION;
+    header.seed       = g_input_recording.seed;
+    header.tick_rate  = get_app_desc()->tick_rate;
+    header.tick_count = g_input_recording.ticks;
+
+    if(fseek(g_input_recording.file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, g_input_recording.file) != 1)
+    {
+        printf("[Input]: Failed to finalize input recording, the tick count will be missing!\n");
+    }
+
+    fclose(g_input_recording.file);
+    g_input_recording.file = NULL;
+
+    printf("[Input]: Recorded %u ticks of input!\n", g_input_recording.ticks);
+}
+
+GLOBAL nkBool start_input_replay(const nkChar* file_name)
+{
+    NK_ASSERT(file_name);
+
+    stop_input_recording();
+    stop_input_replay();
+
+    nkFileContent file_content;
+    if(!nk_read_file_content(&file_content, file_name, nkFileReadMode_Binary))
+    {
+        printf("[Input]: Failed to read input recording file: %s\n", file_name);
+        return NK_FALSE;
+    }
+
+    g_input_recording.replay        = file_content;
+    g_input_recording.replay_cursor = NK_CAST(nkU8*, file_content.data);
+
+    InputRecordingHeader header = NK_ZERO_MEM;
+    nkBool valid = read_input_bytes(&header, sizeof(header));
+    valid = valid && (header.magic == INPUT_RECORDING_MAGIC && header.version == INPUT_RECORDING_VERSION);
+    if(!valid)
+    {
+        printf("[Input]: Input recording file is invalid or out of date: %s\n", file_name);
+        nk_free_file_content(&g_input_recording.replay);
+        g_input_recording.replay_cursor = NULL;
+        return NK_FALSE;
+    }
+
+    // A different tick rate means a different dt each tick, so the replay won't play out the same.
+    if(header.tick_rate != get_app_desc()->tick_rate)
+    {
+        printf("[Input]: Input recording was made at %g ticks per second not %g, the replay will not match!\n",
+            header.tick_rate, get_app_desc()->tick_rate);
+    }
+
+    // Start from a clean slate so nothing held down live leaks into the replay.
+    memset(&g_input_recording.last_frame, 0, sizeof(g_input_recording.last_frame));
+    memset(g_input.curr_key_state, 0, sizeof(g_input.curr_key_state));
+    memset(g_input.curr_mouse_state, 0, sizeof(g_input.curr_mouse_state));
+    memset(g_input.curr_pad_state, 0, sizeof(g_input.curr_pad_state));
+    memset(g_input.curr_axis_state, 0, sizeof(g_input.curr_axis_state));
+
+    g_input_recording.seed      = header.seed;
+    g_input_recording.ticks     = 0;
+    g_input_recording.replaying = NK_TRUE;
+
+    rng_seed(header.seed);
+
+    printf("[Input]: Replaying input from %s (%u ticks, seed %u)\n", file_name, header.tick_count, header.seed);
+
+    return NK_TRUE;
+}
+
+GLOBAL void stop_input_replay(void)
+{
+    if(!g_input_recording.replay.data) return;
+
+    nk_free_file_content(&g_input_recording.replay);
+
+    g_input_recording.replay_cursor = NULL;
+    g_input_recording.replaying = NK_FALSE;
+}
+
+GLOBAL nkBool is_input_recording(void)
+{
+    return (g_input_recording.file != NULL);
+}
+
+GLOBAL nkBool is_input_replaying(void)
+{
+    return g_input_recording.replaying;
+}
+
 //
 // Text Input
 //
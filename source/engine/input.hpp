@@ -64,6 +64,19 @@ GLOBAL void process_input_events(void* event);
 GLOBAL void update_input_state  (void);
 GLOBAL void reset_input_state   (void);
 
+// Recording/Replay
+//
+// Recordings store the input state for every tick (only what changed since the
+// previous tick) along with the seed the RNG was started with. Because ticks
+// use a fixed timestep, replaying a recording plays out the exact same session
+// which makes it useful for reproducing bugs and for repeatable benchmarks.
+GLOBAL nkBool start_input_recording(const nkChar* file_name, nkU32 seed); // Seeds the RNG with the given seed.
+GLOBAL void   stop_input_recording (void);
+GLOBAL nkBool start_input_replay   (const nkChar* file_name); // Seeds the RNG with the recorded seed.
+GLOBAL void   stop_input_replay    (void);
+GLOBAL nkBool is_input_recording   (void);
+GLOBAL nkBool is_input_replaying   (void); // Goes false once the last recorded tick has been replayed.
+
 // Text Input
 GLOBAL nkChar* get_current_text_input(void);
 
@@ -0,0 +1,441 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+INTERNAL constexpr nkS32 MAX_JOB_THREADS = 32;
+INTERNAL constexpr nkU32 JOB_QUEUE_SIZE  = 1024; // Per thread, if a queue fills up jobs just get run straight away.
+
+NK_ENUM(JobResult, nkS32)
+{
+    JobResult_None,    // There was nothing to run.
+    JobResult_Ran,
+    JobResult_Blocked, // Only found a job that is still waiting on a counter, it gets put back.
+    JobResult_TOTAL
+};
+
+DEFINE_PRIVATE_TYPE(JobCounter)
+{
+    SDL_atomic_t value;
+};
+
+struct Job
+{
+    JobFunction function;
+    void*       user_data;
+    JobCounter  counter;
+    JobCounter  wait_on;
+};
+
+// The owning thread pushes and pops at the bottom so it works on the newest job,
+// other threads steal from the top where the oldest (and usually largest) are.
+struct JobQueue
+{
+    SDL_SpinLock lock;
+    Job          jobs[JOB_QUEUE_SIZE];
+    nkU32        top;
+    nkU32        bottom;
+};
+
+struct JobSystem
+{
+    JobQueue     queues[MAX_JOB_THREADS];
+    SDL_Thread*  threads[MAX_JOB_THREADS];
+    nkS32        thread_count; // Includes the main thread.
+    SDL_sem*     semaphore;    // Counts queued jobs so idle workers can sleep.
+    SDL_TLSID    thread_index;
+    SDL_threadID main_thread_id;
+    SDL_mutex*   main_lock;
+    nkArray<Job> main_jobs;
+    SDL_atomic_t quit;
+};
+
+INTERNAL JobSystem g_jobs;
+
+INTERNAL nkBool push_job(JobQueue* queue, const Job& job)
+{
+    SDL_AtomicLock(&queue->lock);
+    nkBool pushed = ((queue->bottom - queue->top) < JOB_QUEUE_SIZE);
+    if(pushed)
+    {
+        queue->jobs[queue->bottom % JOB_QUEUE_SIZE] = job;
+        queue->bottom++;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return pushed;
+}
+
+INTERNAL nkBool push_job_front(JobQueue* queue, const Job& job)
+{
+    SDL_AtomicLock(&queue->lock);
+    nkBool pushed = ((queue->bottom - queue->top) < JOB_QUEUE_SIZE);
+    if(pushed)
+    {
+        queue->top--;
+        queue->jobs[queue->top % JOB_QUEUE_SIZE] = job;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return pushed;
+}
+
+INTERNAL nkBool pop_job(JobQueue* queue, Job* job)
+{
+    SDL_AtomicLock(&queue->lock);
+    nkBool popped = (queue->bottom != queue->top);
+    if(popped)
+    {
+        queue->bottom--;
+        *job = queue->jobs[queue->bottom % JOB_QUEUE_SIZE];
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return popped;
+}
+
+INTERNAL nkBool steal_job(JobQueue* queue, Job* job)
+{
+    SDL_AtomicLock(&queue->lock);
+    nkBool stolen = (queue->bottom != queue->top);
+    if(stolen)
+    {
+        *job = queue->jobs[queue->top % JOB_QUEUE_SIZE];
+        queue->top++;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+    return stolen;
+}
+
+INTERNAL nkBool is_job_ready(const Job& job)
+{
+    return (!job.wait_on || SDL_AtomicGet(&job.wait_on->value) <= 0);
+}
+
+INTERNAL void execute_job(const Job& job)
+{
+    job.function(job.user_data);
+    if(job.counter) SDL_AtomicAdd(&job.counter->value, -1);
+}
+
+INTERNAL nkBool is_main_thread(void)
+{
+    return (SDL_ThreadID() == g_jobs.main_thread_id);
+}
+
+INTERNAL JobResult try_run_job(nkS32 index)
+{
+    Job job;
+
+    nkBool found = pop_job(&g_jobs.queues[index], &job);
+    for(nkS32 i=1; !found && i<g_jobs.thread_count; ++i)
+    {
+        found = steal_job(&g_jobs.queues[(index+i) % g_jobs.thread_count], &job);
+    }
+
+    if(!found) return JobResult_None;
+
+    // Blocked jobs go to the front of the queue so the jobs they are waiting on get popped before them.
+    if(!is_job_ready(job))
+    {
+        if(!push_job_front(&g_jobs.queues[index], job))
+        {
+            push_job(&g_jobs.queues[index], job);
+        }
+        if(g_jobs.semaphore) SDL_SemPost(g_jobs.semaphore);
+        return JobResult_Blocked;
+    }
+
+    execute_job(job);
+
+    return JobResult_Ran;
+}
+
+INTERNAL nkBool try_run_main_thread_job(void)
+{
+    Job job;
+    nkBool found = NK_FALSE;
+
+    SDL_LockMutex(g_jobs.main_lock);
+    for(nkU64 i=0; i<g_jobs.main_jobs.length; ++i)
+    {
+        if(is_job_ready(g_jobs.main_jobs.data[i]))
+        {
+            job = g_jobs.main_jobs.data[i];
+            nk_array_remove(&g_jobs.main_jobs, i);
+            found = NK_TRUE;
+            break;
+        }
+    }
+    SDL_UnlockMutex(g_jobs.main_lock);
+
+    // Run outside of the lock as the job may queue more main thread jobs.
+    if(found) execute_job(job);
+
+    return found;
+}
+
+INTERNAL int job_worker_main(void* user_data)
+{
+    nkS32 index = NK_CAST(nkS32, NK_CAST(intptr_t, user_data));
+
+    SDL_TLSSet(g_jobs.thread_index, user_data, NULL);
+
+    while(!SDL_AtomicGet(&g_jobs.quit))
+    {
+        SDL_SemWait(g_jobs.semaphore);
+
+        // Back off a little if everything left is waiting on something, otherwise we'd just spin.
+        if(try_run_job(index) == JobResult_Blocked)
+        {
+            SDL_Delay(1);
+        }
+    }
+
+    return 0;
+}
+
+GLOBAL void init_job_system(void)
+{
+    printf("[Jobs]: Initializing System\n");
+
+    g_jobs.main_thread_id = SDL_ThreadID();
+    g_jobs.thread_index = SDL_TLSCreate();
+
+    g_jobs.main_lock = SDL_CreateMutex();
+    if(!g_jobs.main_lock)
+    {
+        fatal_error("Failed to create job system mutex: %s", SDL_GetError());
+    }
+
+    #if defined(BUILD_WEB)
+    g_jobs.thread_count = 1;
+    #else
+    g_jobs.thread_count = nk_clamp(SDL_GetCPUCount(), 1, MAX_JOB_THREADS);
+    #endif // BUILD_WEB
+
+    if(g_jobs.thread_count > 1)
+    {
+        g_jobs.semaphore = SDL_CreateSemaphore(0);
+        if(!g_jobs.semaphore)
+        {
+            fatal_error("Failed to create job system semaphore: %s", SDL_GetError());
+        }
+
+        // The main thread is index zero, which is also what the TLS slot returns on threads that never set it.
+        for(nkS32 i=1; i<g_jobs.thread_count; ++i)
+        {
+            g_jobs.threads[i] = SDL_CreateThread(job_worker_main, "Job Worker", NK_CAST(void*, NK_CAST(intptr_t, i)));
+            if(!g_jobs.threads[i])
+            {
+                fatal_error("Failed to create job worker thread: %s", SDL_GetError());
+            }
+        }
+    }
+
+    printf("[Jobs]: Running with %d threads\n", g_jobs.thread_count);
+}
+
+GLOBAL void quit_job_system(void)
+{
+    SDL_AtomicSet(&g_jobs.quit, 1);
+
+    // Anything still queued at this point is just dropped.
+    if(g_jobs.semaphore)
+    {
+        for(nkS32 i=1; i<g_jobs.thread_count; ++i)
+            SDL_SemPost(g_jobs.semaphore);
+        for(nkS32 i=1; i<g_jobs.thread_count; ++i)
+            SDL_WaitThread(g_jobs.threads[i], NULL);
+        SDL_DestroySemaphore(g_jobs.semaphore);
+    }
+
+    nk_array_free(&g_jobs.main_jobs);
+
+    SDL_DestroyMutex(g_jobs.main_lock);
+}
+
+GLOBAL JobCounter create_job_counter(void)
+{
+    JobCounter counter = ALLOCATE_PRIVATE_TYPE(JobCounter);
+    if(!counter) fatal_error("Failed to allocate job counter!");
+    return counter;
+}
+
+GLOBAL void free_job_counter(JobCounter counter)
+{
+    NK_ASSERT(counter);
+    NK_ASSERT(SDL_AtomicGet(&counter->value) == 0); // Jobs are still using the counter!
+    NK_FREE(counter);
+}
+
+GLOBAL nkBool is_job_counter_done(JobCounter counter)
+{
+    NK_ASSERT(counter);
+    return (SDL_AtomicGet(&counter->value) <= 0);
+}
+
+GLOBAL void wait_for_job_counter(JobCounter counter)
+{
+    NK_ASSERT(counter);
+
+    nkS32 index = get_job_thread_index();
+    nkBool main_thread = is_main_thread();
+
+    while(SDL_AtomicGet(&counter->value) > 0)
+    {
+        if(main_thread && try_run_main_thread_job()) continue;
+        if(try_run_job(index) != JobResult_Ran)
+        {
+            SDL_Delay(0);
+        }
+    }
+}
+
+GLOBAL void run_jobs(const JobDesc* jobs, nkS32 count, JobCounter counter)
+{
+    NK_ASSERT(jobs);
+
+    if(count <= 0) return;
+
+    if(counter) SDL_AtomicAdd(&counter->value, count);
+
+    nkS32 index = get_job_thread_index();
+
+    for(nkS32 i=0; i<count; ++i)
+    {
+        const JobDesc& desc = jobs[i];
+
+        NK_ASSERT(desc.function);
+
+        Job job;
+        job.function  = desc.function;
+        job.user_data = desc.user_data;
+        job.counter   = counter;
+        job.wait_on   = desc.wait_on;
+
+        if(desc.main_thread)
+        {
+            SDL_LockMutex(g_jobs.main_lock);
+            nk_array_append(&g_jobs.main_jobs, job);
+            SDL_UnlockMutex(g_jobs.main_lock);
+            continue;
+        }
+
+        // Without any workers there's no point queueing, unless the job has to wait.
+        if(g_jobs.thread_count <= 1 && is_job_ready(job))
+        {
+            execute_job(job);
+            continue;
+        }
+
+        if(push_job(&g_jobs.queues[index], job))
+        {
+            if(g_jobs.semaphore) SDL_SemPost(g_jobs.semaphore);
+        }
+        else
+        {
+            if(job.wait_on) wait_for_job_counter(job.wait_on);
+            execute_job(job);
+        }
+    }
+}
+
+GLOBAL void run_job(JobFunction function, void* user_data, JobCounter counter)
+{
+    JobDesc desc;
+    desc.function = function;
+    desc.user_data = user_data;
+    run_jobs(&desc, 1, counter);
+}
+
+GLOBAL void run_main_thread_job(JobFunction function, void* user_data, JobCounter counter)
+{
+    JobDesc desc;
+    desc.function = function;
+    desc.user_data = user_data;
+    desc.main_thread = NK_TRUE;
+    run_jobs(&desc, 1, counter);
+}
+
+struct ParallelFor
+{
+    JobRangeFunction function;
+    void*            user_data;
+    SDL_atomic_t     next;
+    nkS32            count;
+    nkS32            batch_size;
+};
+
+INTERNAL void parallel_for_job(void* user_data)
+{
+    ParallelFor* pf = NK_CAST(ParallelFor*, user_data);
+    while(NK_TRUE)
+    {
+        nkS32 begin = SDL_AtomicAdd(&pf->next, pf->batch_size);
+        if(begin >= pf->count) break;
+        nkS32 end = nk_min(begin + pf->batch_size, pf->count);
+        pf->function(begin, end, pf->user_data);
+    }
+}
+
+GLOBAL void parallel_for(nkS32 count, nkS32 batch_size, JobRangeFunction function, void* user_data)
+{
+    NK_ASSERT(function);
+
+    if(count <= 0) return;
+
+    ParallelFor pf;
+    pf.function   = function;
+    pf.user_data  = user_data;
+    pf.count      = count;
+    pf.batch_size = nk_max(batch_size, 1);
+    SDL_AtomicSet(&pf.next, 0);
+
+    // Rather than a job per batch there is a job per thread, they all grab batches until none are left. The calling
+    // thread takes part as well so only the remaining threads need a job.
+    nkS32 batch_count = (count + pf.batch_size - 1) / pf.batch_size;
+    nkS32 helper_count = nk_min(batch_count, g_jobs.thread_count) - 1;
+
+    JobCounter__Type counter;
+    SDL_AtomicSet(&counter.value, 0);
+
+    JobDesc helpers[MAX_JOB_THREADS];
+    for(nkS32 i=0; i<helper_count; ++i)
+    {
+        helpers[i].function = parallel_for_job;
+        helpers[i].user_data = &pf;
+    }
+    run_jobs(helpers, helper_count, &counter);
+
+    parallel_for_job(&pf);
+
+    wait_for_job_counter(&counter);
+}
+
+GLOBAL void process_main_thread_jobs(void)
+{
+    NK_ASSERT(is_main_thread());
+
+    // Only run what is already queued, anything these jobs queue up is left for next time.
+    SDL_LockMutex(g_jobs.main_lock);
+    nkU64 count = g_jobs.main_jobs.length;
+    SDL_UnlockMutex(g_jobs.main_lock);
+
+    for(nkU64 i=0; i<count; ++i)
+    {
+        if(!try_run_main_thread_job()) break;
+    }
+
+    // Without any workers the main thread is the only one that can pick up jobs that had to wait.
+    if(g_jobs.thread_count <= 1)
+    {
+        while(try_run_job(0) == JobResult_Ran);
+    }
+}
+
+GLOBAL nkS32 get_job_thread_count(void)
+{
+    return g_jobs.thread_count;
+}
+
+GLOBAL nkS32 get_job_thread_index(void)
+{
+    return NK_CAST(nkS32, NK_CAST(intptr_t, SDL_TLSGet(g_jobs.thread_index)));
+}
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -0,0 +1,44 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+// =============================================================================
+// Jobs are run by a pool of worker threads, one per core (minus the main one).
+// Each worker has its own queue and steals from the others when it runs dry.
+// A counter can be attached to jobs to find out when they have all finished,
+// waiting on a counter runs other jobs in the meantime rather than blocking.
+// Jobs can also be made to wait on a counter before they start, and jobs that
+// touch the GPU or other main thread only state can be flagged to only ever
+// run on the main thread, these are run once per frame before ticking.
+//
+// On web builds there are no worker threads, jobs just run straight away when
+// they are kicked off (or when the main thread gets to them).
+// =============================================================================
+
+GLOBAL void init_job_system(void);
+GLOBAL void quit_job_system(void);
+
+DECLARE_PRIVATE_TYPE(JobCounter);
+
+typedef void(*JobFunction)(void* user_data);
+typedef void(*JobRangeFunction)(nkS32 begin, nkS32 end, void* user_data);
+
+struct JobDesc
+{
+    JobFunction function    = NULL;
+    void*       user_data   = NULL;
+    JobCounter  wait_on     = NULL;      // The job won't start until this counter has reached zero.
+    nkBool      main_thread = NK_FALSE;  // The job will only be run on the main thread.
+};
+
+GLOBAL JobCounter create_job_counter      (void);
+GLOBAL void       free_job_counter        (JobCounter counter);
+GLOBAL nkBool     is_job_counter_done     (JobCounter counter);
+GLOBAL void       wait_for_job_counter    (JobCounter counter); // Helps run jobs until the counter reaches zero.
+GLOBAL void       run_jobs                (const JobDesc* jobs, nkS32 count, JobCounter counter = NULL);
+GLOBAL void       run_job                 (JobFunction function, void* user_data, JobCounter counter = NULL);
+GLOBAL void       run_main_thread_job     (JobFunction function, void* user_data, JobCounter counter = NULL);
+GLOBAL void       parallel_for            (nkS32 count, nkS32 batch_size, JobRangeFunction function, void* user_data); // Blocks until done.
+GLOBAL void       process_main_thread_jobs(void);
+GLOBAL nkS32      get_job_thread_count    (void); // Number of threads that can run jobs, including the main thread.
+GLOBAL nkS32      get_job_thread_index    (void); // Zero on the main thread, or for any thread not owned by the job system.
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -0,0 +1,283 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+INTERNAL constexpr nkU64 FRAME_ARENA_SIZE   = NK_MB_TO_BYTES(4);
+INTERNAL constexpr nkU64 SCRATCH_ARENA_SIZE = NK_MB_TO_BYTES(1);
+
+// The block's memory follows straight after the header.
+struct ArenaBlock
+{
+    ArenaBlock* prev;
+    nkU64       size;
+    nkU64       used;
+};
+
+struct MemorySystem
+{
+    MemoryArena frame;
+    SDL_TLSID   scratch; // Each thread's scratch arena, created the first time the thread asks for it.
+};
+
+INTERNAL MemorySystem g_memory;
+
+// Arena =======================================================================
+
+INTERNAL nkU8* get_arena_block_data(ArenaBlock* block)
+{
+    return NK_CAST(nkU8*, block + 1);
+}
+
+INTERNAL ArenaBlock* allocate_arena_block(nkU64 size, ArenaBlock* prev)
+{
+    ArenaBlock* block = NK_CAST(ArenaBlock*, NK_MALLOC_BYTES(sizeof(ArenaBlock) + size));
+    if(!block) fatal_error("Failed to allocate memory arena block!");
+    block->prev = prev;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+INTERNAL void* arena_allocator_function(void* user, void* ptr, nkU64 old_size, nkU64 new_size)
+{
+    MemoryArena* arena = NK_CAST(MemoryArena*, user);
+
+    // The last allocation can be freed, grown, or shrunk in place as there's nothing after it.
+    if(ptr && ptr == arena->last)
+    {
+        ArenaBlock* block = arena->block;
+        nkU64 offset = NK_CAST(nkU64, NK_CAST(nkU8*, ptr) - get_arena_block_data(block));
+        if(new_size == 0)
+        {
+            block->used = offset;
+            arena->last = NULL;
+            return NULL;
+        }
+        if(offset + new_size <= block->size)
+        {
+            block->used = offset + new_size;
+            return ptr;
+        }
+    }
+
+    if(new_size == 0) return NULL;
+
+    void* result = arena_alloc(arena, new_size);
+    if(ptr) memcpy(result, ptr, nk_min(old_size, new_size));
+    return result;
+}
+
+GLOBAL void create_memory_arena(MemoryArena* arena, nkU64 size)
+{
+    NK_ASSERT(arena);
+    NK_ASSERT(size > 0);
+
+    arena->block              = allocate_arena_block(size, NULL);
+    arena->capacity           = size;
+    arena->last               = NULL;
+    arena->allocator.function = arena_allocator_function;
+    arena->allocator.user     = arena;
+}
+
+GLOBAL void free_memory_arena(MemoryArena* arena)
+{
+    NK_ASSERT(arena);
+
+    while(arena->block)
+    {
+        ArenaBlock* prev = arena->block->prev;
+        NK_FREE(arena->block);
+        arena->block = prev;
+    }
+
+    arena->capacity = 0;
+    arena->last     = NULL;
+}
+
+GLOBAL void* arena_alloc(MemoryArena* arena, nkU64 size, nkU64 align)
+{
+    NK_ASSERT(arena && arena->block);
+    NK_ASSERT(align > 0 && (align & (align-1)) == 0); // Must be a power of two.
+
+    ArenaBlock* block = arena->block;
+
+    uintptr_t base  = NK_CAST(uintptr_t, get_arena_block_data(block));
+    uintptr_t start = (base + block->used + (align-1)) & ~NK_CAST(uintptr_t, align-1);
+
+    // Carry on in a new block that's at least as big as all the others together, so
+    // if we keep running out the arena grows quickly rather than a bit at a time.
+    if(start + size > base + block->size)
+    {
+        nkU64 block_size = nk_max(arena->capacity, size + align);
+        block = allocate_arena_block(block_size, block);
+        arena->block = block;
+        arena->capacity += block_size;
+
+        base  = NK_CAST(uintptr_t, get_arena_block_data(block));
+        start = (base + (align-1)) & ~NK_CAST(uintptr_t, align-1);
+    }
+
+    block->used = NK_CAST(nkU64, (start + size) - base);
+    arena->last = NK_CAST(void*, start);
+
+    return arena->last;
+}
+
+GLOBAL ArenaMark get_arena_mark(MemoryArena* arena)
+{
+    NK_ASSERT(arena && arena->block);
+
+    ArenaMark mark;
+    mark.block = arena->block;
+    mark.used  = arena->block->used;
+    return mark;
+}
+
+GLOBAL void restore_arena_mark(MemoryArena* arena, ArenaMark mark)
+{
+    NK_ASSERT(arena && arena->block);
+    NK_ASSERT(mark.block);
+
+    // If the arena is now empty and had to grow then swap all of its blocks for one that fits everything.
+    if(!mark.block->prev && mark.used == 0 && arena->block->prev)
+    {
+        nkU64 capacity = arena->capacity;
+        free_memory_arena(arena);
+        arena->block    = allocate_arena_block(capacity, NULL);
+        arena->capacity = capacity;
+        return;
+    }
+
+    while(arena->block != mark.block)
+    {
+        ArenaBlock* block = arena->block;
+        NK_ASSERT(block->prev); // The mark isn't from this arena, or it's already been restored past!
+        arena->block = block->prev;
+        arena->capacity -= block->size;
+        NK_FREE(block);
+    }
+
+    NK_ASSERT(mark.used <= arena->block->used);
+
+    arena->block->used = mark.used;
+    arena->last = NULL;
+}
+
+GLOBAL void reset_arena(MemoryArena* arena)
+{
+    NK_ASSERT(arena && arena->block);
+
+    ArenaBlock* first = arena->block;
+    while(first->prev)
+        first = first->prev;
+
+    ArenaMark mark;
+    mark.block = first;
+    mark.used  = 0;
+    restore_arena_mark(arena, mark);
+}
+
+GLOBAL nkU64 get_arena_used(MemoryArena* arena)
+{
+    NK_ASSERT(arena);
+
+    nkU64 used = 0;
+    for(ArenaBlock* block=arena->block; block; block=block->prev)
+        used += block->used;
+    return used;
+}
+
+// =============================================================================
+
+// Frame =======================================================================
+
+GLOBAL MemoryArena* get_frame_arena(void)
+{
+    return &g_memory.frame;
+}
+
+GLOBAL void reset_frame_arena(void)
+{
+    reset_arena(&g_memory.frame);
+}
+
+GLOBAL void* frame_alloc(nkU64 size, nkU64 align)
+{
+    return arena_alloc(&g_memory.frame, size, align);
+}
+
+GLOBAL const nkChar* frame_format_string(const nkChar* fmt, ...)
+{
+    va_list args0;
+    va_list args1;
+
+    va_start(args0, fmt);
+    va_copy(args1, args0);
+
+    nkS32 length = vsnprintf(NULL, 0, fmt, args0);
+
+    nkChar* str = frame_alloc_types<nkChar>(length+1);
+    vsnprintf(str, length+1, fmt, args1);
+
+    va_end(args1);
+    va_end(args0);
+
+    return str;
+}
+
+// =============================================================================
+
+// Scratch =====================================================================
+
+INTERNAL void free_scratch_arena(void* data)
+{
+    MemoryArena* arena = NK_CAST(MemoryArena*, data);
+    free_memory_arena(arena);
+    NK_FREE(arena);
+}
+
+GLOBAL Scratch begin_scratch(void)
+{
+    MemoryArena* arena = NK_CAST(MemoryArena*, SDL_TLSGet(g_memory.scratch));
+    if(!arena)
+    {
+        arena = NK_CALLOC_TYPES(MemoryArena, 1);
+        if(!arena) fatal_error("Failed to allocate scratch arena!");
+        create_memory_arena(arena, SCRATCH_ARENA_SIZE);
+        SDL_TLSSet(g_memory.scratch, arena, free_scratch_arena); // Freed when the thread exits.
+    }
+
+    Scratch scratch;
+    scratch.arena = arena;
+    scratch.mark  = get_arena_mark(arena);
+    return scratch;
+}
+
+GLOBAL void end_scratch(Scratch scratch)
+{
+    restore_arena_mark(scratch.arena, scratch.mark);
+}
+
+// =============================================================================
+
+GLOBAL void init_memory_system(void)
+{
+    create_memory_arena(&g_memory.frame, FRAME_ARENA_SIZE);
+
+    g_memory.scratch = SDL_TLSCreate();
+    if(!g_memory.scratch)
+        fatal_error("Failed to create scratch arena thread local storage: %s", SDL_GetError());
+}
+
+GLOBAL void quit_memory_system(void)
+{
+    // Other threads free their scratch arenas when they exit, but the main thread is still going.
+    MemoryArena* arena = NK_CAST(MemoryArena*, SDL_TLSGet(g_memory.scratch));
+    if(arena)
+    {
+        SDL_TLSSet(g_memory.scratch, NULL, NULL);
+        free_scratch_arena(arena);
+    }
+
+    free_memory_arena(&g_memory.frame);
+}
+
+/*////////////////////////////////////////////////////////////////////////////*/
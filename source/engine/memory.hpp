@@ -0,0 +1,79 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+// =============================================================================
+// Arenas for memory that only needs to live for a short while. Allocating from
+// an arena is just bumping an offset and everything gets freed at once, either
+// by resetting the arena or by restoring it to a mark taken earlier.
+//
+// Two arenas are provided by the engine:
+//
+//  - Frame: Reset at the start of every frame, for anything that only needs to
+//    last until the frame is drawn. Only use it from the main thread.
+//  - Scratch: One per thread, for temporary memory used within a function. Take
+//    a mark with begin_scratch and give it back with end_scratch, these nest so
+//    functions using scratch memory can call other functions that use it too.
+//
+// If an arena runs out of space it carries on in an extra block allocated from
+// the heap, then once it's back to being empty it's replaced by a single block
+// big enough for everything. So after the first few frames of anything new the
+// arenas stop allocating altogether.
+//
+// Each arena also has an nkAllocator so nk containers can be put in the arena.
+// Freeing from an arena only gives memory back if it was the last allocation,
+// anything else is reclaimed when the arena is reset or restored.
+// =============================================================================
+
+struct ArenaBlock;
+
+struct MemoryArena
+{
+    ArenaBlock* block;     // The newest block, allocations come from here.
+    nkU64       capacity;  // Total size of all the blocks.
+    void*       last;      // Most recent allocation, can be grown or freed in place.
+    nkAllocator allocator; // Allocates from the arena, for use with nk containers.
+};
+
+struct ArenaMark
+{
+    ArenaBlock* block;
+    nkU64       used;
+};
+
+struct Scratch
+{
+    MemoryArena* arena;
+    ArenaMark    mark;
+};
+
+GLOBAL void init_memory_system(void);
+GLOBAL void quit_memory_system(void);
+
+GLOBAL void      create_memory_arena(MemoryArena* arena, nkU64 size);
+GLOBAL void      free_memory_arena  (MemoryArena* arena);
+GLOBAL void*     arena_alloc        (MemoryArena* arena, nkU64 size, nkU64 align = 16); // Memory is not zeroed.
+GLOBAL ArenaMark get_arena_mark     (MemoryArena* arena);
+GLOBAL void      restore_arena_mark (MemoryArena* arena, ArenaMark mark); // Frees everything allocated since the mark.
+GLOBAL void      reset_arena        (MemoryArena* arena);
+GLOBAL nkU64     get_arena_used     (MemoryArena* arena);
+
+template<typename T>
+GLOBAL T* arena_alloc_types(MemoryArena* arena, nkU64 count)
+{
+    return NK_CAST(T*, arena_alloc(arena, count * sizeof(T), alignof(T)));
+}
+
+GLOBAL MemoryArena*  get_frame_arena    (void);
+GLOBAL void          reset_frame_arena  (void); // Called by the engine at the start of each frame.
+GLOBAL void*         frame_alloc        (nkU64 size, nkU64 align = 16);
+GLOBAL const nkChar* frame_format_string(const nkChar* fmt, ...); // Like format_string but the result lives until the end of the frame.
+
+template<typename T>
+GLOBAL T* frame_alloc_types(nkU64 count)
+{
+    return NK_CAST(T*, frame_alloc(count * sizeof(T), alignof(T)));
+}
+
+GLOBAL Scratch begin_scratch(void); // Uses the calling thread's scratch arena.
+GLOBAL void    end_scratch  (Scratch scratch);
+
+/*////////////////////////////////////////////////////////////////////////////*/
@@ -500,4 +500,1024 @@ GLOBAL nkF32 periodic_perlin_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkS32
     return (0.87f * (nk_lerp(n0, n1, s)));
 }
 
+// =============================================================================
+// Batch versions of the noise functions. Points are processed a whole SIMD
+// register at a time (8 lanes for AVX2, 4 for SSE2 and Wasm SIMD), with the
+// permutation lookups done as gathers. Every operation is done in exactly the
+// same order as the scalar functions above so the results are bit-identical,
+// any points left over at the end just go through the scalar functions.
+//
+// The instruction set is picked at compile time, so AVX2 is only used if the
+// build enables it (-mavx2 or /arch:AVX2) and Wasm SIMD needs -msimd128. FMA
+// must not be enabled as fused multiply-adds would change the rounding.
+// =============================================================================
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NOISE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define NOISE_SIMD_SSE2
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define NOISE_SIMD_WASM
+#endif
+
+#if defined(NOISE_SIMD_AVX2) || defined(NOISE_SIMD_SSE2) || defined(NOISE_SIMD_WASM)
+#define NOISE_SIMD
+#endif
+
+#if defined(NOISE_SIMD)
+
+// The permutation table widened to 32-bit so it can be gathered from directly.
+struct NoisePermTable
+{
+    nkS32 v[NK_ARRAY_SIZE(PERM)];
+
+    constexpr NoisePermTable(void): v()
+    {
+        for(nkU64 i=0; i<NK_ARRAY_SIZE(PERM); ++i)
+            v[i] = PERM[i];
+    }
+};
+
+INTERNAL constexpr NoisePermTable PERM32;
+
+#if defined(NOISE_SIMD_AVX2)
+
+INTERNAL constexpr nkS32 NOISE_LANES = 8;
+
+typedef __m256  NoiseLanes;
+typedef __m256i NoiseLanesInt;
+
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_load  (const nkF32* p)                                   { return _mm256_loadu_ps(p);                      }
+INTERNAL NKFORCEINLINE void          lanes_store (nkF32* p, NoiseLanes a)                           { _mm256_storeu_ps(p, a);                         }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_set   (nkF32 a)                                          { return _mm256_set1_ps(a);                       }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_add   (NoiseLanes a, NoiseLanes b)                       { return _mm256_add_ps(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_sub   (NoiseLanes a, NoiseLanes b)                       { return _mm256_sub_ps(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_mul   (NoiseLanes a, NoiseLanes b)                       { return _mm256_mul_ps(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_neg   (NoiseLanes a)                                     { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_lt    (NoiseLanes a, NoiseLanes b)                       { return _mm256_cmp_ps(a, b, _CMP_LT_OQ);         }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_select(NoiseLanesInt m, NoiseLanes a, NoiseLanes b)      { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(m)); }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_seti  (nkS32 a)                                          { return _mm256_set1_epi32(a);                    }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_addi  (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm256_add_epi32(a, b);                  }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_andi  (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm256_and_si256(a, b);                  }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_ori   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm256_or_si256(a, b);                   }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_lti   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm256_cmpgt_epi32(b, a);                }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_eqi   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm256_cmpeq_epi32(a, b);                }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_selecti(NoiseLanes m, NoiseLanesInt a, NoiseLanesInt b)  { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m)); }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_trunc (NoiseLanes a)                                     { return _mm256_cvttps_epi32(a);                  }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_itof  (NoiseLanesInt a)                                  { return _mm256_cvtepi32_ps(a);                   }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_perm  (NoiseLanesInt i)                                  { return _mm256_i32gather_epi32(NK_CAST(const int*, PERM32.v), i, 4); }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_iota  (void)                                             { return _mm256_setr_ps(0,1,2,3,4,5,6,7);         }
+
+#elif defined(NOISE_SIMD_SSE2)
+
+INTERNAL constexpr nkS32 NOISE_LANES = 4;
+
+typedef __m128  NoiseLanes;
+typedef __m128i NoiseLanesInt;
+
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_load  (const nkF32* p)                                   { return _mm_loadu_ps(p);                         }
+INTERNAL NKFORCEINLINE void          lanes_store (nkF32* p, NoiseLanes a)                           { _mm_storeu_ps(p, a);                            }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_set   (nkF32 a)                                          { return _mm_set1_ps(a);                          }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_add   (NoiseLanes a, NoiseLanes b)                       { return _mm_add_ps(a, b);                        }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_sub   (NoiseLanes a, NoiseLanes b)                       { return _mm_sub_ps(a, b);                        }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_mul   (NoiseLanes a, NoiseLanes b)                       { return _mm_mul_ps(a, b);                        }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_neg   (NoiseLanes a)                                     { return _mm_xor_ps(a, _mm_set1_ps(-0.0f));       }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_lt    (NoiseLanes a, NoiseLanes b)                       { return _mm_cmplt_ps(a, b);                      }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_select(NoiseLanesInt m, NoiseLanes a, NoiseLanes b)      { NoiseLanes f = _mm_castsi128_ps(m); return _mm_or_ps(_mm_and_ps(f, a), _mm_andnot_ps(f, b)); }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_seti  (nkS32 a)                                          { return _mm_set1_epi32(a);                       }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_addi  (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm_add_epi32(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_andi  (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm_and_si128(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_ori   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm_or_si128(a, b);                      }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_lti   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm_cmplt_epi32(a, b);                   }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_eqi   (NoiseLanesInt a, NoiseLanesInt b)                 { return _mm_cmpeq_epi32(a, b);                   }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_selecti(NoiseLanes m, NoiseLanesInt a, NoiseLanesInt b)  { NoiseLanesInt i = _mm_castps_si128(m); return _mm_or_si128(_mm_and_si128(i, a), _mm_andnot_si128(i, b)); }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_trunc (NoiseLanes a)                                     { return _mm_cvttps_epi32(a);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_itof  (NoiseLanesInt a)                                  { return _mm_cvtepi32_ps(a);                      }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_iota  (void)                                             { return _mm_setr_ps(0,1,2,3);                    }
+
+// SSE2 has no gather instruction so the lookups are done one lane at a time.
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_perm(NoiseLanesInt i)
+{
+    alignas(16) nkS32 idx[4];
+    _mm_store_si128(NK_CAST(__m128i*, idx), i);
+    return _mm_setr_epi32(PERM32.v[idx[0]], PERM32.v[idx[1]], PERM32.v[idx[2]], PERM32.v[idx[3]]);
+}
+
+#elif defined(NOISE_SIMD_WASM)
+
+INTERNAL constexpr nkS32 NOISE_LANES = 4;
+
+typedef v128_t NoiseLanes;
+typedef v128_t NoiseLanesInt;
+
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_load  (const nkF32* p)                                   { return wasm_v128_load(p);                       }
+INTERNAL NKFORCEINLINE void          lanes_store (nkF32* p, NoiseLanes a)                           { wasm_v128_store(p, a);                          }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_set   (nkF32 a)                                          { return wasm_f32x4_splat(a);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_add   (NoiseLanes a, NoiseLanes b)                       { return wasm_f32x4_add(a, b);                    }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_sub   (NoiseLanes a, NoiseLanes b)                       { return wasm_f32x4_sub(a, b);                    }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_mul   (NoiseLanes a, NoiseLanes b)                       { return wasm_f32x4_mul(a, b);                    }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_neg   (NoiseLanes a)                                     { return wasm_f32x4_neg(a);                       }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_lt    (NoiseLanes a, NoiseLanes b)                       { return wasm_f32x4_lt(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_select(NoiseLanesInt m, NoiseLanes a, NoiseLanes b)      { return wasm_v128_bitselect(a, b, m);            }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_seti  (nkS32 a)                                          { return wasm_i32x4_splat(a);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_addi  (NoiseLanesInt a, NoiseLanesInt b)                 { return wasm_i32x4_add(a, b);                    }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_andi  (NoiseLanesInt a, NoiseLanesInt b)                 { return wasm_v128_and(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_ori   (NoiseLanesInt a, NoiseLanesInt b)                 { return wasm_v128_or(a, b);                      }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_lti   (NoiseLanesInt a, NoiseLanesInt b)                 { return wasm_i32x4_lt(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_eqi   (NoiseLanesInt a, NoiseLanesInt b)                 { return wasm_i32x4_eq(a, b);                     }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_selecti(NoiseLanes m, NoiseLanesInt a, NoiseLanesInt b)  { return wasm_v128_bitselect(a, b, m);            }
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_trunc (NoiseLanes a)                                     { return wasm_i32x4_trunc_sat_f32x4(a);           }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_itof  (NoiseLanesInt a)                                  { return wasm_f32x4_convert_i32x4(a);             }
+INTERNAL NKFORCEINLINE NoiseLanes    lanes_iota  (void)                                             { return wasm_f32x4_make(0,1,2,3);                }
+
+// Wasm SIMD has no gather instruction so the lookups are done one lane at a time.
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_perm(NoiseLanesInt i)
+{
+    return wasm_i32x4_make(PERM32.v[wasm_i32x4_extract_lane(i,0)], PERM32.v[wasm_i32x4_extract_lane(i,1)],
+                           PERM32.v[wasm_i32x4_extract_lane(i,2)], PERM32.v[wasm_i32x4_extract_lane(i,3)]);
+}
+
+#endif
+
+// Lane versions of the scalar helpers, see above for what each one is doing.
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_fade(NoiseLanes t)
+{
+    NoiseLanes a = lanes_mul(lanes_mul(t, t), t);
+    NoiseLanes b = lanes_add(lanes_mul(t, lanes_sub(lanes_mul(t, lanes_set(6.0f)), lanes_set(15.0f))), lanes_set(10.0f));
+    return lanes_mul(a, b);
+}
+
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_fast_floor(NoiseLanes x)
+{
+    NoiseLanesInt i = lanes_trunc(x);
+    return lanes_selecti(lanes_lt(lanes_itof(i), x), i, lanes_addi(i, lanes_seti(-1)));
+}
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_lerp(NoiseLanes a, NoiseLanes b, NoiseLanes t)
+{
+    return lanes_add(a, lanes_mul(t, lanes_sub(b, a)));
+}
+
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_bit(NoiseLanesInt h, nkS32 bit)
+{
+    return lanes_eqi(lanes_andi(h, lanes_seti(bit)), lanes_seti(bit));
+}
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_signed(NoiseLanesInt h, nkS32 bit, NoiseLanes a)
+{
+    return lanes_select(lanes_bit(h, bit), lanes_neg(a), a);
+}
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_grad2(NoiseLanesInt hash, NoiseLanes x, NoiseLanes y)
+{
+    NoiseLanesInt h = lanes_andi(hash, lanes_seti(7));
+    NoiseLanesInt m = lanes_lti(h, lanes_seti(4));
+    NoiseLanes u = lanes_select(m, x, y);
+    NoiseLanes v = lanes_select(m, y, x);
+    return lanes_add(lanes_signed(h, 1, u), lanes_signed(h, 2, lanes_mul(lanes_set(2.0f), v)));
+}
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_grad3(NoiseLanesInt hash, NoiseLanes x, NoiseLanes y, NoiseLanes z)
+{
+    NoiseLanesInt h = lanes_andi(hash, lanes_seti(15));
+    NoiseLanesInt m = lanes_ori(lanes_eqi(h, lanes_seti(12)), lanes_eqi(h, lanes_seti(14)));
+    NoiseLanes u = lanes_select(lanes_lti(h, lanes_seti(8)), x, y);
+    NoiseLanes v = lanes_select(lanes_lti(h, lanes_seti(4)), y, lanes_select(m, x, z));
+    return lanes_add(lanes_signed(h, 1, u), lanes_signed(h, 2, v));
+}
+
+INTERNAL NKFORCEINLINE NoiseLanes lanes_grad4(NoiseLanesInt hash, NoiseLanes x, NoiseLanes y, NoiseLanes z, NoiseLanes t)
+{
+    NoiseLanesInt h = lanes_andi(hash, lanes_seti(31));
+    NoiseLanes u = lanes_select(lanes_lti(h, lanes_seti(24)), x, y);
+    NoiseLanes v = lanes_select(lanes_lti(h, lanes_seti(16)), y, z);
+    NoiseLanes w = lanes_select(lanes_lti(h, lanes_seti( 8)), z, t);
+    return lanes_add(lanes_add(lanes_signed(h, 1, u), lanes_signed(h, 2, v)), lanes_signed(h, 4, w));
+}
+
+// Splits a coordinate into its wrapped integer cell and the fractional offsets from both sides of the cell.
+struct NoiseLanesCell
+{
+    NoiseLanesInt i0, i1;
+    NoiseLanes    f0, f1;
+};
+
+INTERNAL NKFORCEINLINE NoiseLanesCell lanes_cell(NoiseLanes x)
+{
+    NoiseLanesCell c;
+    NoiseLanesInt i = lanes_fast_floor(x);
+    c.f0 = lanes_sub(x, lanes_itof(i));
+    c.f1 = lanes_sub(c.f0, lanes_set(1.0f));
+    c.i1 = lanes_andi(lanes_addi(i, lanes_seti(1)), lanes_seti(0xFF));
+    c.i0 = lanes_andi(i, lanes_seti(0xFF));
+    return c;
+}
+
+INTERNAL NKFORCEINLINE NoiseLanesInt lanes_hash(NoiseLanesInt a, NoiseLanesInt b)
+{
+    return lanes_perm(lanes_addi(a, b));
+}
+
+// Periodic version of lanes_cell for coordinates within [0,p), which the tileable grids guarantee. Over that range the
+// wrap only ever has to bring i+1 back from p to 0, so it's done with a compare rather than a modulo per lane.
+INTERNAL NKFORCEINLINE NoiseLanesCell lanes_periodic_cell(NoiseLanes x, nkS32 p)
+{
+    NoiseLanesCell c;
+    NoiseLanesInt i = lanes_fast_floor(x);
+    NoiseLanesInt j = lanes_addi(i, lanes_seti(1));
+    c.f0 = lanes_sub(x, lanes_itof(i));
+    c.f1 = lanes_sub(c.f0, lanes_set(1.0f));
+    c.i1 = lanes_andi(lanes_addi(j, lanes_andi(lanes_eqi(j, lanes_seti(p)), lanes_seti(-p))), lanes_seti(0xFF));
+    c.i0 = lanes_andi(i, lanes_seti(0xFF));
+    return c;
+}
+
+INTERNAL NoiseLanes lanes_perlin_noise_2d(const NoiseLanesCell& cx, const NoiseLanesCell& cy)
+{
+    NoiseLanes t = lanes_fade(cy.f0);
+    NoiseLanes s = lanes_fade(cx.f0);
+
+    NoiseLanesInt py0 = lanes_perm(cy.i0);
+    NoiseLanesInt py1 = lanes_perm(cy.i1);
+
+    NoiseLanes nx0, nx1, n0, n1;
+
+    nx0 = lanes_grad2(lanes_hash(cx.i0, py0), cx.f0, cy.f0);
+    nx1 = lanes_grad2(lanes_hash(cx.i0, py1), cx.f0, cy.f1);
+
+    n0 = lanes_lerp(nx0, nx1, t);
+
+    nx0 = lanes_grad2(lanes_hash(cx.i1, py0), cx.f1, cy.f0);
+    nx1 = lanes_grad2(lanes_hash(cx.i1, py1), cx.f1, cy.f1);
+
+    n1 = lanes_lerp(nx0, nx1, t);
+
+    return lanes_mul(lanes_set(0.507f), lanes_lerp(n0, n1, s));
+}
+
+INTERNAL NoiseLanes lanes_perlin_noise_2d(NoiseLanes x, NoiseLanes y)
+{
+    return lanes_perlin_noise_2d(lanes_cell(x), lanes_cell(y));
+}
+
+INTERNAL NoiseLanes lanes_perlin_noise_3d(NoiseLanes x, NoiseLanes y, NoiseLanes z)
+{
+    NoiseLanesCell cx = lanes_cell(x);
+    NoiseLanesCell cy = lanes_cell(y);
+    NoiseLanesCell cz = lanes_cell(z);
+
+    NoiseLanes r = lanes_fade(cz.f0);
+    NoiseLanes t = lanes_fade(cy.f0);
+    NoiseLanes s = lanes_fade(cx.f0);
+
+    NoiseLanesInt pz0 = lanes_perm(cz.i0);
+    NoiseLanesInt pz1 = lanes_perm(cz.i1);
+
+    NoiseLanesInt pyz[4];
+    pyz[0] = lanes_hash(cy.i0, pz0);
+    pyz[1] = lanes_hash(cy.i0, pz1);
+    pyz[2] = lanes_hash(cy.i1, pz0);
+    pyz[3] = lanes_hash(cy.i1, pz1);
+
+    NoiseLanes n[2];
+    for(nkS32 ix=0; ix<2; ++ix)
+    {
+        NoiseLanesInt i  = (ix == 0) ? cx.i0 : cx.i1;
+        NoiseLanes    fx = (ix == 0) ? cx.f0 : cx.f1;
+
+        NoiseLanes nxy0, nxy1, nx0, nx1;
+
+        nxy0 = lanes_grad3(lanes_hash(i, pyz[0]), fx, cy.f0, cz.f0);
+        nxy1 = lanes_grad3(lanes_hash(i, pyz[1]), fx, cy.f0, cz.f1);
+
+        nx0 = lanes_lerp(nxy0, nxy1, r);
+
+        nxy0 = lanes_grad3(lanes_hash(i, pyz[2]), fx, cy.f1, cz.f0);
+        nxy1 = lanes_grad3(lanes_hash(i, pyz[3]), fx, cy.f1, cz.f1);
+
+        nx1 = lanes_lerp(nxy0, nxy1, r);
+
+        n[ix] = lanes_lerp(nx0, nx1, t);
+    }
+
+    return lanes_mul(lanes_set(0.936f), lanes_lerp(n[0], n[1], s));
+}
+
+INTERNAL NoiseLanes lanes_perlin_noise_4d(NoiseLanes x, NoiseLanes y, NoiseLanes z, NoiseLanes w)
+{
+    NoiseLanesCell cx = lanes_cell(x);
+    NoiseLanesCell cy = lanes_cell(y);
+    NoiseLanesCell cz = lanes_cell(z);
+    NoiseLanesCell cw = lanes_cell(w);
+
+    NoiseLanes q = lanes_fade(cw.f0);
+    NoiseLanes r = lanes_fade(cz.f0);
+    NoiseLanes t = lanes_fade(cy.f0);
+    NoiseLanes s = lanes_fade(cx.f0);
+
+    NoiseLanesInt pw0 = lanes_perm(cw.i0);
+    NoiseLanesInt pw1 = lanes_perm(cw.i1);
+
+    // Hashes of the zw and then yzw corners, ordered the same as the nested loops below.
+    NoiseLanesInt pzw[4];
+    pzw[0] = lanes_hash(cz.i0, pw0);
+    pzw[1] = lanes_hash(cz.i0, pw1);
+    pzw[2] = lanes_hash(cz.i1, pw0);
+    pzw[3] = lanes_hash(cz.i1, pw1);
+
+    NoiseLanesInt pyzw[8];
+    for(nkS32 i=0; i<4; ++i)
+    {
+        pyzw[i+0] = lanes_hash(cy.i0, pzw[i]);
+        pyzw[i+4] = lanes_hash(cy.i1, pzw[i]);
+    }
+
+    NoiseLanes n[2];
+    for(nkS32 ix=0; ix<2; ++ix)
+    {
+        NoiseLanesInt i  = (ix == 0) ? cx.i0 : cx.i1;
+        NoiseLanes    fx = (ix == 0) ? cx.f0 : cx.f1;
+
+        NoiseLanes nx[2];
+        for(nkS32 iy=0; iy<2; ++iy)
+        {
+            NoiseLanes fy = (iy == 0) ? cy.f0 : cy.f1;
+            const NoiseLanesInt* p = &pyzw[iy*4];
+
+            NoiseLanes nxyz0, nxyz1, nxy0, nxy1;
+
+            nxyz0 = lanes_grad4(lanes_hash(i, p[0]), fx, fy, cz.f0, cw.f0);
+            nxyz1 = lanes_grad4(lanes_hash(i, p[1]), fx, fy, cz.f0, cw.f1);
+
+            nxy0 = lanes_lerp(nxyz0, nxyz1, q);
+
+            nxyz0 = lanes_grad4(lanes_hash(i, p[2]), fx, fy, cz.f1, cw.f0);
+            nxyz1 = lanes_grad4(lanes_hash(i, p[3]), fx, fy, cz.f1, cw.f1);
+
+            nxy1 = lanes_lerp(nxyz0, nxyz1, q);
+
+            nx[iy] = lanes_lerp(nxy0, nxy1, r);
+        }
+
+        n[ix] = lanes_lerp(nx[0], nx[1], t);
+    }
+
+    return lanes_mul(lanes_set(0.87f), lanes_lerp(n[0], n[1], s));
+}
+
+// The coordinates of a grid row, matching the (x + i * dx) used by the scalar path.
+INTERNAL NKFORCEINLINE NoiseLanes lanes_row(nkF32 x, nkF32 dx, nkS32 i)
+{
+    NoiseLanes index = lanes_add(lanes_set(NK_CAST(nkF32, i)), lanes_iota());
+    return lanes_add(lanes_set(x), lanes_mul(index, lanes_set(dx)));
+}
+
+#endif // NOISE_SIMD
+
+GLOBAL void perlin_noise_2d_batch(nkF32* out, const nkF32* x, const nkF32* y, nkU64 count)
+{
+    nkU64 i = 0;
+    #if defined(NOISE_SIMD)
+    for(; i+NOISE_LANES<=count; i+=NOISE_LANES)
+        lanes_store(out+i, lanes_perlin_noise_2d(lanes_load(x+i), lanes_load(y+i)));
+    #endif // NOISE_SIMD
+    for(; i<count; ++i)
+        out[i] = perlin_noise_2d(x[i], y[i]);
+}
+
+GLOBAL void perlin_noise_3d_batch(nkF32* out, const nkF32* x, const nkF32* y, const nkF32* z, nkU64 count)
+{
+    nkU64 i = 0;
+    #if defined(NOISE_SIMD)
+    for(; i+NOISE_LANES<=count; i+=NOISE_LANES)
+        lanes_store(out+i, lanes_perlin_noise_3d(lanes_load(x+i), lanes_load(y+i), lanes_load(z+i)));
+    #endif // NOISE_SIMD
+    for(; i<count; ++i)
+        out[i] = perlin_noise_3d(x[i], y[i], z[i]);
+}
+
+GLOBAL void perlin_noise_4d_batch(nkF32* out, const nkF32* x, const nkF32* y, const nkF32* z, const nkF32* w, nkU64 count)
+{
+    nkU64 i = 0;
+    #if defined(NOISE_SIMD)
+    for(; i+NOISE_LANES<=count; i+=NOISE_LANES)
+        lanes_store(out+i, lanes_perlin_noise_4d(lanes_load(x+i), lanes_load(y+i), lanes_load(z+i), lanes_load(w+i)));
+    #endif // NOISE_SIMD
+    for(; i<count; ++i)
+        out[i] = perlin_noise_4d(x[i], y[i], z[i], w[i]);
+}
+
+// Both grid functions run every octave over a whole row before moving on to the next octave, each sample still gets
+// its octaves summed in the same order as fbm_perlin_noise_2d/3d so the results match them exactly.
+
+INTERNAL void fbm_perlin_noise_row(nkF32* out, nkS32 width, nkF32 x, nkF32 dx, nkF32 y, const nkF32* z, const FbmDesc& desc)
+{
+    for(nkS32 i=0; i<width; ++i)
+        out[i] = 0.0f;
+
+    nkF32 frequency = desc.frequency;
+    nkF32 amplitude = 1.0f;
+    nkF32 total     = 0.0f;
+
+    for(nkS32 octave=0; octave<desc.octaves; ++octave)
+    {
+        nkS32 i = 0;
+
+        #if defined(NOISE_SIMD)
+        NoiseLanes f = lanes_set(frequency);
+        NoiseLanes a = lanes_set(amplitude);
+        NoiseLanes ly = lanes_mul(lanes_set(y), f);
+        NoiseLanes lz = (z) ? lanes_mul(lanes_set(*z), f) : lanes_set(0.0f);
+        for(; i+NOISE_LANES<=width; i+=NOISE_LANES)
+        {
+            NoiseLanes lx = lanes_mul(lanes_row(x, dx, i), f);
+            NoiseLanes n = (z) ? lanes_perlin_noise_3d(lx, ly, lz) : lanes_perlin_noise_2d(lx, ly);
+            lanes_store(out+i, lanes_add(lanes_load(out+i), lanes_mul(a, n)));
+        }
+        #endif // NOISE_SIMD
+
+        for(; i<width; ++i)
+        {
+            nkF32 sx = (x + NK_CAST(nkF32, i) * dx) * frequency;
+            nkF32 n = (z) ? perlin_noise_3d(sx, y * frequency, *z * frequency) : perlin_noise_2d(sx, y * frequency);
+            out[i] += amplitude * n;
+        }
+
+        total += amplitude;
+        frequency *= desc.lacunarity;
+        amplitude *= desc.gain;
+    }
+
+    if(total > 0.0f)
+    {
+        for(nkS32 i=0; i<width; ++i)
+            out[i] /= total;
+    }
+}
+
+GLOBAL nkF32 fbm_perlin_noise_2d(nkF32 x, nkF32 y, const FbmDesc& desc)
+{
+    nkF32 frequency = desc.frequency;
+    nkF32 amplitude = 1.0f;
+    nkF32 total     = 0.0f;
+    nkF32 sum       = 0.0f;
+
+    for(nkS32 octave=0; octave<desc.octaves; ++octave)
+    {
+        sum += amplitude * perlin_noise_2d(x * frequency, y * frequency);
+        total += amplitude;
+        frequency *= desc.lacunarity;
+        amplitude *= desc.gain;
+    }
+
+    return (total > 0.0f) ? (sum / total) : 0.0f;
+}
+
+GLOBAL nkF32 fbm_perlin_noise_3d(nkF32 x, nkF32 y, nkF32 z, const FbmDesc& desc)
+{
+    nkF32 frequency = desc.frequency;
+    nkF32 amplitude = 1.0f;
+    nkF32 total     = 0.0f;
+    nkF32 sum       = 0.0f;
+
+    for(nkS32 octave=0; octave<desc.octaves; ++octave)
+    {
+        sum += amplitude * perlin_noise_3d(x * frequency, y * frequency, z * frequency);
+        total += amplitude;
+        frequency *= desc.lacunarity;
+        amplitude *= desc.gain;
+    }
+
+    return (total > 0.0f) ? (sum / total) : 0.0f;
+}
+
+GLOBAL void perlin_noise_2d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 dx, nkF32 dy)
+{
+    FbmDesc desc;
+    desc.octaves = 1;
+    fbm_perlin_noise_2d_grid(out, width, height, x, y, dx, dy, desc);
+}
+
+GLOBAL void perlin_noise_3d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 z, nkF32 dx, nkF32 dy)
+{
+    FbmDesc desc;
+    desc.octaves = 1;
+    fbm_perlin_noise_3d_grid(out, width, height, x, y, z, dx, dy, desc);
+}
+
+GLOBAL void fbm_perlin_noise_2d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 dx, nkF32 dy, const FbmDesc& desc)
+{
+    NK_ASSERT(out);
+    for(nkS32 j=0; j<height; ++j)
+        fbm_perlin_noise_row(out + NK_CAST(nkU64, j) * width, width, x, dx, y + NK_CAST(nkF32, j) * dy, NULL, desc);
+}
+
+GLOBAL void fbm_perlin_noise_3d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 z, nkF32 dx, nkF32 dy, const FbmDesc& desc)
+{
+    NK_ASSERT(out);
+    for(nkS32 j=0; j<height; ++j)
+        fbm_perlin_noise_row(out + NK_CAST(nkU64, j) * width, width, x, dx, y + NK_CAST(nkF32, j) * dy, &z, desc);
+}
+
+// The grid spans a single period, so sample (i,j) of an octave with a period of (px,py) is taken at (i*px/width, j*py/height).
+INTERNAL void periodic_fbm_perlin_noise_row(nkF32* out, nkS32 width, nkS32 height, nkS32 row, nkS32 px, nkS32 py, const FbmDesc& desc)
+{
+    for(nkS32 i=0; i<width; ++i)
+        out[i] = 0.0f;
+
+    nkF32 frequency = desc.frequency;
+    nkF32 amplitude = 1.0f;
+    nkF32 total     = 0.0f;
+
+    for(nkS32 octave=0; octave<desc.octaves; ++octave)
+    {
+        // Round each octave's period to a whole number of cells, otherwise it wouldn't tile.
+        nkS32 opx = nk_max(1, NK_CAST(nkS32, NK_CAST(nkF32, px) * frequency + 0.5f));
+        nkS32 opy = nk_max(1, NK_CAST(nkS32, NK_CAST(nkF32, py) * frequency + 0.5f));
+
+        nkF32 dx = NK_CAST(nkF32, opx) / NK_CAST(nkF32, width);
+        nkF32 dy = NK_CAST(nkF32, opy) / NK_CAST(nkF32, height);
+        nkF32 y  = NK_CAST(nkF32, row) * dy;
+
+        nkS32 i = 0;
+
+        #if defined(NOISE_SIMD)
+        NoiseLanes a = lanes_set(amplitude);
+        NoiseLanesCell cy = lanes_periodic_cell(lanes_set(y), opy);
+        for(; i+NOISE_LANES<=width; i+=NOISE_LANES)
+        {
+            NoiseLanes n = lanes_perlin_noise_2d(lanes_periodic_cell(lanes_row(0.0f, dx, i), opx), cy);
+            lanes_store(out+i, lanes_add(lanes_load(out+i), lanes_mul(a, n)));
+        }
+        #endif // NOISE_SIMD
+
+        for(; i<width; ++i)
+        {
+            nkF32 sx = NK_CAST(nkF32, i) * dx;
+            out[i] += amplitude * periodic_perlin_noise_2d(sx, y, opx, opy);
+        }
+
+        total += amplitude;
+        frequency *= desc.lacunarity;
+        amplitude *= desc.gain;
+    }
+
+    if(total > 0.0f)
+    {
+        for(nkS32 i=0; i<width; ++i)
+            out[i] /= total;
+    }
+}
+
+GLOBAL void periodic_fbm_perlin_noise_2d_grid(nkF32* out, nkS32 width, nkS32 height, nkS32 px, nkS32 py, const FbmDesc& desc)
+{
+    periodic_fbm_perlin_noise_2d_grid_rows(out, width, height, 0, height, px, py, desc);
+}
+
+GLOBAL void periodic_fbm_perlin_noise_2d_grid_rows(nkF32* out, nkS32 width, nkS32 height, nkS32 row_begin, nkS32 row_end, nkS32 px, nkS32 py, const FbmDesc& desc)
+{
+    NK_ASSERT(out);
+    NK_ASSERT(px > 0 && py > 0);
+    NK_ASSERT(row_begin >= 0 && row_end <= height);
+    for(nkS32 j=row_begin; j<row_end; ++j)
+        periodic_fbm_perlin_noise_row(out + NK_CAST(nkU64, j) * width, width, height, j, px, py, desc);
+}
+
+// =============================================================================
+// Simplex noise, based on Stefan Gustavson's public domain sdnoise1234 (from the
+// same library as the Perlin noise above). Instead of the 2^N corners of a cube,
+// each sample only visits the N+1 corners of the simplex it lands in. The 1D to
+// 4D functions share the permutation table with the Perlin noise. The 3D and 4D
+// versions use a radius of 0.5 rather than the original 0.6, as with 0.6 corners
+// outside of the simplex can still reach in which shows up as seams.
+//
+// The periodic 2D version can't use the usual skewed lattice as it never lines
+// up with a square period, so it uses the sheared lattice from Gustavson and
+// McEwan's psrdnoise instead, where alternate rows are offset by half a cell.
+//
+// The OpenSimplex2 style functions follow the approach of K.jpg's OpenSimplex2,
+// 2D uses the simplex lattice with a larger radius (so neighbouring triangles
+// contribute and the grid pattern is less visible), whilst 3D uses the body-
+// centred cubic lattice (two cubic lattices, one offset by half a cell) and 4D
+// the equivalent lattice one dimension up. These lattices line up with integer
+// periods which is where the periodic 3D and 4D variants come from.
+//
+// All of them can optionally return analytic derivatives, each corner adds
+// t^4 * (g.d) where t = r^2 - |d|^2 so the derivative is t^4 * g - 8t^3 (g.d) d.
+// =============================================================================
+
+INTERNAL constexpr nkF32 SIMPLEX_F2 = 0.366025403f; // 0.5 * (sqrt(3) - 1)
+INTERNAL constexpr nkF32 SIMPLEX_G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+INTERNAL constexpr nkF32 SIMPLEX_F3 = 0.333333333f; // 1 / 3
+INTERNAL constexpr nkF32 SIMPLEX_G3 = 0.166666667f; // 1 / 6
+INTERNAL constexpr nkF32 SIMPLEX_F4 = 0.309016994f; // (sqrt(5) - 1) / 4
+INTERNAL constexpr nkF32 SIMPLEX_G4 = 0.138196601f; // (5 - sqrt(5)) / 20
+
+INTERNAL constexpr nkF32 GRAD2[8][2] =
+{
+    { -1.0f,-1.0f }, {  1.0f, 0.0f }, { -1.0f, 0.0f }, {  1.0f, 1.0f },
+    { -1.0f, 1.0f }, {  0.0f,-1.0f }, {  0.0f, 1.0f }, {  1.0f,-1.0f }
+};
+
+// Unit length gradients every 11.25 degrees, used where the lattice isn't axis aligned.
+INTERNAL constexpr nkF32 GRAD2_UNIT[32][2] =
+{
+    {  1.000000f, 0.000000f }, {  0.980785f, 0.195090f }, {  0.923880f, 0.382683f }, {  0.831470f, 0.555570f },
+    {  0.707107f, 0.707107f }, {  0.555570f, 0.831470f }, {  0.382683f, 0.923880f }, {  0.195090f, 0.980785f },
+    {  0.000000f, 1.000000f }, { -0.195090f, 0.980785f }, { -0.382683f, 0.923880f }, { -0.555570f, 0.831470f },
+    { -0.707107f, 0.707107f }, { -0.831470f, 0.555570f }, { -0.923880f, 0.382683f }, { -0.980785f, 0.195090f },
+    { -1.000000f, 0.000000f }, { -0.980785f,-0.195090f }, { -0.923880f,-0.382683f }, { -0.831470f,-0.555570f },
+    { -0.707107f,-0.707107f }, { -0.555570f,-0.831470f }, { -0.382683f,-0.923880f }, { -0.195090f,-0.980785f },
+    {  0.000000f,-1.000000f }, {  0.195090f,-0.980785f }, {  0.382683f,-0.923880f }, {  0.555570f,-0.831470f },
+    {  0.707107f,-0.707107f }, {  0.831470f,-0.555570f }, {  0.923880f,-0.382683f }, {  0.980785f,-0.195090f }
+};
+
+// The 12 cube edges, with 4 of them repeated to make 16.
+INTERNAL constexpr nkF32 GRAD3[16][3] =
+{
+    {  1.0f, 0.0f, 1.0f }, {  0.0f, 1.0f, 1.0f }, { -1.0f, 0.0f, 1.0f }, {  0.0f,-1.0f, 1.0f },
+    {  1.0f, 0.0f,-1.0f }, {  0.0f, 1.0f,-1.0f }, { -1.0f, 0.0f,-1.0f }, {  0.0f,-1.0f,-1.0f },
+    {  1.0f,-1.0f, 0.0f }, {  1.0f, 1.0f, 0.0f }, { -1.0f, 1.0f, 0.0f }, { -1.0f,-1.0f, 0.0f },
+    {  1.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 1.0f }, {  0.0f, 1.0f,-1.0f }, {  0.0f,-1.0f,-1.0f }
+};
+
+// The 32 edges of a tesseract.
+INTERNAL constexpr nkF32 GRAD4[32][4] =
+{
+    {  0.0f, 1.0f, 1.0f, 1.0f }, {  0.0f, 1.0f, 1.0f,-1.0f }, {  0.0f, 1.0f,-1.0f, 1.0f }, {  0.0f, 1.0f,-1.0f,-1.0f },
+    {  0.0f,-1.0f, 1.0f, 1.0f }, {  0.0f,-1.0f, 1.0f,-1.0f }, {  0.0f,-1.0f,-1.0f, 1.0f }, {  0.0f,-1.0f,-1.0f,-1.0f },
+    {  1.0f, 0.0f, 1.0f, 1.0f }, {  1.0f, 0.0f, 1.0f,-1.0f }, {  1.0f, 0.0f,-1.0f, 1.0f }, {  1.0f, 0.0f,-1.0f,-1.0f },
+    { -1.0f, 0.0f, 1.0f, 1.0f }, { -1.0f, 0.0f, 1.0f,-1.0f }, { -1.0f, 0.0f,-1.0f, 1.0f }, { -1.0f, 0.0f,-1.0f,-1.0f },
+    {  1.0f, 1.0f, 0.0f, 1.0f }, {  1.0f, 1.0f, 0.0f,-1.0f }, {  1.0f,-1.0f, 0.0f, 1.0f }, {  1.0f,-1.0f, 0.0f,-1.0f },
+    { -1.0f, 1.0f, 0.0f, 1.0f }, { -1.0f, 1.0f, 0.0f,-1.0f }, { -1.0f,-1.0f, 0.0f, 1.0f }, { -1.0f,-1.0f, 0.0f,-1.0f },
+    {  1.0f, 1.0f, 1.0f, 0.0f }, {  1.0f, 1.0f,-1.0f, 0.0f }, {  1.0f,-1.0f, 1.0f, 0.0f }, {  1.0f,-1.0f,-1.0f, 0.0f },
+    { -1.0f, 1.0f, 1.0f, 0.0f }, { -1.0f, 1.0f,-1.0f, 0.0f }, { -1.0f,-1.0f, 1.0f, 0.0f }, { -1.0f,-1.0f,-1.0f, 0.0f }
+};
+
+// Adds the contribution of a single lattice point, d is the offset from the point to the sample position and the
+// derivative (if wanted) is accumulated into deriv.
+template<nkS32 N>
+INTERNAL NKFORCEINLINE nkF32 simplex_corner(nkF32 radius2, const nkF32* g, const nkF32* d, nkF32* deriv)
+{
+    nkF32 t = radius2;
+    for(nkS32 i=0; i<N; ++i)
+        t -= d[i] * d[i];
+    if(t <= 0.0f) return 0.0f;
+
+    nkF32 gd = 0.0f;
+    for(nkS32 i=0; i<N; ++i)
+        gd += g[i] * d[i];
+
+    nkF32 t2 = t * t;
+    nkF32 t4 = t2 * t2;
+
+    if(deriv)
+    {
+        nkF32 k = -8.0f * t2 * t * gd;
+        for(nkS32 i=0; i<N; ++i)
+            deriv[i] += t4 * g[i] + k * d[i];
+    }
+
+    return (t4 * gd);
+}
+
+template<nkS32 N>
+INTERNAL NKFORCEINLINE void output_simplex_derivative(const nkF32* deriv, nkF32 scale, nkF32* out)
+{
+    if(!out) return;
+    for(nkS32 i=0; i<N; ++i)
+        out[i] = deriv[i] * scale;
+}
+
+// Wraps to 0..p-1, unlike % this also works for negative values.
+INTERNAL inline nkS32 wrap_lattice(nkS32 i, nkS32 p)
+{
+    i %= p;
+    return ((i < 0) ? (i + p) : i);
+}
+
+// Simplex =====================================================================
+INTERNAL nkF32 simplex_noise_1d_internal(nkF32 x, nkS32 i0, nkS32 i1, nkF32* derivative)
+{
+    nkF32 deriv[1] = { 0.0f };
+
+    nkF32 d0[1] = { x - NK_CAST(nkF32, fast_floor(x)) };
+    nkF32 d1[1] = { d0[0] - 1.0f };
+
+    // Same gradient values as the Perlin noise, 1.0 to 8.0 with a random sign.
+    nkS32 h0 = PERM[i0 & 0xFF] & 15;
+    nkS32 h1 = PERM[i1 & 0xFF] & 15;
+    nkF32 g0[1] = { NK_CAST(nkF32, (h0&8) ? -(1+(h0&7)) : (1+(h0&7))) };
+    nkF32 g1[1] = { NK_CAST(nkF32, (h1&8) ? -(1+(h1&7)) : (1+(h1&7))) };
+
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    nkF32 n = 0.0f;
+    n += simplex_corner<1>(1.0f, g0, d0, dp);
+    n += simplex_corner<1>(1.0f, g1, d1, dp);
+
+    output_simplex_derivative<1>(deriv, 0.395f, derivative);
+    return (0.395f * n);
+}
+
+GLOBAL nkF32 simplex_noise_1d(nkF32 x, nkF32* derivative)
+{
+    nkS32 i0 = fast_floor(x);
+    return simplex_noise_1d_internal(x, i0, i0+1, derivative);
+}
+
+GLOBAL nkF32 periodic_simplex_noise_1d(nkF32 x, nkS32 px, nkF32* derivative)
+{
+    NK_ASSERT(px > 0);
+    nkS32 i0 = fast_floor(x);
+    return simplex_noise_1d_internal(x, wrap_lattice(i0, px), wrap_lattice(i0+1, px), derivative);
+}
+
+GLOBAL nkF32 simplex_noise_2d(nkF32 x, nkF32 y, nkVec2* derivative)
+{
+    nkF32 deriv[2] = { 0.0f, 0.0f };
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    // Skew the input space to find which simplex cell we're in.
+    nkF32 s = (x + y) * SIMPLEX_F2;
+    nkS32 i = fast_floor(x + s);
+    nkS32 j = fast_floor(y + s);
+
+    // Unskew the cell origin back to (x,y) space and get the distances from it.
+    nkF32 t = NK_CAST(nkF32, i + j) * SIMPLEX_G2;
+    nkF32 d0[2] = { x - (i - t), y - (j - t) };
+
+    // Work out which of the two triangles in the cell we're in.
+    nkS32 i1 = (d0[0] > d0[1]) ? 1 : 0;
+    nkS32 j1 = 1 - i1;
+
+    nkF32 d1[2] = { d0[0] - i1 + SIMPLEX_G2,        d0[1] - j1 + SIMPLEX_G2        };
+    nkF32 d2[2] = { d0[0] - 1.0f + 2.0f*SIMPLEX_G2, d0[1] - 1.0f + 2.0f*SIMPLEX_G2 };
+
+    nkS32 ii = i & 0xFF;
+    nkS32 jj = j & 0xFF;
+
+    nkF32 n = 0.0f;
+    n += simplex_corner<2>(0.5f, GRAD2[PERM[ii   +PERM[jj   ]] & 7], d0, dp);
+    n += simplex_corner<2>(0.5f, GRAD2[PERM[ii+i1+PERM[jj+j1]] & 7], d1, dp);
+    n += simplex_corner<2>(0.5f, GRAD2[PERM[ii+1 +PERM[jj+1 ]] & 7], d2, dp);
+
+    output_simplex_derivative<2>(deriv, 70.0f, (derivative) ? derivative->raw : NULL);
+    return (70.0f * n);
+}
+
+GLOBAL nkF32 periodic_simplex_noise_2d(nkF32 x, nkF32 y, nkS32 px, nkS32 py, nkVec2* derivative)
+{
+    NK_ASSERT(px > 0 && py > 0);
+
+    // Every other row of the lattice is offset by half a cell, so the period in y has to be even to line up.
+    py += (py & 1);
+
+    nkF32 deriv[2] = { 0.0f, 0.0f };
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    // Shear into lattice space, where the cells are unit squares split into two triangles along the diagonal.
+    nkF32 u = x + y * 0.5f;
+    nkF32 v = y;
+
+    nkS32 i0 = fast_floor(u);
+    nkS32 j0 = fast_floor(v);
+
+    nkS32 o = ((u - i0) >= (v - j0)) ? 1 : 0;
+
+    nkS32 ci[3] = { i0, i0 + o, i0 + 1 };
+    nkS32 cj[3] = { j0, j0 + 1 - o, j0 + 1 };
+
+    nkF32 n = 0.0f;
+    for(nkS32 c=0; c<3; ++c)
+    {
+        // The lattice point (i,j) sits at (i - j/2, j), moving up by py rows is the same as moving across by py/2.
+        nkS32 jw = wrap_lattice(cj[c], py);
+        nkS32 iw = wrap_lattice(ci[c] - ((cj[c] - jw) / py) * (py / 2), px);
+
+        nkF32 d[2] = { x - (NK_CAST(nkF32, ci[c]) - NK_CAST(nkF32, cj[c]) * 0.5f), y - NK_CAST(nkF32, cj[c]) };
+
+        n += simplex_corner<2>(0.8f, GRAD2_UNIT[PERM[(iw & 0xFF) + PERM[jw & 0xFF]] & 31], d, dp);
+    }
+
+    output_simplex_derivative<2>(deriv, 11.2f, (derivative) ? derivative->raw : NULL);
+    return (11.2f * n);
+}
+
+GLOBAL nkF32 simplex_noise_3d(nkF32 x, nkF32 y, nkF32 z, nkVec3* derivative)
+{
+    nkF32 deriv[3] = { 0.0f, 0.0f, 0.0f };
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    nkF32 s = (x + y + z) * SIMPLEX_F3;
+    nkS32 i = fast_floor(x + s);
+    nkS32 j = fast_floor(y + s);
+    nkS32 k = fast_floor(z + s);
+
+    nkF32 t = NK_CAST(nkF32, i + j + k) * SIMPLEX_G3;
+    nkF32 d0[3] = { x - (i - t), y - (j - t), z - (k - t) };
+
+    // Work out which of the six tetrahedra in the cell we're in, from the order of the distances.
+    nkS32 i1, j1, k1; // Offsets for the second corner.
+    nkS32 i2, j2, k2; // Offsets for the third corner.
+
+    if(d0[0] >= d0[1])
+    {
+        if     (d0[1] >= d0[2]) { i1=1; j1=0; k1=0; i2=1; j2=1; k2=0; } // X Y Z order.
+        else if(d0[0] >= d0[2]) { i1=1; j1=0; k1=0; i2=1; j2=0; k2=1; } // X Z Y order.
+        else                    { i1=0; j1=0; k1=1; i2=1; j2=0; k2=1; } // Z X Y order.
+    }
+    else
+    {
+        if     (d0[1] <  d0[2]) { i1=0; j1=0; k1=1; i2=0; j2=1; k2=1; } // Z Y X order.
+        else if(d0[0] <  d0[2]) { i1=0; j1=1; k1=0; i2=0; j2=1; k2=1; } // Y Z X order.
+        else                    { i1=0; j1=1; k1=0; i2=1; j2=1; k2=0; } // Y X Z order.
+    }
+
+    nkF32 d1[3] = { d0[0] - i1 + SIMPLEX_G3,        d0[1] - j1 + SIMPLEX_G3,        d0[2] - k1 + SIMPLEX_G3        };
+    nkF32 d2[3] = { d0[0] - i2 + 2.0f*SIMPLEX_G3,   d0[1] - j2 + 2.0f*SIMPLEX_G3,   d0[2] - k2 + 2.0f*SIMPLEX_G3   };
+    nkF32 d3[3] = { d0[0] - 1.0f + 3.0f*SIMPLEX_G3, d0[1] - 1.0f + 3.0f*SIMPLEX_G3, d0[2] - 1.0f + 3.0f*SIMPLEX_G3 };
+
+    nkS32 ii = i & 0xFF;
+    nkS32 jj = j & 0xFF;
+    nkS32 kk = k & 0xFF;
+
+    nkF32 n = 0.0f;
+    n += simplex_corner<3>(0.5f, GRAD3[PERM[ii   +PERM[jj   +PERM[kk   ]]] & 15], d0, dp);
+    n += simplex_corner<3>(0.5f, GRAD3[PERM[ii+i1+PERM[jj+j1+PERM[kk+k1]]] & 15], d1, dp);
+    n += simplex_corner<3>(0.5f, GRAD3[PERM[ii+i2+PERM[jj+j2+PERM[kk+k2]]] & 15], d2, dp);
+    n += simplex_corner<3>(0.5f, GRAD3[PERM[ii+1 +PERM[jj+1 +PERM[kk+1 ]]] & 15], d3, dp);
+
+    output_simplex_derivative<3>(deriv, 76.0f, (derivative) ? derivative->raw : NULL);
+    return (76.0f * n);
+}
+
+GLOBAL nkF32 simplex_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkVec4* derivative)
+{
+    nkF32 deriv[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    nkF32 s = (x + y + z + w) * SIMPLEX_F4;
+    nkS32 i = fast_floor(x + s);
+    nkS32 j = fast_floor(y + s);
+    nkS32 k = fast_floor(z + s);
+    nkS32 l = fast_floor(w + s);
+
+    nkF32 t = NK_CAST(nkF32, i + j + k + l) * SIMPLEX_G4;
+    nkF32 d0[4] = { x - (i - t), y - (j - t), z - (k - t), w - (l - t) };
+
+    // Rank the distances by magnitude to find which of the 24 simplices in the cell we're in, the largest gets
+    // stepped along first, then the second largest, etc.
+    nkS32 rank[4] = { 0, 0, 0, 0 };
+    for(nkS32 a=0; a<4; ++a)
+        for(nkS32 b=a+1; b<4; ++b)
+            rank[(d0[a] > d0[b]) ? a : b]++;
+
+    nkS32 o[3][4];
+    for(nkS32 c=0; c<3; ++c)
+        for(nkS32 a=0; a<4; ++a)
+            o[c][a] = (rank[a] >= 3-c) ? 1 : 0;
+
+    nkF32 d[4][4];
+    for(nkS32 c=0; c<3; ++c)
+        for(nkS32 a=0; a<4; ++a)
+            d[c][a] = d0[a] - o[c][a] + NK_CAST(nkF32, c+1) * SIMPLEX_G4;
+    for(nkS32 a=0; a<4; ++a)
+        d[3][a] = d0[a] - 1.0f + 4.0f * SIMPLEX_G4;
+
+    nkS32 ii = i & 0xFF;
+    nkS32 jj = j & 0xFF;
+    nkS32 kk = k & 0xFF;
+    nkS32 ll = l & 0xFF;
+
+    nkF32 n = 0.0f;
+    n += simplex_corner<4>(0.5f, GRAD4[PERM[ii+PERM[jj+PERM[kk+PERM[ll]]]] & 31], d0, dp);
+    for(nkS32 c=0; c<3; ++c)
+        n += simplex_corner<4>(0.5f, GRAD4[PERM[ii+o[c][0]+PERM[jj+o[c][1]+PERM[kk+o[c][2]+PERM[ll+o[c][3]]]]] & 31], d[c], dp);
+    n += simplex_corner<4>(0.5f, GRAD4[PERM[ii+1+PERM[jj+1+PERM[kk+1+PERM[ll+1]]]] & 31], d[3], dp);
+
+    output_simplex_derivative<4>(deriv, 62.0f, (derivative) ? derivative->raw : NULL);
+    return (62.0f * n);
+}
+// =============================================================================
+
+// OpenSimplex2 ================================================================
+GLOBAL nkF32 opensimplex2_noise_2d(nkF32 x, nkF32 y, nkVec2* derivative)
+{
+    nkF32 deriv[2] = { 0.0f, 0.0f };
+    nkF32* dp = (derivative) ? deriv : NULL;
+
+    nkF32 s = (x + y) * SIMPLEX_F2;
+    nkS32 i = fast_floor(x + s);
+    nkS32 j = fast_floor(y + s);
+
+    nkF32 t = NK_CAST(nkF32, i + j) * SIMPLEX_G2;
+    nkF32 x0 = x - (i - t);
+    nkF32 y0 = y - (j - t);
+
+    // With the radius equal to the edge length the far corners of the three triangles that share an edge with ours
+    // can reach in as well, every other lattice point is at least an edge length away from the whole triangle.
+    PERSISTENT constexpr nkS32 LOWER[6][2] = { { 0,0 }, { 1,0 }, { 1,1 }, { 0,-1 }, { 2,1 }, { 0,1 } };
+    PERSISTENT constexpr nkS32 UPPER[6][2] = { { 0,0 }, { 0,1 }, { 1,1 }, { -1,0 }, { 1,2 }, { 1,0 } };
+
+    const nkS32 (*corners)[2] = (x0 > y0) ? LOWER : UPPER;
+
+    nkF32 n = 0.0f;
+    for(nkS32 c=0; c<6; ++c)
+    {
+        nkS32 ci = corners[c][0];
+        nkS32 cj = corners[c][1];
+
+        nkF32 ct = NK_CAST(nkF32, ci + cj) * SIMPLEX_G2;
+        nkF32 d[2] = { x0 - ci + ct, y0 - cj + ct };
+
+        n += simplex_corner<2>(2.0f/3.0f, GRAD2_UNIT[PERM[((i+ci) & 0xFF) + PERM[(j+cj) & 0xFF]] & 31], d, dp);
+    }
+
+    output_simplex_derivative<2>(deriv, 18.0f, (derivative) ? derivative->raw : NULL);
+    return (18.0f * n);
+}
+
+// Sums the contributions from both of the offset cubic lattices, for each one only the corners of the cube we are in
+// can be in range as everything else is more than a cell away on at least one axis.
+template<nkS32 N>
+INTERNAL nkF32 opensimplex2_noise_internal(const nkF32* p, const nkS32* period, nkF32 radius2, const nkF32* grads, nkS32 grad_mask, nkF32* deriv)
+{
+    nkF32 n = 0.0f;
+    for(nkS32 s=0; s<2; ++s)
+    {
+        nkF32 offset = NK_CAST(nkF32, s) * 0.5f;
+
+        nkS32 base[N];
+        for(nkS32 a=0; a<N; ++a)
+            base[a] = fast_floor(p[a] - offset);
+
+        for(nkS32 c=0; c<(1<<N); ++c)
+        {
+            nkS32 l[N];
+            nkF32 d[N];
+            for(nkS32 a=0; a<N; ++a)
+            {
+                l[a] = base[a] + ((c >> a) & 1);
+                d[a] = p[a] - (NK_CAST(nkF32, l[a]) + offset);
+                if(period)
+                    l[a] = wrap_lattice(l[a], period[a]);
+            }
+
+            // Seeding the hash with the sub-lattice index gives the two lattices different gradients.
+            nkS32 h = s;
+            for(nkS32 a=N-1; a>=0; --a)
+                h = PERM[(l[a] & 0xFF) + h];
+
+            n += simplex_corner<N>(radius2, grads + (h & grad_mask) * N, d, deriv);
+        }
+    }
+    return n;
+}
+
+GLOBAL nkF32 opensimplex2_noise_3d(nkF32 x, nkF32 y, nkF32 z, nkVec3* derivative)
+{
+    nkF32 deriv[3] = { 0.0f, 0.0f, 0.0f };
+    nkF32 p[3] = { x, y, z };
+    nkF32 n = opensimplex2_noise_internal<3>(p, NULL, 0.6f, &GRAD3[0][0], 15, (derivative) ? deriv : NULL);
+    output_simplex_derivative<3>(deriv, 32.5f, (derivative) ? derivative->raw : NULL);
+    return (32.5f * n);
+}
+
+GLOBAL nkF32 opensimplex2_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkVec4* derivative)
+{
+    nkF32 deriv[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    nkF32 p[4] = { x, y, z, w };
+    nkF32 n = opensimplex2_noise_internal<4>(p, NULL, 0.75f, &GRAD4[0][0], 31, (derivative) ? deriv : NULL);
+    output_simplex_derivative<4>(deriv, 9.9f, (derivative) ? derivative->raw : NULL);
+    return (9.9f * n);
+}
+
+GLOBAL nkF32 periodic_opensimplex2_noise_3d(nkF32 x, nkF32 y, nkF32 z, nkS32 px, nkS32 py, nkS32 pz, nkVec3* derivative)
+{
+    NK_ASSERT(px > 0 && py > 0 && pz > 0);
+    nkF32 deriv[3] = { 0.0f, 0.0f, 0.0f };
+    nkF32 p[3] = { x, y, z };
+    nkS32 period[3] = { px, py, pz };
+    nkF32 n = opensimplex2_noise_internal<3>(p, period, 0.6f, &GRAD3[0][0], 15, (derivative) ? deriv : NULL);
+    output_simplex_derivative<3>(deriv, 32.5f, (derivative) ? derivative->raw : NULL);
+    return (32.5f * n);
+}
+
+GLOBAL nkF32 periodic_opensimplex2_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkS32 px, nkS32 py, nkS32 pz, nkS32 pw, nkVec4* derivative)
+{
+    NK_ASSERT(px > 0 && py > 0 && pz > 0 && pw > 0);
+    nkF32 deriv[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    nkF32 p[4] = { x, y, z, w };
+    nkS32 period[4] = { px, py, pz, pw };
+    nkF32 n = opensimplex2_noise_internal<4>(p, period, 0.75f, &GRAD4[0][0], 31, (derivative) ? deriv : NULL);
+    output_simplex_derivative<4>(deriv, 9.9f, (derivative) ? derivative->raw : NULL);
+    return (9.9f * n);
+}
+// =============================================================================
+
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -29,6 +29,55 @@ GLOBAL nkF32 periodic_perlin_noise_2d(nkF32 x, nkF32 y, nkS32 px, nkS32 py);
 GLOBAL nkF32 periodic_perlin_noise_3d(nkF32 x, nkF32 y, nkF32 z, nkS32 px, nkS32 py, nkS32 pz);
 GLOBAL nkF32 periodic_perlin_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkS32 px, nkS32 py, nkS32 pz, nkS32 pw);
 
+// Batch versions that evaluate lots of points at once using SIMD where it's available. The results are bit-identical
+// to calling the scalar functions on each point. Grids are row-major and sample (i,j) is taken at (x+i*dx, y+j*dy),
+// the 3D grid is a 2D slice taken at depth z.
+GLOBAL void perlin_noise_2d_batch(nkF32* out, const nkF32* x, const nkF32* y,                                 nkU64 count);
+GLOBAL void perlin_noise_3d_batch(nkF32* out, const nkF32* x, const nkF32* y, const nkF32* z,                 nkU64 count);
+GLOBAL void perlin_noise_4d_batch(nkF32* out, const nkF32* x, const nkF32* y, const nkF32* z, const nkF32* w, nkU64 count);
+GLOBAL void perlin_noise_2d_grid (nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y,          nkF32 dx, nkF32 dy);
+GLOBAL void perlin_noise_3d_grid (nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 z, nkF32 dx, nkF32 dy);
+
+// Fractal Brownian motion, sums octaves of noise with the frequency multiplied by the lacunarity and the amplitude by the
+// gain each octave. The result is divided by the sum of the amplitudes so it stays in the same range as a single octave.
+struct FbmDesc
+{
+    nkS32 octaves    = 4;
+    nkF32 frequency  = 1.0f;
+    nkF32 lacunarity = 2.0f;
+    nkF32 gain       = 0.5f;
+};
+
+GLOBAL nkF32 fbm_perlin_noise_2d     (nkF32 x, nkF32 y,          const FbmDesc& desc = FbmDesc());
+GLOBAL nkF32 fbm_perlin_noise_3d     (nkF32 x, nkF32 y, nkF32 z, const FbmDesc& desc = FbmDesc());
+GLOBAL void  fbm_perlin_noise_2d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y,          nkF32 dx, nkF32 dy, const FbmDesc& desc = FbmDesc());
+GLOBAL void  fbm_perlin_noise_3d_grid(nkF32* out, nkS32 width, nkS32 height, nkF32 x, nkF32 y, nkF32 z, nkF32 dx, nkF32 dy, const FbmDesc& desc = FbmDesc());
+
+// Tileable fBm grids, the whole grid covers one period of the noise (px by py cells at the base frequency) so it wraps
+// seamlessly at the edges. The periods of later octaves get rounded to whole cells so they tile as well. The rows version
+// only writes rows [row_begin,row_end) of the grid so the work can be split between threads.
+GLOBAL void periodic_fbm_perlin_noise_2d_grid     (nkF32* out, nkS32 width, nkS32 height,                                   nkS32 px, nkS32 py, const FbmDesc& desc = FbmDesc());
+GLOBAL void periodic_fbm_perlin_noise_2d_grid_rows(nkF32* out, nkS32 width, nkS32 height, nkS32 row_begin, nkS32 row_end, nkS32 px, nkS32 py, const FbmDesc& desc = FbmDesc());
+
+// Simplex noise visits fewer lattice points than Perlin noise (N+1 rather than 2^N) and has fewer directional artifacts.
+// OpenSimplex2 is smoother again, in 3D and 4D it uses a lattice that lines up with integer periods so it also gets
+// used for the periodic 3D and 4D versions. The output is roughly in [-1,+1] and if a derivative is passed in then it
+// is filled with the analytic gradient of the noise at that point, which is handy for normals and flow effects.
+GLOBAL nkF32 simplex_noise_1d(nkF32 x,                            nkF32* derivative = NULL);
+GLOBAL nkF32 simplex_noise_2d(nkF32 x, nkF32 y,                   nkVec2* derivative = NULL);
+GLOBAL nkF32 simplex_noise_3d(nkF32 x, nkF32 y, nkF32 z,          nkVec3* derivative = NULL);
+GLOBAL nkF32 simplex_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkVec4* derivative = NULL);
+
+GLOBAL nkF32 periodic_simplex_noise_1d(nkF32 x,          nkS32 px,           nkF32* derivative = NULL);
+GLOBAL nkF32 periodic_simplex_noise_2d(nkF32 x, nkF32 y, nkS32 px, nkS32 py, nkVec2* derivative = NULL); // The period in y is rounded up to be even.
+
+GLOBAL nkF32 opensimplex2_noise_2d(nkF32 x, nkF32 y,                   nkVec2* derivative = NULL);
+GLOBAL nkF32 opensimplex2_noise_3d(nkF32 x, nkF32 y, nkF32 z,          nkVec3* derivative = NULL);
+GLOBAL nkF32 opensimplex2_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkVec4* derivative = NULL);
+
+GLOBAL nkF32 periodic_opensimplex2_noise_3d(nkF32 x, nkF32 y, nkF32 z,          nkS32 px, nkS32 py, nkS32 pz,           nkVec3* derivative = NULL);
+GLOBAL nkF32 periodic_opensimplex2_noise_4d(nkF32 x, nkF32 y, nkF32 z, nkF32 w, nkS32 px, nkS32 py, nkS32 pz, nkS32 pw, nkVec4* derivative = NULL);
+
 // Convert the output perlin noise values from [-0.5f,+0.5f] to [0.0f,1.0f] range.
 GLOBAL NKFORCEINLINE nkF32 perlin_noise_1d_normalized(nkF32 x)
 {
@@ -5,7 +5,9 @@
 #endif // BUILD_WEB
 
 #include <SDL.h>
+#if !defined(BUILD_HEADLESS)
 #include <SDL_mixer.h>
+#endif // !BUILD_HEADLESS
 
 // On Windows we are using Direct3D so we do not want the OpenGL flag specified.
 #if defined(NK_OS_WIN32)
@@ -16,6 +18,8 @@ INTERNAL constexpr nkU32 WINDOW_FLAGS = SDL_WINDOW_HIDDEN|SDL_WINDOW_RESIZABLE|S
 
 INTERNAL constexpr const nkChar* PROGRAM_STATE_FILE = "state.dat";
 
+INTERNAL constexpr nkU64 FRAME_SPIN_MS = 2; // How long before the end of a capped frame we stop sleeping and spin.
+
 #pragma pack(push,1)
 struct ProgramState
 {
@@ -45,6 +49,8 @@ struct PlatformContext
     nkBool        maximized;
     nkBool        fullscreen;
     nkU64         ticks;
+    nkU64         next_frame_counter;
+    nkF32         tick_alpha;
 };
 
 INTERNAL PlatformContext g_ctx;
@@ -302,20 +308,72 @@ INTERNAL void end_render_frame(void)
     }
 }
 
+INTERNAL void sleep_until_counter(nkU64 target)
+{
+    // SDL_Delay can overshoot by a millisecond or two, so sleep until we're close and then spin the rest of the way.
+    nkU64 frequency = SDL_GetPerformanceFrequency();
+    nkU64 spin_counter = (frequency * FRAME_SPIN_MS) / 1000;
+
+    while(NK_TRUE)
+    {
+        nkU64 now = SDL_GetPerformanceCounter();
+        if(now >= target) break;
+        nkU64 remaining = target - now;
+        if(remaining > spin_counter)
+        {
+            SDL_Delay(NK_CAST(nkU32, ((remaining - spin_counter) * 1000) / frequency));
+        }
+    }
+}
+
+INTERNAL void limit_frame_rate(void)
+{
+    nkF32 fps = g_ctx.app_desc.frame_cap;
+    if(fps <= 0.0f && g_ctx.app_desc.frame_pacing && g_ctx.app_desc.vsync == VSyncMode_Off)
+        fps = get_refresh_rate();
+    if(fps <= 0.0f)
+    {
+        g_ctx.next_frame_counter = 0;
+        return;
+    }
+
+    nkU64 interval = NK_CAST(nkU64, NK_CAST(nkF64, SDL_GetPerformanceFrequency()) / fps);
+    nkU64 now = SDL_GetPerformanceCounter();
+
+    // Frames are lined up on a fixed grid so a slightly late frame gets caught up on the next one, rather than pushing
+    // every frame after it back. If we fall more than a whole frame behind there's no catching up so start again.
+    if(g_ctx.next_frame_counter == 0 || now > g_ctx.next_frame_counter + interval)
+        g_ctx.next_frame_counter = now;
+
+    sleep_until_counter(g_ctx.next_frame_counter);
+
+    g_ctx.next_frame_counter += interval;
+}
+
 INTERNAL void main_init(void)
 {
+    // Headless builds never open a window, so only the parts of SDL that don't need a display are initialized.
+    #if defined(BUILD_HEADLESS)
+    if(SDL_Init(SDL_INIT_EVENTS|SDL_INIT_TIMER) < 0)
+    #else
     if(SDL_Init(SDL_INIT_VIDEO) < 0)
+    #endif // BUILD_HEADLESS
     {
         fatal_error("Failed to initialize SDL systems: %s", SDL_GetError());
     }
 
+    init_memory_system();
+    init_job_system();
+
     setup_renderer_platform();
 
+    #if !defined(BUILD_HEADLESS)
     g_ctx.window = SDL_CreateWindow(g_ctx.app_desc.title, SDL_WINDOWPOS_CENTERED,SDL_WINDOWPOS_CENTERED,
         g_ctx.app_desc.window_size.x,g_ctx.app_desc.window_size.y, WINDOW_FLAGS);
     if(!g_ctx.window)
         fatal_error("Failed to create application window: %s", SDL_GetError());
     SDL_SetWindowMinimumSize(g_ctx.window, g_ctx.app_desc.window_min.x,g_ctx.app_desc.window_min.y);
+    #endif // !BUILD_HEADLESS
 
     g_ctx.base_path = SDL_GetBasePath();
 
@@ -338,6 +396,12 @@ INTERNAL void main_init(void)
     td.data   = NULL;
     g_ctx.screen = create_texture(td);
 
+    // Start before the app is initialized so the RNG is seeded before anything uses it.
+    if(g_ctx.app_desc.replay_input)
+        start_input_replay(g_ctx.app_desc.replay_input);
+    else if(g_ctx.app_desc.record_input)
+        start_input_recording(g_ctx.app_desc.record_input, NK_CAST(nkU32, SDL_GetPerformanceCounter()));
+
     app_init();
 
     g_ctx.running = NK_TRUE;
@@ -347,6 +411,8 @@ INTERNAL void main_quit(void)
 {
     app_quit();
 
+    quit_job_system(); // Shutdown first so no jobs are left running whilst the other systems go away.
+
     free_texture(g_ctx.screen);
 
     imm_quit();
@@ -359,6 +425,10 @@ INTERNAL void main_quit(void)
     quit_post_process_system();
     quit_render_system();
 
+    nk_name_free_all(); // Last as any names still held by the systems above become invalid.
+
+    quit_memory_system();
+
     SDL_free(g_ctx.base_path);
 
     SDL_DestroyWindow(g_ctx.window);
@@ -366,6 +436,23 @@ INTERNAL void main_quit(void)
     SDL_Quit();
 }
 
+INTERNAL void draw_frame(void)
+{
+    maybe_resize_backbuffer();
+
+    imm_begin_frame();
+    begin_render_frame();
+
+    app_draw();
+
+    end_render_frame();
+    imm_end_frame();
+
+    render_debug_ui_frame();
+
+    present_renderer();
+}
+
 INTERNAL void main_loop(void)
 {
     PERSISTENT nkU64 perf_frequency  = 0;
@@ -376,6 +463,9 @@ INTERNAL void main_loop(void)
 
     nkF32 dt = 1.0f / g_ctx.app_desc.tick_rate; // We use a fixed update rate to keep things deterministic.
 
+    // Done here rather than when drawing so headless builds that skip drawing still get it reset.
+    reset_frame_arena();
+
     if(perf_frequency == 0)
     {
         perf_frequency = SDL_GetPerformanceFrequency();
@@ -383,7 +473,9 @@ INTERNAL void main_loop(void)
     }
 
     // Just confirm our fullscreen state is accurate.
+    #if !defined(BUILD_HEADLESS)
     g_ctx.fullscreen = NK_CHECK_FLAGS(SDL_GetWindowFlags(g_ctx.window), SDL_WINDOW_FULLSCREEN|SDL_WINDOW_FULLSCREEN);
+    #endif // !BUILD_HEADLESS
 
     SDL_Event event;
     while(SDL_PollEvent(&event))
@@ -420,7 +512,21 @@ INTERNAL void main_loop(void)
         }
     }
 
-    while(update_timer >= dt)
+    process_main_thread_jobs();
+
+    // When running flat out there's no timing involved, every time round the loop is one tick.
+    #if defined(BUILD_HEADLESS)
+    if(g_ctx.app_desc.headless_rate <= 0.0f)
+    {
+        update_timer = dt;
+    }
+    #endif // BUILD_HEADLESS
+
+    nkS32 tick_count = 0;
+
+    nkS32 max_ticks = (g_ctx.app_desc.max_ticks > 0) ? g_ctx.app_desc.max_ticks : NK_S32_MAX;
+
+    while(update_timer >= dt && tick_count < max_ticks)
     {
         update_input_state();
 
@@ -436,21 +542,39 @@ INTERNAL void main_loop(void)
         g_ctx.ticks++;
 
         update_timer -= dt;
-    }
 
-    maybe_resize_backbuffer();
-
-    imm_begin_frame();
-    begin_render_frame();
+        tick_count++;
+    }
 
-    app_draw();
+    // If we still owe ticks after a hitch then drop them, otherwise the catch-up frame takes so long it causes another
+    // hitch and we never recover. Only the part of a tick that's left is kept so the alpha carries on smoothly.
+    if(update_timer >= dt)
+    {
+        update_timer = fmodf(update_timer, dt);
+    }
 
-    end_render_frame();
-    imm_end_frame();
+    g_ctx.tick_alpha = nk_clamp(update_timer / dt, 0.0f, 1.0f);
 
-    render_debug_ui_frame();
+    // There's nothing to see in headless builds so we skip drawing unless asked to (to profile the CPU side of drawing
+    // against the stub renderer). If we're stepping with real time and there was no tick due then give the time back
+    // rather than spinning.
+    #if defined(BUILD_HEADLESS)
+    if(g_ctx.app_desc.headless_draw)
+    {
+        draw_frame();
+    }
+    else if(tick_count == 0)
+    {
+        SDL_Delay(1);
+    }
+    #else
+    draw_frame();
 
-    present_renderer();
+    // The browser drives our frames so we don't want to be sleeping on web.
+    #if !defined(BUILD_WEB)
+    limit_frame_rate();
+    #endif // !BUILD_WEB
+    #endif // BUILD_HEADLESS
 
     end_counter = SDL_GetPerformanceCounter();
     elapsed_counter = end_counter - last_counter;
@@ -458,20 +582,26 @@ INTERNAL void main_loop(void)
 
     nkF32 elapsed_time = NK_CAST(nkF32,elapsed_counter) / NK_CAST(nkF32,perf_frequency);
 
+    #if defined(BUILD_HEADLESS)
+    update_timer += elapsed_time * g_ctx.app_desc.headless_rate;
+    #else
     update_timer += elapsed_time;
+    #endif // BUILD_HEADLESS
 
-    #if defined(BUILD_DEBUG)
+    #if defined(BUILD_DEBUG) && !defined(BUILD_HEADLESS)
     nkF32 current_fps = NK_CAST(nkF32,perf_frequency) / NK_CAST(nkF32,elapsed_counter);
     nkChar title_buffer[1024] = NK_ZERO_MEM;
     snprintf(title_buffer, NK_ARRAY_SIZE(title_buffer), "%s (FPS: %f)", g_ctx.app_desc.title, current_fps);
     SDL_SetWindowTitle(g_ctx.window, title_buffer);
-    #endif // BUILD_DEBUG
+    #endif // BUILD_DEBUG && !BUILD_HEADLESS
 
     // The window starts out hidden, after the first draw we unhide the window as this looks quite clean.
+    #if !defined(BUILD_HEADLESS)
     if(NK_CHECK_FLAGS(SDL_GetWindowFlags(g_ctx.window), SDL_WINDOW_HIDDEN))
     {
         SDL_ShowWindow(g_ctx.window);
     }
+    #endif // !BUILD_HEADLESS
 }
 
 // Different main function flow for native desktop and web builds.
@@ -481,11 +611,23 @@ int main(int argc, char** argv)
 {
     app_main(&g_ctx.app_desc);
 
+    // Command line options override whatever the app asked for.
+    for(nkS32 i=1; i<argc-1; ++i)
+    {
+        if(strcmp(argv[i], "-record") == 0) g_ctx.app_desc.record_input = argv[++i];
+        else if(strcmp(argv[i], "-replay") == 0) g_ctx.app_desc.replay_input = argv[++i];
+    }
+
+    // Headless builds have no window or audio settings worth saving.
     main_init();
+    #if !defined(BUILD_HEADLESS)
     load_program_state();
+    #endif // !BUILD_HEADLESS
     while(g_ctx.running)
         main_loop();
+    #if !defined(BUILD_HEADLESS)
     save_program_state();
+    #endif // !BUILD_HEADLESS
     main_quit();
 
     return 0;
@@ -574,11 +716,14 @@ GLOBAL void fatal_error(const nkChar* fmt, ...)
     vsnprintf(message_buffer, NK_ARRAY_SIZE(message_buffer), fmt, args);
     va_end(args);
 
-    #if defined(BUILD_DEBUG)
+    // Headless builds are likely running somewhere without a display, so the log is the only place errors can go.
+    #if defined(BUILD_DEBUG) || defined(BUILD_HEADLESS)
     fprintf(stderr, "%s\n", message_buffer);
-    #endif // BUILD_DEBUG
+    #endif // BUILD_DEBUG || BUILD_HEADLESS
 
+    #if !defined(BUILD_HEADLESS)
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Fatal Error", message_buffer, g_ctx.window);
+    #endif // !BUILD_HEADLESS
 
     abort();
 }
@@ -593,21 +738,28 @@ GLOBAL void user_error(const nkChar* fmt, ...)
     vsnprintf(message_buffer, NK_ARRAY_SIZE(message_buffer), fmt, args);
     va_end(args);
 
-    #if defined(BUILD_DEBUG)
+    // Headless builds are likely running somewhere without a display, so the log is the only place errors can go.
+    #if defined(BUILD_DEBUG) || defined(BUILD_HEADLESS)
     fprintf(stderr, "%s\n", message_buffer);
-    #endif // BUILD_DEBUG
+    #endif // BUILD_DEBUG || BUILD_HEADLESS
 
+    #if !defined(BUILD_HEADLESS)
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", message_buffer, g_ctx.window);
+    #endif // !BUILD_HEADLESS
 }
 
 GLOBAL iPoint get_window_size(void)
 {
+    #if defined(BUILD_HEADLESS)
+    return g_ctx.app_desc.window_size; // There's no window so just report what it would have been.
+    #else
     nkS32 width,height;
     SDL_GetWindowSize(g_ctx.window, &width,&height);
     iPoint size;
     size.x = width;
     size.y = height;
     return size;
+    #endif // BUILD_HEADLESS
 }
 
 GLOBAL nkS32 get_window_width(void)
@@ -620,6 +772,15 @@ GLOBAL nkS32 get_window_height(void)
     return get_window_size().y;
 }
 
+GLOBAL nkF32 get_refresh_rate(void)
+{
+    // Not every platform reports it, so assume the most common rate if we don't know.
+    SDL_DisplayMode mode;
+    if(SDL_GetWindowDisplayMode(g_ctx.window, &mode) < 0 || mode.refresh_rate <= 0)
+        return 60.0f;
+    return NK_CAST(nkF32, mode.refresh_rate);
+}
+
 GLOBAL Texture get_screen(void)
 {
     return ((g_ctx.app_desc.screen_mode == ScreenMode_Window) ? BACKBUFFER : g_ctx.screen);
@@ -693,4 +854,9 @@ GLOBAL nkU64 get_elapsed_ticks(void)
     return g_ctx.ticks;
 }
 
+GLOBAL nkF32 get_tick_alpha(void)
+{
+    return g_ctx.tick_alpha;
+}
+
 /*////////////////////////////////////////////////////////////////////////////*/
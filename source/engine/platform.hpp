@@ -9,6 +9,7 @@ GLOBAL void     user_error        (const nkChar* fmt, ...);
 GLOBAL iPoint   get_window_size   (void);
 GLOBAL nkS32    get_window_width  (void);
 GLOBAL nkS32    get_window_height (void);
+GLOBAL nkF32    get_refresh_rate  (void);
 GLOBAL Texture  get_screen        (void);
 GLOBAL iPoint   get_screen_size   (void);
 GLOBAL nkS32    get_screen_width  (void);
@@ -20,5 +21,6 @@ GLOBAL nkBool   is_cursor_visible (void);
 GLOBAL nkU64    get_system_time_ms(void);
 GLOBAL nkU64    get_system_time_us(void);
 GLOBAL nkU64    get_elapsed_ticks (void);
+GLOBAL nkF32    get_tick_alpha    (void); // How far we are between the last tick and the next [0-1], for interpolating when drawing.
 
 /*////////////////////////////////////////////////////////////////////////////*/
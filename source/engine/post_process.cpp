@@ -1,35 +1,356 @@
 /*////////////////////////////////////////////////////////////////////////////*/
 
-INTERNAL constexpr nkU32 MAX_POST_PROCESS_PASSES = 32;
+INTERNAL constexpr nkU32 MAX_POST_PROCESS_PASSES  =  32;
+INTERNAL constexpr nkU64 POST_PROCESS_TARGET_LIFE = 120; // Frames a pooled target can go unused before it gets freed.
+INTERNAL constexpr nkS32 POST_PROCESS_INPUT_INDEX =  -2; // Resolved index for effect inputs that read POST_PROCESS_INPUT.
+INTERNAL constexpr nkS32 MAX_POST_PROCESS_MIPS    =   8; // One for each of the effect texture slots.
+
+// The effect chain is treated as a small render graph. Every effect writes into a transient target taken from a pool
+// keyed by size and format, and that target gets handed back to the pool as soon as the last effect that reads from it
+// has run. This means effects with different output sizes no longer cause the targets to be resized back and forth,
+// and the number of targets alive at once is only as many as the chain actually needs.
+struct PostProcessTarget
+{
+    Texture       texture;
+    nkS32         width;
+    nkS32         height;
+    TextureFormat format;
+    nkBool        in_use;
+    nkU64         last_used; // The frame the target was last acquired on.
+};
+
+struct FusedShader
+{
+    nkU64  signature; // Hash of the fused code of every effect in the run.
+    Shader shader;
+};
+
+struct NoiseTexture
+{
+    nkU64   signature; // Hash of the description the texture was baked from.
+    Texture texture;
+};
 
 struct PostProcess
 {
     nkStack<PostProcessEffect,MAX_POST_PROCESS_PASSES> effects;
-    Texture                                            targets[2];
+    nkArray<PostProcessTarget>                         targets;
+    nkArray<FusedShader>                               fused_shaders;
+    nkArray<NoiseTexture>                              noise_textures;
+    nkU64                                              frame;
+
+    // Storage for the built-in effects, these are indexed by the effect's position in the stack.
+    nkChar                                             generated_names[MAX_POST_PROCESS_PASSES][64];
+    nkVec4                                             generated_uniforms[MAX_POST_PROCESS_PASSES];
+    Shader                                             kawase_down;
+    Shader                                             kawase_up;
 };
 
 INTERNAL PostProcess g_pp;
 
-GLOBAL void init_post_process_system(void)
+INTERNAL Texture acquire_post_process_target(nkS32 width, nkS32 height, TextureFormat format)
 {
+    for(auto& target: g_pp.targets)
+    {
+        if(!target.in_use && target.width == width && target.height == height && target.format == format)
+        {
+            target.in_use = NK_TRUE;
+            target.last_used = g_pp.frame;
+            return target.texture;
+        }
+    }
+
     TextureDesc texture_desc;
     texture_desc.type   = TextureType_2D;
-    texture_desc.format = TextureFormat_RGBA;
-    texture_desc.width  = get_window_width();
-    texture_desc.height = get_window_height();
+    texture_desc.format = format;
+    texture_desc.width  = width;
+    texture_desc.height = height;
+
+    PostProcessTarget target;
+    target.texture   = create_texture(texture_desc);
+    target.width     = width;
+    target.height    = height;
+    target.format    = format;
+    target.in_use    = NK_TRUE;
+    target.last_used = g_pp.frame;
+
+    nk_array_append(&g_pp.targets, target);
+
+    return target.texture;
+}
+
+INTERNAL void release_post_process_target(Texture texture)
+{
+    for(auto& target: g_pp.targets)
+    {
+        if(target.texture == texture)
+        {
+            target.in_use = NK_FALSE;
+            return;
+        }
+    }
+}
+
+// Returns the index of the most recent effect before the given index with a matching name, or -1 if there isn't one.
+INTERNAL nkS32 find_post_process_effect(const nkChar* name, nkU32 before)
+{
+    for(nkS32 i=NK_CAST(nkS32,before)-1; i>=0; --i)
+    {
+        const nkChar* effect_name = g_pp.effects.data[i].name;
+        if(effect_name && strcmp(effect_name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Fused Effects ==============================================================
+
+// The generated shaders are built from a prologue and epilogue for the current backend with a function per fused effect
+// in between. Every fused effect gets one vec4 of parameters from the PostProcessFused uniform block (slot 1).
+
+#if defined(NK_OS_WIN32)
+INTERNAL constexpr const nkChar* FUSED_SHADER_PROLOGUE =
+    "Texture2D    u_texture;\n"
+    "SamplerState u_sampler;\n"
+    "cbuffer Imm: register(b0)\n"
+    "{\n"
+    "    float4x4 u_projection;\n"
+    "    float4x4 u_view;\n"
+    "    float4x4 u_model;\n"
+    "    bool     u_usetex;\n"
+    "};\n"
+    "cbuffer PostProcessFused: register(b1)\n"
+    "{\n"
+    "    float4 u_params[32];\n"
+    "};\n"
+    "#define vec2  float2\n"
+    "#define vec3  float3\n"
+    "#define vec4  float4\n"
+    "#define mix   lerp\n"
+    "#define fract frac\n"
+    "struct VSInput\n"
+    "{\n"
+    "    float4 position  : POSITION;\n"
+    "    float4 normal    : NORMAL;\n"
+    "    float4 color     : COLOR;\n"
+    "    float4 texcoord  : TEXCOORD;\n"
+    "    float4 userdata0 : USERDATA0;\n"
+    "    float4 userdata1 : USERDATA1;\n"
+    "    float4 userdata2 : USERDATA2;\n"
+    "    float4 userdata3 : USERDATA3;\n"
+    "};\n"
+    "struct PSInput\n"
+    "{\n"
+    "    float4 position : SV_POSITION;\n"
+    "    float2 texcoord : TEXCOORD;\n"
+    "};\n"
+    "PSInput vs_main(VSInput input)\n"
+    "{\n"
+    "    PSInput output;\n"
+    "    output.position = mul(u_projection, mul(u_view, mul(u_model, input.position)));\n"
+    "    output.texcoord = input.texcoord.xy;\n"
+    "    return output;\n"
+    "}\n";
+INTERNAL constexpr const nkChar* FUSED_SHADER_MAIN_BEGIN =
+    "float4 ps_main(PSInput input) : SV_TARGET\n"
+    "{\n"
+    "    float2 texcoord = input.texcoord;\n"
+    "    float4 color = u_texture.Sample(u_sampler, texcoord);\n";
+INTERNAL constexpr const nkChar* FUSED_SHADER_MAIN_END =
+    "    return color;\n"
+    "}\n";
+#else
+INTERNAL constexpr const nkChar* FUSED_SHADER_PROLOGUE =
+    "uniform sampler2D u_texture;\n"
+    "layout(std140) uniform Imm\n"
+    "{\n"
+    "    mat4 u_projection;\n"
+    "    mat4 u_view;\n"
+    "    mat4 u_model;\n"
+    "    bool u_usetex;\n"
+    "};\n"
+    "layout(std140) uniform PostProcessFused\n"
+    "{\n"
+    "    vec4 u_params[32];\n"
+    "};\n"
+    "#ifdef VERT_SHADER\n"
+    "layout (location = 0) in vec4 i_position;\n"
+    "layout (location = 3) in vec4 i_texcoord;\n"
+    "out vec2 v_texcoord;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = u_projection * u_view * u_model * i_position;\n"
+    "    v_texcoord = i_texcoord.xy;\n"
+    "}\n"
+    "#endif\n"
+    "#ifdef FRAG_SHADER\n"
+    "in vec2 v_texcoord;\n"
+    "out vec4 o_fragcolor;\n";
+INTERNAL constexpr const nkChar* FUSED_SHADER_MAIN_BEGIN =
+    "void main()\n"
+    "{\n"
+    "    vec2 texcoord = v_texcoord;\n"
+    "    vec4 color = texture(u_texture, texcoord);\n";
+INTERNAL constexpr const nkChar* FUSED_SHADER_MAIN_END =
+    "    o_fragcolor = color;\n"
+    "}\n"
+    "#endif\n";
+#endif // NK_OS_WIN32
+
+INTERNAL nkBool is_post_process_effect_fusable(const PostProcessEffect& effect)
+{
+    return (effect.fused_code && !effect.effect && effect.output_width == 0 && effect.output_height == 0 &&
+            effect.output_scale == 0.0f && !effect.output_match && effect.input_mips == 0);
+}
+
+INTERNAL nkU64 get_fused_shader_signature(nkU32 first, nkU32 last)
+{
+    nkU64 signature = FNV1A_OFFSET_BASIS;
+    for(nkU32 i=first; i<=last; ++i)
+    {
+        const nkChar* code = g_pp.effects.data[i].fused_code;
+        signature = hash_fnv1a(code, strlen(code)+1, signature); // Include the null-terminator to separate the effects.
+    }
+    return signature;
+}
 
-    g_pp.targets[0] = create_texture(texture_desc);
-    g_pp.targets[1] = create_texture(texture_desc);
+// Returns the generated shader for the run of fused effects, compiling it if this combination hasn't been seen before.
+// This is only called when the chain is performed, as that's the only point the runs are known for sure (later effects
+// reading an earlier one by name can split a run), so a chain only compiles the shaders it actually uses, once.
+INTERNAL Shader get_fused_shader(nkU32 first, nkU32 last)
+{
+    nkU64 signature = get_fused_shader_signature(first, last);
+
+    for(auto& fused_shader: g_pp.fused_shaders)
+    {
+        if(fused_shader.signature == signature)
+        {
+            return fused_shader.shader;
+        }
+    }
+
+    nkString source = FUSED_SHADER_PROLOGUE;
+    for(nkU32 i=first; i<=last; ++i)
+    {
+        nkString function = format_string("vec4 fused_effect_%u(vec4 color, vec2 texcoord, vec4 params)\n{\n%s\nreturn color;\n}\n",
+            i-first, g_pp.effects.data[i].fused_code);
+        nk_string_append(&source, &function);
+    }
+    nk_string_append(&source, FUSED_SHADER_MAIN_BEGIN);
+    for(nkU32 i=first; i<=last; ++i)
+    {
+        nkString call = format_string("    color = fused_effect_%u(color, texcoord, u_params[%u]);\n", i-first, i-first);
+        nk_string_append(&source, &call);
+    }
+    nk_string_append(&source, FUSED_SHADER_MAIN_END);
+
+    ShaderDesc shader_desc;
+    shader_desc.data  = source.cstr;
+    shader_desc.bytes = source.length;
+    shader_desc.uniforms[0] = { "Imm",              UniformType_Buffer,  0 };
+    shader_desc.uniforms[1] = { "PostProcessFused", UniformType_Buffer,  1 };
+    shader_desc.uniforms[2] = { "u_texture",        UniformType_Texture, 0 };
+    shader_desc.uniform_count = 3;
+
+    FusedShader fused_shader;
+    fused_shader.signature = signature;
+    fused_shader.shader = create_shader(shader_desc);
+    nk_array_append(&g_pp.fused_shaders, fused_shader);
+
+    return fused_shader.shader;
+}
+
+// Returns the last effect in the run of fused effects starting at first. The named array says which effects have their
+// outputs read by name, those have to end a run as their output needs to actually exist.
+INTERNAL nkU32 find_fused_run_end(nkU32 first, const nkBool* named)
+{
+    nkU32 last = first;
+    if(is_post_process_effect_fusable(g_pp.effects.data[first]))
+    {
+        while(last+1 < g_pp.effects.size && !named[last] && is_post_process_effect_fusable(g_pp.effects.data[last+1]))
+        {
+            last++;
+        }
+    }
+    return last;
+}
+
+INTERNAL void draw_post_process_quad(nkF32 w, nkF32 h)
+{
+    imm_begin(DrawMode_TriangleStrip);
+    imm_position(0.0f,h   ); imm_texcoord(0.0f,0.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
+    imm_position(0.0f,0.0f); imm_texcoord(0.0f,1.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
+    imm_position(w,   h   ); imm_texcoord(1.0f,0.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
+    imm_position(w,   0.0f); imm_texcoord(1.0f,1.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
+    imm_end();
+}
+
+// Bilinear resample using the default imm shader, used for building mip chains.
+INTERNAL void resample_post_process_target(Texture src, Texture dst)
+{
+    nkF32 dw = NK_CAST(nkF32, get_texture_width(dst));
+    nkF32 dh = NK_CAST(nkF32, get_texture_height(dst));
+
+    imm_set_projection(nk_orthographic(0,dw,dh,0,-1,1));
+    imm_set_viewport(0.0f,0.0f,dw,dh);
+    imm_set_color_target(dst);
+    imm_set_texture(src,0);
+    imm_set_sampler(imm_get_def_sampler(ImmSampler_ClampLinear),0);
+    imm_set_shader(NULL);
+
+    draw_post_process_quad(dw,dh);
+}
+
+INTERNAL Shader load_kawase_shader(const nkChar* name)
+{
+    ShaderDesc shader_desc;
+    shader_desc.uniforms[0] = { "Imm",       UniformType_Buffer,  0 };
+    shader_desc.uniforms[1] = { "Kawase",    UniformType_Buffer,  1 };
+    shader_desc.uniforms[2] = { "u_texture", UniformType_Texture, 0 };
+    shader_desc.uniform_count = 3;
+    return asset_manager_load<Shader>(name, &shader_desc);
+}
+
+GLOBAL void init_post_process_system(void)
+{
+    nk_array_reserve(&g_pp.targets, 8);
 }
 
 GLOBAL void quit_post_process_system(void)
 {
-    free_texture(g_pp.targets[0]);
-    free_texture(g_pp.targets[1]);
+    for(auto& target: g_pp.targets)
+        free_texture(target.texture);
+    nk_array_free(&g_pp.targets);
+
+    for(auto& fused_shader: g_pp.fused_shaders)
+        free_shader(fused_shader.shader);
+    nk_array_free(&g_pp.fused_shaders);
+
+    for(auto& noise_texture: g_pp.noise_textures)
+        free_texture(noise_texture.texture);
+    nk_array_free(&g_pp.noise_textures);
 }
 
 GLOBAL void push_post_process_effect(const PostProcessEffect& effect)
 {
+    // Catch bad input names here rather than every frame when the chain is performed.
+    for(nkS32 i=0,n=NK_ARRAY_SIZE(effect.inputs); i<n; ++i)
+    {
+        const nkChar* input = effect.inputs[i];
+        if(input && strcmp(input, POST_PROCESS_INPUT) != 0 && find_post_process_effect(input, NK_CAST(nkU32,g_pp.effects.size)) < 0)
+        {
+            printf("[PostProcess]: Effect '%s' reads from unknown effect '%s'!\n", (effect.name) ? effect.name : "", input);
+        }
+    }
+
+    if(g_pp.effects.size >= MAX_POST_PROCESS_PASSES)
+    {
+        printf("[PostProcess]: Too many post-process effects, ignoring '%s'!\n", (effect.name) ? effect.name : "");
+        return;
+    }
+
     nk_stack_push(&g_pp.effects, effect);
 }
 
@@ -48,6 +369,67 @@ GLOBAL nkU64 num_post_process_effects(void)
     return g_pp.effects.size;
 }
 
+GLOBAL void push_post_process_resample(const nkChar* name, nkF32 scale)
+{
+    PostProcessEffect effect;
+    effect.name          = name;
+    effect.input_sampler = imm_get_def_sampler(ImmSampler_ClampLinear);
+    effect.output_scale  = scale;
+    push_post_process_effect(effect);
+}
+
+GLOBAL void push_post_process_blur(const nkChar* name, nkS32 iterations, nkF32 offset)
+{
+    NK_ASSERT(iterations > 0);
+
+    if(g_pp.effects.size + (iterations*2) > MAX_POST_PROCESS_PASSES)
+    {
+        printf("[PostProcess]: Not enough room for a blur with %d iterations!\n", iterations);
+        return;
+    }
+
+    if(!g_pp.kawase_down) g_pp.kawase_down = load_kawase_shader("kawase_down.shader");
+    if(!g_pp.kawase_up) g_pp.kawase_up = load_kawase_shader("kawase_up.shader");
+
+    const nkChar* prefix = (name) ? name : "blur";
+
+    nkU32 first_down = NK_CAST(nkU32, g_pp.effects.size);
+
+    for(nkS32 i=0; i<iterations; ++i)
+    {
+        nkU32 slot = NK_CAST(nkU32, g_pp.effects.size);
+        snprintf(g_pp.generated_names[slot], NK_ARRAY_SIZE(g_pp.generated_names[slot]), "%s.down%d", prefix, i);
+        g_pp.generated_uniforms[slot] = { offset, 0.0f, 0.0f, 0.0f };
+
+        PostProcessEffect effect;
+        effect.name          = g_pp.generated_names[slot];
+        effect.effect        = g_pp.kawase_down;
+        effect.input_sampler = imm_get_def_sampler(ImmSampler_ClampLinear);
+        effect.uniforms      = &g_pp.generated_uniforms[slot];
+        effect.uniform_bytes = sizeof(nkVec4);
+        effect.output_scale  = 0.5f;
+        push_post_process_effect(effect);
+    }
+
+    // Each upsample matches the size that the corresponding downsample started from, so we end up back at exactly the
+    // source size even when it isn't a power of two. The final upsample gets the blur's name so it can be read later.
+    for(nkS32 i=iterations-1; i>=0; --i)
+    {
+        nkU32 slot = NK_CAST(nkU32, g_pp.effects.size);
+        snprintf(g_pp.generated_names[slot], NK_ARRAY_SIZE(g_pp.generated_names[slot]), "%s.up%d", prefix, i);
+        g_pp.generated_uniforms[slot] = { offset, 0.0f, 0.0f, 0.0f };
+
+        PostProcessEffect effect;
+        effect.name          = (i == 0) ? name : g_pp.generated_names[slot];
+        effect.effect        = g_pp.kawase_up;
+        effect.input_sampler = imm_get_def_sampler(ImmSampler_ClampLinear);
+        effect.uniforms      = &g_pp.generated_uniforms[slot];
+        effect.uniform_bytes = sizeof(nkVec4);
+        effect.output_match  = g_pp.generated_names[first_down+i];
+        push_post_process_effect(effect);
+    }
+}
+
 GLOBAL Texture perform_post_processing(Texture input)
 {
     // @Improve: Too much casting back and forth, especially on window_get_xxx and texture_get_xxx...
@@ -57,82 +439,268 @@ GLOBAL Texture perform_post_processing(Texture input)
     nkF32 iw = NK_CAST(nkF32, get_texture_width(input));
     nkF32 ih = NK_CAST(nkF32, get_texture_height(input));
 
+    g_pp.frame++;
+
+    // Everything from the previous frame is free to be reused now (including the old final output). Any targets that
+    // haven't been used in a while are freed, this cleans up targets from old window sizes, removed effects, etc.
+    for(nkU64 i=0; i<g_pp.targets.length; )
+    {
+        PostProcessTarget& target = g_pp.targets[i];
+        target.in_use = NK_FALSE;
+        if((g_pp.frame - target.last_used) > POST_PROCESS_TARGET_LIFE)
+        {
+            free_texture(target.texture);
+            nk_array_remove(&g_pp.targets, i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
     Texture src = input;
-    Texture dst = NULL;
 
     imm_reset();
 
     if(g_pp.effects.size > 0)
     {
-        // Resize the source target if it doesn't match the input.
-        nkF32 tw = NK_CAST(nkF32, get_texture_width(g_pp.targets[0]));
-        nkF32 th = NK_CAST(nkF32, get_texture_height(g_pp.targets[0]));
-        if(tw != iw || th != ih)
+        nkU32 effect_count = NK_CAST(nkU32, g_pp.effects.size);
+
+        Texture outputs [MAX_POST_PROCESS_PASSES] = NK_ZERO_MEM;
+        nkBool  released[MAX_POST_PROCESS_PASSES] = NK_ZERO_MEM;
+        nkBool  named   [MAX_POST_PROCESS_PASSES] = NK_ZERO_MEM;
+        nkS32   inputs  [MAX_POST_PROCESS_PASSES][NK_ARRAY_SIZE(PostProcessEffect::inputs)];
+        nkU32   last_use[MAX_POST_PROCESS_PASSES];
+        nkS32   match   [MAX_POST_PROCESS_PASSES];
+        iPoint  sources [MAX_POST_PROCESS_PASSES]; // The size of each effect's source.
+
+        // Work out the inputs for each effect and how long each effect's output needs to be kept alive for. Each effect
+        // always reads the output of the one before it, plus any named inputs. The final output is never released.
+        for(nkU32 i=0; i<effect_count; ++i)
         {
-            resize_texture(g_pp.targets[0], NK_CAST(nkS32,iw),NK_CAST(nkS32,ih));
-            resize_texture(g_pp.targets[1], NK_CAST(nkS32,iw),NK_CAST(nkS32,ih));
-        }
+            last_use[i] = (i+1 < effect_count) ? i+1 : MAX_POST_PROCESS_PASSES;
 
-        imm_set_projection(nk_orthographic(0,iw,ih,0,-1,1));
-        imm_set_viewport(0.0f,0.0f,iw,ih);
+            const PostProcessEffect& effect = g_pp.effects.data[i];
 
-        // Copy the input into the first target.
-        imm_set_color_target(g_pp.targets[0]);
-        imm_set_texture(input);
-        imm_set_shader(NULL);
-        imm_begin(DrawMode_TriangleStrip);
-        imm_position(0.0f,ih  ); imm_texcoord(0.0f,0.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
-        imm_position(0.0f,0.0f); imm_texcoord(0.0f,1.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
-        imm_position(iw,  ih  ); imm_texcoord(1.0f,0.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
-        imm_position(iw,  0.0f); imm_texcoord(1.0f,1.0f); imm_color(1.0f,1.0f,1.0f,1.0f);
-        imm_end();
+            match[i] = -1;
+            if(effect.output_match)
+            {
+                if(strcmp(effect.output_match, POST_PROCESS_INPUT) == 0)
+                    match[i] = POST_PROCESS_INPUT_INDEX;
+                else
+                    match[i] = find_post_process_effect(effect.output_match, i);
+            }
 
-        src = g_pp.targets[0];
-        dst = g_pp.targets[1];
+            for(nkS32 j=0,n=NK_ARRAY_SIZE(effect.inputs); j<n; ++j)
+            {
+                inputs[i][j] = -1;
+                if(!effect.inputs[j]) continue;
+                if(strcmp(effect.inputs[j], POST_PROCESS_INPUT) == 0)
+                {
+                    inputs[i][j] = POST_PROCESS_INPUT_INDEX;
+                }
+                else
+                {
+                    nkS32 index = find_post_process_effect(effect.inputs[j], i);
+                    if(index >= 0)
+                    {
+                        inputs[i][j] = index;
+                        last_use[index] = nk_max(last_use[index], i);
+                        named[index] = NK_TRUE;
+                    }
+                }
+            }
+        }
 
-        for(nkU32 i=0; i<g_pp.effects.size; ++i)
+        // The first effect reads straight from the input, there's no need to copy it into a target first. Each pass is
+        // either a single effect or a run of fused effects, in which case only the last effect of the run has an output.
+        for(nkU32 i=0; i<effect_count; )
         {
+            nkU32 last = find_fused_run_end(i, named);
+
             const PostProcessEffect& effect = g_pp.effects.data[i];
+            nkBool fused = is_post_process_effect_fusable(effect);
+
+            iPoint source_size = get_texture_size(src);
+            for(nkU32 j=i; j<=last; ++j)
+                sources[j] = source_size;
 
-            // Resize the output target if necessary.
             nkF32 dw = (effect.output_width == 0.0f) ? iw : effect.output_width;
             nkF32 dh = (effect.output_height == 0.0f) ? ih : effect.output_height;
-            if(dw != get_texture_width(dst) || dh != get_texture_height(dst))
+
+            if(match[i] == POST_PROCESS_INPUT_INDEX)
+            {
+                dw = iw;
+                dh = ih;
+            }
+            else if(match[i] >= 0)
+            {
+                dw = NK_CAST(nkF32, sources[match[i]].x);
+                dh = NK_CAST(nkF32, sources[match[i]].y);
+            }
+            else if(effect.output_scale > 0.0f)
             {
-                resize_texture(dst, NK_CAST(nkS32,dw),NK_CAST(nkS32,dh));
+                dw = nk_max(1.0f, roundf(NK_CAST(nkF32, source_size.x) * effect.output_scale));
+                dh = nk_max(1.0f, roundf(NK_CAST(nkF32, source_size.y) * effect.output_scale));
             }
 
+            // Build the mip chain of the source if the effect wants one, each level is half the size of the last.
+            Texture mips[MAX_POST_PROCESS_MIPS] = NK_ZERO_MEM;
+            nkS32 mip_count = nk_clamp(effect.input_mips, 0, MAX_POST_PROCESS_MIPS);
+            for(nkS32 j=0; j<mip_count; ++j)
+            {
+                Texture mip_src = (j == 0) ? src : mips[j-1];
+                nkS32 mw = nk_max(1, get_texture_width(mip_src) / 2);
+                nkS32 mh = nk_max(1, get_texture_height(mip_src) / 2);
+                mips[j] = acquire_post_process_target(mw,mh, effect.output_format);
+                resample_post_process_target(mip_src, mips[j]);
+            }
+
+            Texture dst = acquire_post_process_target(NK_CAST(nkS32,dw),NK_CAST(nkS32,dh), g_pp.effects.data[last].output_format);
+
             imm_set_projection(nk_orthographic(0,dw,dh,0,-1,1));
             imm_set_viewport(0.0f,0.0f,dw,dh);
             imm_set_color_target(dst);
             imm_set_texture(src,0);
             imm_set_sampler(effect.input_sampler,0);
-            imm_set_shader(effect.effect);
 
-            for(nkS32 j=0,n1=NK_ARRAY_SIZE(effect.textures); j<n1; ++j)
-                if(effect.textures[j])
-                    imm_set_texture(effect.textures[j],j+1);
-            for(nkS32 j=0,n1=NK_ARRAY_SIZE(effect.samplers); j<n1; ++j)
-                if(effect.samplers[j])
-                    imm_set_sampler(effect.samplers[j],j+1);
+            nkVec4 fused_params[MAX_POST_PROCESS_PASSES]; // Needs to stay alive until imm_end.
+
+            if(fused)
+            {
+                imm_set_shader(get_fused_shader(i, last));
+
+                for(nkU32 j=i; j<=last; ++j)
+                {
+                    fused_params[j-i] = g_pp.effects.data[j].fused_params;
+                }
+                imm_set_uniforms(fused_params, sizeof(fused_params), 1);
+            }
+            else
+            {
+                imm_set_shader(effect.effect);
+
+                for(nkS32 j=0,n1=NK_ARRAY_SIZE(effect.textures); j<n1; ++j)
+                {
+                    Texture texture = effect.textures[j];
+                    if(inputs[i][j] == POST_PROCESS_INPUT_INDEX)
+                        texture = input;
+                    else if(inputs[i][j] >= 0)
+                        texture = outputs[inputs[i][j]];
+                    if(j < mip_count)
+                        texture = mips[j];
+                    if(texture)
+                        imm_set_texture(texture,j+1);
+                }
+                for(nkS32 j=0,n1=NK_ARRAY_SIZE(effect.samplers); j<n1; ++j)
+                    if(effect.samplers[j])
+                        imm_set_sampler(effect.samplers[j],j+1);
+
+                if(effect.uniforms)
+                {
+                    imm_set_uniforms(effect.uniforms, effect.uniform_bytes, 1);
+                }
+            }
+
+            draw_post_process_quad(dw,dh);
+
+            // Only the uniform slot needs clearing, the other state is set again by the next pass.
+            imm_set_uniforms(NULL, 0, 1);
 
-            if(effect.uniforms)
+            for(nkS32 j=0; j<mip_count; ++j)
             {
-                imm_set_uniforms(effect.uniforms, effect.uniform_bytes, 1);
+                release_post_process_target(mips[j]);
             }
 
-            imm_begin(DrawMode_TriangleStrip);
-            imm_position(0.0f,dh  ); imm_texcoord(0.0f,0.0f);
-            imm_position(0.0f,0.0f); imm_texcoord(0.0f,1.0f);
-            imm_position(dw,  dh  ); imm_texcoord(1.0f,0.0f);
-            imm_position(dw,  0.0f); imm_texcoord(1.0f,1.0f);
-            imm_end();
+            outputs[last] = dst;
+            src = dst;
+
+            // Hand back any targets that nothing later in the chain reads from.
+            for(nkU32 j=0; j<=last; ++j)
+            {
+                if(outputs[j] && !released[j] && last_use[j] <= last)
+                {
+                    release_post_process_target(outputs[j]);
+                    released[j] = NK_TRUE;
+                }
+            }
 
-            NK_SWAP(Texture, src,dst);
+            i = last+1;
         }
     }
 
     return src;
 }
 
+struct NoiseBake
+{
+    const NoiseTextureDesc* desc;
+    nkF32*                  values;
+    nkU8*                   pixels;
+};
+
+INTERNAL void bake_noise_rows(nkS32 begin, nkS32 end, void* user_data)
+{
+    NoiseBake* bake = NK_CAST(NoiseBake*, user_data);
+    const NoiseTextureDesc& desc = *bake->desc;
+
+    FbmDesc fbm;
+    fbm.octaves    = desc.octaves;
+    fbm.lacunarity = desc.lacunarity;
+    fbm.gain       = desc.gain;
+
+    periodic_fbm_perlin_noise_2d_grid_rows(bake->values, desc.width, desc.height, begin, end, desc.period_x, desc.period_y, fbm);
+
+    // Same mapping as perlin_noise_2d_normalized so the texture matches what sampling the noise directly would give.
+    for(nkU64 i=NK_CAST(nkU64,begin)*desc.width, n=NK_CAST(nkU64,end)*desc.width; i<n; ++i)
+    {
+        nkF32 value = nk_clamp((bake->values[i] + 1.0f) * 0.5f, 0.0f, 1.0f);
+        bake->pixels[i] = NK_CAST(nkU8, value * 255.0f + 0.5f);
+    }
+}
+
+GLOBAL Texture get_noise_texture(const NoiseTextureDesc& desc)
+{
+    NK_ASSERT(desc.width > 0 && desc.height > 0);
+
+    // The description is all 32-bit fields so there's no padding to worry about when hashing it.
+    nkU64 signature = hash_fnv1a(&desc, sizeof(desc));
+
+    for(auto& noise_texture: g_pp.noise_textures)
+    {
+        if(noise_texture.signature == signature)
+        {
+            return noise_texture.texture;
+        }
+    }
+
+    nkU64 pixel_count = NK_CAST(nkU64,desc.width) * desc.height;
+
+    NoiseBake bake;
+    bake.desc   = &desc;
+    bake.values = NK_MALLOC_TYPES(nkF32, pixel_count);
+    bake.pixels = NK_MALLOC_TYPES(nkU8, pixel_count);
+    if(!bake.values || !bake.pixels)
+        fatal_error("Failed to allocate noise texture pixels!");
+    NK_DEFER(NK_FREE(bake.values));
+    NK_DEFER(NK_FREE(bake.pixels));
+
+    // Batches of a few rows so each thread gets several to balance out, but each still covers a decent run of pixels.
+    nkS32 batch_size = nk_max(1, desc.height / (get_job_thread_count() * 4));
+    parallel_for(desc.height, batch_size, bake_noise_rows, &bake);
+
+    TextureDesc texture_desc;
+    texture_desc.format = TextureFormat_R;
+    texture_desc.width  = desc.width;
+    texture_desc.height = desc.height;
+    texture_desc.data   = bake.pixels;
+
+    NoiseTexture noise_texture;
+    noise_texture.signature = signature;
+    noise_texture.texture   = create_texture(texture_desc);
+    nk_array_append(&g_pp.noise_textures, noise_texture);
+
+    return noise_texture.texture;
+}
+
 /*////////////////////////////////////////////////////////////////////////////*/
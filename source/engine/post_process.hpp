@@ -4,17 +4,35 @@
 // !!! NOTE: Do NOT set post-process effects in app_draw, only in app_tick! !!!
 // =============================================================================
 
+// Effects can read the outputs of earlier effects in the chain by name, this is how multi-input effects such as bloom
+// get access to their intermediate results. Use POST_PROCESS_INPUT to refer to the original input of the chain.
+INTERNAL constexpr const nkChar* POST_PROCESS_INPUT = "@input";
+
+// Effects that only need the pixel they are given (tints, curves, vignettes, grain, etc.) can provide fused_code instead
+// of an effect shader. Runs of these effects get fused together into a single generated shader, so a chain of them only
+// costs one pass instead of one per effect. A run's shader is generated the first time it's performed and then cached by
+// the run's signature, so pushing the same chain every tick only compiles it once. The code works on `color` (vec4) and
+// can read `texcoord` (vec2) and `params` (the effect's fused_params). The GLSL vec2/vec3/vec4, mix, and fract names are
+// defined for HLSL as well so the same code can be used for both backends. Fused effects can't have their own textures,
+// inputs, or output size, and their outputs can't be read by name (that breaks them out of the run).
 struct PostProcessEffect
 {
     const nkChar* name          = NULL;
     Shader        effect        = NULL;
     Texture       textures[8]   = {};
     Sampler       samplers[8]   = {};
+    const nkChar* inputs[8]     = {}; // Names of earlier effects whose outputs get bound to texture slots 1-8 (takes priority over textures).
     Sampler       input_sampler = {};
     void*         uniforms      = NULL;
     nkU64         uniform_bytes = 0;
     nkS32         output_width  = 0; // 0 == same as the input width.
     nkS32         output_height = 0; // 0 == same as the input height.
+    nkF32         output_scale  = 0.0f; // Scales the size of the effect's source (e.g. 0.5 for half resolution), 0 == use output_width/height.
+    const nkChar* output_match  = NULL; // Name of an earlier effect whose source size this effect's output should match (for undoing downsamples exactly).
+    TextureFormat output_format = TextureFormat_RGBA;
+    nkS32         input_mips    = 0; // Number of successively half-sized copies of the source to generate and bind to texture slots 1-N.
+    const nkChar* fused_code    = NULL;
+    nkVec4        fused_params  = NK_V4_ZERO;
 };
 
 GLOBAL void    init_post_process_system  (void);
@@ -25,4 +43,27 @@ GLOBAL void    clear_post_process_effects(void);
 GLOBAL nkU64   num_post_process_effects  (void);
 GLOBAL Texture perform_post_processing   (Texture input);
 
+// Built-in effects for working at lower resolutions. Resampling is bilinear, so a 0.5 downsample averages 2x2 pixels.
+// The blur is a Dual-Kawase blur, it downsamples the given number of times and then upsamples back to the source size,
+// so the cost mostly depends on the number of iterations rather than the resolution. Increasing the offset spreads the
+// taps further apart for a wider blur at no extra cost.
+GLOBAL void    push_post_process_resample(const nkChar* name, nkF32 scale);
+GLOBAL void    push_post_process_blur    (const nkChar* name, nkS32 iterations, nkF32 offset = 1.0f);
+
+// Tileable fBm Perlin noise baked into a single channel texture, for effects that want noise without evaluating it in the
+// shader (use a repeating sampler). The rows are baked across the job threads. Textures are cached by their description
+// so asking for the same one again is free, they belong to the post-process system so don't free them yourself.
+struct NoiseTextureDesc
+{
+    nkS32 width      = 256;
+    nkS32 height     = 256;
+    nkS32 period_x   = 8; // Noise cells across the texture for the first octave.
+    nkS32 period_y   = 8;
+    nkS32 octaves    = 4;
+    nkF32 lacunarity = 2.0f;
+    nkF32 gain       = 0.5f;
+};
+
+GLOBAL Texture get_noise_texture(const NoiseTextureDesc& desc);
+
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -1,9 +1,635 @@
 /*////////////////////////////////////////////////////////////////////////////*/
 
-#if defined(NK_OS_WIN32)
+#if defined(BUILD_HEADLESS)
+#include "renderer_stub.cpp"
+#elif defined(NK_OS_WIN32)
 #include "renderer_direct3d.cpp"
 #else
 #include "renderer_opengl.cpp"
 #endif
 
+// =============================================================================
+// The public renderer functions forward to the backend. When the render thread
+// is enabled the backend is only ever driven from that thread: commands issued
+// by the game are recorded into a command buffer which gets handed over when
+// presenting, the render thread then replays it and presents whilst the game
+// carries on with the next frame. There are two command buffers so the game is
+// only ever made to wait if it gets more than one frame ahead of the GPU.
+//
+// Create and resize calls have to return results straight away so they are run
+// synchronously on the render thread once it has finished the previous frame.
+// Frees are recorded like everything else so anything drawn earlier on in the
+// frame stays alive until after it has been replayed.
+// =============================================================================
+
+NK_ENUM(RenderCommandType, nkS32)
+{
+    RenderCommandType_CreateBuffer,
+    RenderCommandType_CreateShader,
+    RenderCommandType_CreateSampler,
+    RenderCommandType_CreateTexture,
+    RenderCommandType_CreateRenderPass,
+    RenderCommandType_CreateRenderPipeline,
+    RenderCommandType_FreeBuffer,
+    RenderCommandType_FreeShader,
+    RenderCommandType_FreeSampler,
+    RenderCommandType_FreeTexture,
+    RenderCommandType_FreeRenderPass,
+    RenderCommandType_FreeRenderPipeline,
+    RenderCommandType_UpdateBuffer,
+    RenderCommandType_ResizeTexture,
+    RenderCommandType_ResizeBackbuffer,
+    RenderCommandType_Present,
+    RenderCommandType_SetViewport,
+    RenderCommandType_BeginScissor,
+    RenderCommandType_EndScissor,
+    RenderCommandType_BeginRenderPass,
+    RenderCommandType_EndRenderPass,
+    RenderCommandType_BindPipeline,
+    RenderCommandType_BindBuffer,
+    RenderCommandType_BindTexture,
+    RenderCommandType_DrawArrays,
+    RenderCommandType_DrawElements,
+    RenderCommandType_TOTAL
+};
+
+struct RenderCommand
+{
+    RenderCommandType type;
+    union
+    {
+        struct { const void* desc; void* result;                          } create; // Only ever run synchronously.
+        struct { void* object;                                            } free;
+        struct { Buffer buffer; nkU64 offset; nkU64 bytes; nkBool copied; } update_buffer;
+        struct { Texture texture; nkS32 width; nkS32 height;              } resize_texture;
+        struct { nkF32 x, y, w, h;                                        } rect;
+        struct { RenderPass pass;                                         } begin_render_pass;
+        struct { RenderPipeline pipeline;                                 } bind_pipeline;
+        struct { Buffer buffer; nkS32 slot;                               } bind_buffer;
+        struct { Texture texture; Sampler sampler; nkS32 unit;            } bind_texture;
+        struct { nkU64 vertex_count;                                      } draw_arrays;
+        struct { nkU64 element_count; ElementType type; nkU64 offset;     } draw_elements;
+    };
+};
+
+struct RenderCommandBuffer
+{
+    nkArray<RenderCommand> commands;
+    nkArray<nkU8>          data; // Copies of the data passed to update_buffer, as the caller's memory won't live long enough.
+};
+
+struct RenderThreadContext
+{
+    SDL_Thread*          thread;
+    SDL_mutex*           mutex;
+    SDL_cond*            cond;
+    RenderCommandBuffer  buffers[2];
+    RenderCommandBuffer* pending; // Submitted buffer the render thread has yet to finish replaying.
+    RenderCommand*       call;    // Synchronous command waiting to be run.
+    nkU32                record;  // Index of the buffer currently being recorded into.
+    nkBool               active;
+    nkBool               quit;
+};
+
+INTERNAL RenderThreadContext g_render_thread;
+
+INTERNAL RenderStats g_render_stats_frame; // Stats for the frame currently being issued.
+INTERNAL RenderStats g_render_stats;       // Stats for the last presented frame.
+
+INTERNAL void execute_render_command(const RenderCommand& cmd, const nkU8* data)
+{
+    switch(cmd.type)
+    {
+        case RenderCommandType_CreateBuffer:
+        {
+            *NK_CAST(Buffer*, cmd.create.result) = backend_create_buffer(*NK_CAST(const BufferDesc*, cmd.create.desc));
+        } break;
+        case RenderCommandType_CreateShader:
+        {
+            *NK_CAST(Shader*, cmd.create.result) = backend_create_shader(*NK_CAST(const ShaderDesc*, cmd.create.desc));
+        } break;
+        case RenderCommandType_CreateSampler:
+        {
+            *NK_CAST(Sampler*, cmd.create.result) = backend_create_sampler(*NK_CAST(const SamplerDesc*, cmd.create.desc));
+        } break;
+        case RenderCommandType_CreateTexture:
+        {
+            *NK_CAST(Texture*, cmd.create.result) = backend_create_texture(*NK_CAST(const TextureDesc*, cmd.create.desc));
+        } break;
+        case RenderCommandType_CreateRenderPass:
+        {
+            *NK_CAST(RenderPass*, cmd.create.result) = backend_create_render_pass(*NK_CAST(const RenderPassDesc*, cmd.create.desc));
+        } break;
+        case RenderCommandType_CreateRenderPipeline:
+        {
+            *NK_CAST(RenderPipeline*, cmd.create.result) = backend_create_render_pipeline(*NK_CAST(const RenderPipelineDesc*, cmd.create.desc));
+        } break;
+
+        case RenderCommandType_FreeBuffer:         backend_free_buffer         (NK_CAST(Buffer,         cmd.free.object)); break;
+        case RenderCommandType_FreeShader:         backend_free_shader         (NK_CAST(Shader,         cmd.free.object)); break;
+        case RenderCommandType_FreeSampler:        backend_free_sampler        (NK_CAST(Sampler,        cmd.free.object)); break;
+        case RenderCommandType_FreeTexture:        backend_free_texture        (NK_CAST(Texture,        cmd.free.object)); break;
+        case RenderCommandType_FreeRenderPass:     backend_free_render_pass    (NK_CAST(RenderPass,     cmd.free.object)); break;
+        case RenderCommandType_FreeRenderPipeline: backend_free_render_pipeline(NK_CAST(RenderPipeline, cmd.free.object)); break;
+
+        case RenderCommandType_UpdateBuffer:
+        {
+            void* bytes = (cmd.update_buffer.copied) ? NK_CAST(void*, data + cmd.update_buffer.offset) : NULL;
+            backend_update_buffer(cmd.update_buffer.buffer, bytes, cmd.update_buffer.bytes);
+        } break;
+        case RenderCommandType_ResizeTexture:
+        {
+            backend_resize_texture(cmd.resize_texture.texture, cmd.resize_texture.width, cmd.resize_texture.height);
+        } break;
+
+        case RenderCommandType_ResizeBackbuffer: backend_maybe_resize_backbuffer(); break;
+        case RenderCommandType_Present:          backend_present_renderer();        break;
+
+        case RenderCommandType_SetViewport:     backend_set_viewport(cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h);  break;
+        case RenderCommandType_BeginScissor:    backend_begin_scissor(cmd.rect.x, cmd.rect.y, cmd.rect.w, cmd.rect.h); break;
+        case RenderCommandType_EndScissor:      backend_end_scissor();                                                  break;
+        case RenderCommandType_BeginRenderPass: backend_begin_render_pass(cmd.begin_render_pass.pass);                  break;
+        case RenderCommandType_EndRenderPass:   backend_end_render_pass();                                              break;
+        case RenderCommandType_BindPipeline:    backend_bind_pipeline(cmd.bind_pipeline.pipeline);                      break;
+        case RenderCommandType_BindBuffer:      backend_bind_buffer(cmd.bind_buffer.buffer, cmd.bind_buffer.slot);      break;
+
+        case RenderCommandType_BindTexture:
+        {
+            backend_bind_texture(cmd.bind_texture.texture, cmd.bind_texture.sampler, cmd.bind_texture.unit);
+        } break;
+        case RenderCommandType_DrawArrays:
+        {
+            backend_draw_arrays(cmd.draw_arrays.vertex_count);
+        } break;
+        case RenderCommandType_DrawElements:
+        {
+            backend_draw_elements(cmd.draw_elements.element_count, cmd.draw_elements.type, cmd.draw_elements.offset);
+        } break;
+
+        default:
+        {
+            NK_ASSERT(NK_FALSE); // Unknown render command type!
+        } break;
+    }
+}
+
+INTERNAL void replay_render_command_buffer(RenderCommandBuffer* buffer)
+{
+    NK_ASSERT(buffer);
+    for(nkU64 i=0; i<buffer->commands.length; ++i)
+    {
+        execute_render_command(buffer->commands.data[i], buffer->data.data);
+    }
+}
+
+INTERNAL int render_thread_main(void* user_data)
+{
+    backend_bind_context(NK_TRUE);
+
+    SDL_LockMutex(g_render_thread.mutex);
+    while(!g_render_thread.quit)
+    {
+        // Synchronous calls wait for the previous frame to be replayed before being made, so they never jump ahead of it.
+        if(g_render_thread.call)
+        {
+            SDL_UnlockMutex(g_render_thread.mutex);
+            execute_render_command(*g_render_thread.call, NULL);
+            SDL_LockMutex(g_render_thread.mutex);
+            g_render_thread.call = NULL;
+            SDL_CondBroadcast(g_render_thread.cond);
+        }
+        else if(g_render_thread.pending)
+        {
+            SDL_UnlockMutex(g_render_thread.mutex);
+            replay_render_command_buffer(g_render_thread.pending);
+            SDL_LockMutex(g_render_thread.mutex);
+            g_render_thread.pending = NULL;
+            SDL_CondBroadcast(g_render_thread.cond);
+        }
+        else
+        {
+            SDL_CondWait(g_render_thread.cond, g_render_thread.mutex);
+        }
+    }
+    SDL_UnlockMutex(g_render_thread.mutex);
+
+    backend_bind_context(NK_FALSE);
+
+    return 0;
+}
+
+INTERNAL void record_render_command(const RenderCommand& cmd)
+{
+    nk_array_append(&g_render_thread.buffers[g_render_thread.record].commands, cmd);
+}
+
+// Hands the recorded commands over to the render thread and starts recording into the other buffer.
+INTERNAL void submit_render_command_buffer(void)
+{
+    // Wait if the render thread is still busy with the last buffer.
+    SDL_LockMutex(g_render_thread.mutex);
+    while(g_render_thread.pending)
+        SDL_CondWait(g_render_thread.cond, g_render_thread.mutex);
+    g_render_thread.pending = &g_render_thread.buffers[g_render_thread.record];
+    g_render_thread.record ^= 1;
+    SDL_CondBroadcast(g_render_thread.cond);
+    SDL_UnlockMutex(g_render_thread.mutex);
+
+    // The buffer we switch to was submitted last time, which we know has been fully replayed by this point.
+    RenderCommandBuffer* buffer = &g_render_thread.buffers[g_render_thread.record];
+    nk_array_clear(&buffer->commands);
+    nk_array_clear(&buffer->data);
+}
+
+INTERNAL void run_render_command(RenderCommand* cmd)
+{
+    SDL_LockMutex(g_render_thread.mutex);
+    while(g_render_thread.pending) // Let the render thread finish off the previous frame first.
+        SDL_CondWait(g_render_thread.cond, g_render_thread.mutex);
+    g_render_thread.call = cmd;
+    SDL_CondBroadcast(g_render_thread.cond);
+    while(g_render_thread.call)
+        SDL_CondWait(g_render_thread.cond, g_render_thread.mutex);
+    SDL_UnlockMutex(g_render_thread.mutex);
+}
+
+INTERNAL void run_create_render_command(RenderCommandType type, const void* desc, void* result)
+{
+    RenderCommand cmd;
+    cmd.type = type;
+    cmd.create.desc = desc;
+    cmd.create.result = result;
+    run_render_command(&cmd);
+}
+
+INTERNAL void record_free_render_command(RenderCommandType type, void* object)
+{
+    RenderCommand cmd;
+    cmd.type = type;
+    cmd.free.object = object;
+    record_render_command(cmd);
+}
+
+INTERNAL void record_rect_render_command(RenderCommandType type, nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+{
+    RenderCommand cmd;
+    cmd.type = type;
+    cmd.rect.x = x;
+    cmd.rect.y = y;
+    cmd.rect.w = w;
+    cmd.rect.h = h;
+    record_render_command(cmd);
+}
+
+INTERNAL void record_simple_render_command(RenderCommandType type)
+{
+    RenderCommand cmd;
+    cmd.type = type;
+    record_render_command(cmd);
+}
+
+INTERNAL void start_render_thread(void)
+{
+    printf("[Renderer]: Starting render thread\n");
+
+    g_render_thread.mutex = SDL_CreateMutex();
+    g_render_thread.cond = SDL_CreateCond();
+    if(!g_render_thread.mutex || !g_render_thread.cond)
+    {
+        fatal_error("Failed to create render thread sync objects: %s", SDL_GetError());
+    }
+
+    // Hand the context over before the thread starts, from here on the main thread must not touch the backend.
+    backend_bind_context(NK_FALSE);
+
+    g_render_thread.active = NK_TRUE;
+    g_render_thread.thread = SDL_CreateThread(render_thread_main, "Render", NULL);
+    if(!g_render_thread.thread)
+    {
+        fatal_error("Failed to create render thread: %s", SDL_GetError());
+    }
+}
+
+INTERNAL void stop_render_thread(void)
+{
+    SDL_LockMutex(g_render_thread.mutex);
+    while(g_render_thread.pending || g_render_thread.call)
+        SDL_CondWait(g_render_thread.cond, g_render_thread.mutex);
+    g_render_thread.quit = NK_TRUE;
+    SDL_CondBroadcast(g_render_thread.cond);
+    SDL_UnlockMutex(g_render_thread.mutex);
+
+    SDL_WaitThread(g_render_thread.thread, NULL);
+
+    g_render_thread.active = NK_FALSE;
+
+    // Take the context back and run whatever was recorded since the last present, which is usually all the frees from
+    // shutting down the other systems, so nothing gets leaked.
+    backend_bind_context(NK_TRUE);
+    replay_render_command_buffer(&g_render_thread.buffers[g_render_thread.record]);
+
+    for(nkU32 i=0; i<NK_ARRAY_SIZE(g_render_thread.buffers); ++i)
+    {
+        nk_array_free(&g_render_thread.buffers[i].commands);
+        nk_array_free(&g_render_thread.buffers[i].data);
+    }
+
+    SDL_DestroyCond(g_render_thread.cond);
+    SDL_DestroyMutex(g_render_thread.mutex);
+}
+
+GLOBAL void init_render_system(void)
+{
+    backend_init_render_system();
+
+    #if !defined(BUILD_WEB)
+    if(get_app_desc()->render_thread)
+    {
+        start_render_thread();
+    }
+    #endif // !BUILD_WEB
+}
+
+GLOBAL void quit_render_system(void)
+{
+    if(g_render_thread.active)
+    {
+        stop_render_thread();
+    }
+
+    backend_quit_render_system();
+}
+
+GLOBAL void maybe_resize_backbuffer(void)
+{
+    if(!g_render_thread.active) backend_maybe_resize_backbuffer();
+    else record_simple_render_command(RenderCommandType_ResizeBackbuffer);
+}
+
+GLOBAL void present_renderer(void)
+{
+    g_render_stats = g_render_stats_frame;
+    g_render_stats_frame = RenderStats();
+
+    if(!g_render_thread.active)
+    {
+        backend_present_renderer();
+        return;
+    }
+
+    record_simple_render_command(RenderCommandType_Present);
+    submit_render_command_buffer();
+}
+
+GLOBAL Buffer create_buffer(const BufferDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_buffer(desc);
+    Buffer buffer = NULL;
+    run_create_render_command(RenderCommandType_CreateBuffer, &desc, &buffer);
+    return buffer;
+}
+
+GLOBAL Shader create_shader(const ShaderDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_shader(desc);
+    Shader shader = NULL;
+    run_create_render_command(RenderCommandType_CreateShader, &desc, &shader);
+    return shader;
+}
+
+GLOBAL Sampler create_sampler(const SamplerDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_sampler(desc);
+    Sampler sampler = NULL;
+    run_create_render_command(RenderCommandType_CreateSampler, &desc, &sampler);
+    return sampler;
+}
+
+GLOBAL Texture create_texture(const TextureDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_texture(desc);
+    Texture texture = NULL;
+    run_create_render_command(RenderCommandType_CreateTexture, &desc, &texture);
+    return texture;
+}
+
+GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_render_pass(desc);
+    RenderPass pass = NULL;
+    run_create_render_command(RenderCommandType_CreateRenderPass, &desc, &pass);
+    return pass;
+}
+
+GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
+{
+    if(!g_render_thread.active) return backend_create_render_pipeline(desc);
+    RenderPipeline pipeline = NULL;
+    run_create_render_command(RenderCommandType_CreateRenderPipeline, &desc, &pipeline);
+    return pipeline;
+}
+
+GLOBAL void free_buffer(Buffer buffer)
+{
+    if(!g_render_thread.active) backend_free_buffer(buffer);
+    else record_free_render_command(RenderCommandType_FreeBuffer, buffer);
+}
+
+GLOBAL void free_shader(Shader shader)
+{
+    if(!g_render_thread.active) backend_free_shader(shader);
+    else record_free_render_command(RenderCommandType_FreeShader, shader);
+}
+
+GLOBAL void free_sampler(Sampler sampler)
+{
+    if(!g_render_thread.active) backend_free_sampler(sampler);
+    else record_free_render_command(RenderCommandType_FreeSampler, sampler);
+}
+
+GLOBAL void free_texture(Texture texture)
+{
+    if(!g_render_thread.active) backend_free_texture(texture);
+    else record_free_render_command(RenderCommandType_FreeTexture, texture);
+}
+
+GLOBAL void free_render_pass(RenderPass pass)
+{
+    if(!g_render_thread.active) backend_free_render_pass(pass);
+    else record_free_render_command(RenderCommandType_FreeRenderPass, pass);
+}
+
+GLOBAL void free_render_pipeline(RenderPipeline pipeline)
+{
+    if(!g_render_thread.active) backend_free_render_pipeline(pipeline);
+    else record_free_render_command(RenderCommandType_FreeRenderPipeline, pipeline);
+}
+
+GLOBAL void update_buffer(Buffer buffer, void* data, nkU64 bytes)
+{
+    if(!g_render_thread.active)
+    {
+        backend_update_buffer(buffer, data, bytes);
+        return;
+    }
+
+    RenderCommandBuffer* command_buffer = &g_render_thread.buffers[g_render_thread.record];
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_UpdateBuffer;
+    cmd.update_buffer.buffer = buffer;
+    cmd.update_buffer.offset = command_buffer->data.length;
+    cmd.update_buffer.bytes = bytes;
+    cmd.update_buffer.copied = (data != NULL);
+    if(data)
+    {
+        nk_array_append(&command_buffer->data, NK_CAST(const nkU8*, data), bytes);
+    }
+    record_render_command(cmd);
+}
+
+GLOBAL void resize_texture(Texture texture, nkS32 width, nkS32 height)
+{
+    if(!g_render_thread.active)
+    {
+        backend_resize_texture(texture, width, height);
+        return;
+    }
+
+    // This is run synchronously so the new size can be queried straight away. Anything already recorded this frame was
+    // meant to happen before the resize, so submit it first and run_render_command waits for it to be replayed.
+    submit_render_command_buffer();
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_ResizeTexture;
+    cmd.resize_texture.texture = texture;
+    cmd.resize_texture.width = width;
+    cmd.resize_texture.height = height;
+    run_render_command(&cmd);
+}
+
+GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+{
+    if(!g_render_thread.active) backend_set_viewport(x,y,w,h);
+    else record_rect_render_command(RenderCommandType_SetViewport, x,y,w,h);
+}
+
+GLOBAL void begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+{
+    if(!g_render_thread.active) backend_begin_scissor(x,y,w,h);
+    else record_rect_render_command(RenderCommandType_BeginScissor, x,y,w,h);
+}
+
+GLOBAL void end_scissor(void)
+{
+    if(!g_render_thread.active) backend_end_scissor();
+    else record_simple_render_command(RenderCommandType_EndScissor);
+}
+
+GLOBAL void begin_render_pass(RenderPass pass)
+{
+    if(!g_render_thread.active)
+    {
+        backend_begin_render_pass(pass);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_BeginRenderPass;
+    cmd.begin_render_pass.pass = pass;
+    record_render_command(cmd);
+}
+
+GLOBAL void end_render_pass(void)
+{
+    if(!g_render_thread.active) backend_end_render_pass();
+    else record_simple_render_command(RenderCommandType_EndRenderPass);
+}
+
+GLOBAL void bind_pipeline(RenderPipeline pipeline)
+{
+    if(!g_render_thread.active)
+    {
+        backend_bind_pipeline(pipeline);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_BindPipeline;
+    cmd.bind_pipeline.pipeline = pipeline;
+    record_render_command(cmd);
+}
+
+GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
+{
+    if(!g_render_thread.active)
+    {
+        backend_bind_buffer(buffer, slot);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_BindBuffer;
+    cmd.bind_buffer.buffer = buffer;
+    cmd.bind_buffer.slot = slot;
+    record_render_command(cmd);
+}
+
+GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
+{
+    if(!g_render_thread.active)
+    {
+        backend_bind_texture(texture, sampler, unit);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_BindTexture;
+    cmd.bind_texture.texture = texture;
+    cmd.bind_texture.sampler = sampler;
+    cmd.bind_texture.unit = unit;
+    record_render_command(cmd);
+}
+
+GLOBAL void draw_arrays(nkU64 vertex_count)
+{
+    g_render_stats_frame.draw_calls++;
+    g_render_stats_frame.vertices += vertex_count;
+
+    if(!g_render_thread.active)
+    {
+        backend_draw_arrays(vertex_count);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_DrawArrays;
+    cmd.draw_arrays.vertex_count = vertex_count;
+    record_render_command(cmd);
+}
+
+GLOBAL void draw_elements(nkU64 element_count, ElementType element_type, nkU64 byte_offset)
+{
+    g_render_stats_frame.draw_calls++;
+    g_render_stats_frame.vertices += element_count;
+
+    if(!g_render_thread.active)
+    {
+        backend_draw_elements(element_count, element_type, byte_offset);
+        return;
+    }
+
+    RenderCommand cmd;
+    cmd.type = RenderCommandType_DrawElements;
+    cmd.draw_elements.element_count = element_count;
+    cmd.draw_elements.type = element_type;
+    cmd.draw_elements.offset = byte_offset;
+    record_render_command(cmd);
+}
+
+GLOBAL RenderStats get_render_stats(void)
+{
+    return g_render_stats;
+}
+
 /*////////////////////////////////////////////////////////////////////////////*/
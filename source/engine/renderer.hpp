@@ -197,6 +197,13 @@ struct RenderPipelineDesc
     nkBool       depth_read  = NK_TRUE;
     nkBool       depth_write = NK_TRUE;
 };
+
+// Counted as the draw calls are issued, so they're the same whether or not the render thread is being used.
+struct RenderStats
+{
+    nkU64 draw_calls = 0;
+    nkU64 vertices   = 0; // Elements for indexed draws.
+};
 // =============================================================================
 
 // Functions ===================================================================
@@ -232,6 +239,7 @@ GLOBAL void           bind_buffer            (Buffer buffer, nkS32 slot = 0);
 GLOBAL void           bind_texture           (Texture texture, Sampler sampler, nkS32 unit = 0);
 GLOBAL void           draw_arrays            (nkU64 vertex_count);
 GLOBAL void           draw_elements          (nkU64 element_count, ElementType element_type, nkU64 byteOffset = 0);
+GLOBAL RenderStats    get_render_stats       (void); // Stats for the last frame that was presented.
 // =============================================================================
 
 /*////////////////////////////////////////////////////////////////////////////*/
@@ -22,6 +22,7 @@ struct Direct3DContext
     RenderPipeline          current_pipeline;
     Buffer                  current_element_buffer;
     nkBool                  pass_started;
+    nkU64                   last_present_counter;
 };
 
 INTERNAL Direct3DContext g_d3d;
@@ -92,7 +93,7 @@ GLOBAL void create_buffer_internally(Buffer buffer, const BufferDesc& desc)
     buffer->max_bytes = desc.bytes;
 }
 
-GLOBAL Buffer create_buffer(const BufferDesc& desc)
+INTERNAL Buffer backend_create_buffer(const BufferDesc& desc)
 {
     Buffer buffer = ALLOCATE_PRIVATE_TYPE(Buffer);
     if(!buffer) fatal_error("Failed to allocate buffer!");
@@ -102,7 +103,7 @@ GLOBAL Buffer create_buffer(const BufferDesc& desc)
     return buffer;
 }
 
-GLOBAL void free_buffer(Buffer buffer)
+INTERNAL void backend_free_buffer(Buffer buffer)
 {
     if(!buffer) return;
     if(buffer->buffer)
@@ -110,7 +111,7 @@ GLOBAL void free_buffer(Buffer buffer)
     NK_FREE(buffer);
 }
 
-GLOBAL void update_buffer(Buffer buffer, void* data, nkU64 bytes)
+INTERNAL void backend_update_buffer(Buffer buffer, void* data, nkU64 bytes)
 {
     if(!buffer) return;
 
@@ -149,7 +150,7 @@ DEFINE_PRIVATE_TYPE(Shader)
     nkU64               uniform_count;
 };
 
-GLOBAL Shader create_shader(const ShaderDesc& desc)
+INTERNAL Shader backend_create_shader(const ShaderDesc& desc)
 {
     Shader shader = ALLOCATE_PRIVATE_TYPE(Shader);
     if(!shader) fatal_error("Failed to allocate shader!");
@@ -185,7 +186,7 @@ GLOBAL Shader create_shader(const ShaderDesc& desc)
     return shader;
 }
 
-GLOBAL void free_shader(Shader shader)
+INTERNAL void backend_free_shader(Shader shader)
 {
     if(!shader) return;
 
@@ -221,7 +222,7 @@ DEFINE_PRIVATE_TYPE(Sampler)
     ID3D11SamplerState* sampler;
 };
 
-GLOBAL Sampler create_sampler(const SamplerDesc& desc)
+INTERNAL Sampler backend_create_sampler(const SamplerDesc& desc)
 {
     Sampler sampler = ALLOCATE_PRIVATE_TYPE(Sampler);
     if(!sampler) fatal_error("Failed to allocate sampler!");
@@ -243,7 +244,7 @@ GLOBAL Sampler create_sampler(const SamplerDesc& desc)
     return sampler;
 }
 
-GLOBAL void free_sampler(Sampler sampler)
+INTERNAL void backend_free_sampler(Sampler sampler)
 {
     if(!sampler) return;
     if(sampler->sampler)
@@ -282,7 +283,7 @@ DEFINE_PRIVATE_TYPE(Texture)
     nkS32                     height;
 };
 
-GLOBAL Texture create_texture(const TextureDesc& desc)
+INTERNAL Texture backend_create_texture(const TextureDesc& desc)
 {
     Texture texture = ALLOCATE_PRIVATE_TYPE(Texture);
     if(!texture) fatal_error("Failed to allocate texture!");
@@ -362,7 +363,7 @@ GLOBAL Texture create_texture(const TextureDesc& desc)
     return texture;
 }
 
-GLOBAL void free_texture(Texture texture)
+INTERNAL void backend_free_texture(Texture texture)
 {
     if(!texture) return;
 
@@ -375,7 +376,7 @@ GLOBAL void free_texture(Texture texture)
     NK_FREE(texture);
 }
 
-GLOBAL void resize_texture(Texture texture, nkS32 width, nkS32 height)
+INTERNAL void backend_resize_texture(Texture texture, nkS32 width, nkS32 height)
 {
     // @Incomplete: ...
 }
@@ -410,7 +411,7 @@ DEFINE_PRIVATE_TYPE(RenderPass)
     RenderPassDesc desc;
 };
 
-GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
+INTERNAL RenderPass backend_create_render_pass(const RenderPassDesc& desc)
 {
     RenderPass pass = ALLOCATE_PRIVATE_TYPE(RenderPass);
     if(!pass) fatal_error("Failed to allocate render pass!");
@@ -420,13 +421,13 @@ GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
     return pass;
 }
 
-GLOBAL void free_render_pass(RenderPass pass)
+INTERNAL void backend_free_render_pass(RenderPass pass)
 {
     if(!pass) return;
     NK_FREE(pass);
 }
 
-GLOBAL void begin_render_pass(RenderPass pass)
+INTERNAL void backend_begin_render_pass(RenderPass pass)
 {
     NK_ASSERT(!g_d3d.pass_started); // Render pass is already in progress!
 
@@ -458,7 +459,7 @@ GLOBAL void begin_render_pass(RenderPass pass)
     g_d3d.device_context->OMSetRenderTargets(pass->desc.num_color_targets, color_views, depth_stencil_view);
 }
 
-GLOBAL void end_render_pass(void)
+INTERNAL void backend_end_render_pass(void)
 {
     NK_ASSERT(g_d3d.pass_started); // Render pass has not been started!
     g_d3d.pass_started = NK_FALSE;
@@ -510,7 +511,7 @@ DEFINE_PRIVATE_TYPE(RenderPipeline)
     ID3D11DepthStencilState* depth_stencil_state;
 };
 
-GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
+INTERNAL RenderPipeline backend_create_render_pipeline(const RenderPipelineDesc& desc)
 {
     RenderPipeline pipeline = ALLOCATE_PRIVATE_TYPE(RenderPipeline);
     if(!pipeline) fatal_error("Failed to allocate render pipeline!");
@@ -611,7 +612,7 @@ GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
     return pipeline;
 }
 
-GLOBAL void free_render_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_free_render_pipeline(RenderPipeline pipeline)
 {
     if(!pipeline) return;
 
@@ -650,7 +651,7 @@ GLOBAL void setup_renderer_platform(void)
     // Doesn't need to do anything in this backend...
 }
 
-GLOBAL void init_render_system(void)
+INTERNAL void backend_init_render_system(void)
 {
     printf("[Direct3D]: Initializing System\n");
 
@@ -691,6 +692,17 @@ GLOBAL void init_render_system(void)
     dxgi_device->GetParent(      __uuidof(IDXGIAdapter), NK_CAST(void**,&dxgi_adapter));
     dxgi_adapter->GetParent(     __uuidof(IDXGIFactory), NK_CAST(void**,&dxgi_factory));
 
+    // DXGI queues up to three frames by default, only allowing one keeps latency consistent.
+    if(get_app_desc()->frame_pacing)
+    {
+        IDXGIDevice1* dxgi_device1 = NULL;
+        if(SUCCEEDED(g_d3d.device->QueryInterface(__uuidof(IDXGIDevice1), NK_CAST(void**,&dxgi_device1))))
+        {
+            dxgi_device1->SetMaximumFrameLatency(1);
+            dxgi_device1->Release();
+        }
+    }
+
     // Setup our swap chain.
     DXGI_SWAP_CHAIN_DESC swap_chain_desc               = NK_ZERO_MEM;
     swap_chain_desc.BufferDesc.Width                   = get_window_width();
@@ -724,7 +736,7 @@ GLOBAL void init_render_system(void)
     dxgi_factory->MakeWindowAssociation(hwnd, DXGI_MWA_NO_WINDOW_CHANGES);
 }
 
-GLOBAL void quit_render_system(void)
+INTERNAL void backend_quit_render_system(void)
 {
     if(g_d3d.backbuffer.color_texture)
     {
@@ -753,7 +765,12 @@ GLOBAL void quit_render_system(void)
     }
 }
 
-GLOBAL void maybe_resize_backbuffer(void)
+INTERNAL void backend_bind_context(nkBool bind)
+{
+    // Nothing to do as the device context can be used from any thread, as long as it's only used by one at a time.
+}
+
+INTERNAL void backend_maybe_resize_backbuffer(void)
 {
     // We need to resize the backbuffer if the window has changed size.
     nkS32 ww = get_window_width();
@@ -782,12 +799,36 @@ GLOBAL void maybe_resize_backbuffer(void)
     }
 }
 
-GLOBAL void present_renderer(void)
+INTERNAL void backend_present_renderer(void)
 {
-    g_d3d.swap_chain->Present(1, 0); // Present with Vsync.
+    UINT sync_interval = 1;
+
+    switch(get_app_desc()->vsync)
+    {
+        case VSyncMode_Off:
+        {
+            sync_interval = 0;
+        } break;
+        case VSyncMode_On:
+        {
+            sync_interval = 1;
+        } break;
+        case VSyncMode_Adaptive:
+        {
+            // There's no adaptive VSync in DXGI so do it ourselves, if the frame took longer than a refresh then waiting
+            // for the next blank would cost us a whole extra refresh so present straight away instead.
+            nkU64 now = SDL_GetPerformanceCounter();
+            nkF64 frame_time = NK_CAST(nkF64, now - g_d3d.last_present_counter) / NK_CAST(nkF64, SDL_GetPerformanceFrequency());
+            sync_interval = (frame_time > (1.0 / get_refresh_rate())) ? 0 : 1;
+        } break;
+    }
+
+    g_d3d.swap_chain->Present(sync_interval, 0);
+
+    g_d3d.last_present_counter = SDL_GetPerformanceCounter();
 }
 
-GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     D3D11_VIEWPORT viewport = NK_ZERO_MEM;
     viewport.TopLeftX = x;
@@ -800,17 +841,17 @@ GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
     g_d3d.device_context->RSSetViewports(1, &viewport);
 }
 
-GLOBAL void begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     // @Incomplete: ...
 }
 
-GLOBAL void end_scissor(void)
+INTERNAL void backend_end_scissor(void)
 {
     // @Incomplete: ...
 }
 
-GLOBAL void bind_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_bind_pipeline(RenderPipeline pipeline)
 {
     NK_ASSERT(g_d3d.pass_started); // Cannot bind outside of a render pass!
 
@@ -827,7 +868,7 @@ GLOBAL void bind_pipeline(RenderPipeline pipeline)
     g_d3d.device_context->OMSetDepthStencilState(pipeline->depth_stencil_state, 0);
 }
 
-GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
+INTERNAL void backend_bind_buffer(Buffer buffer, nkS32 slot)
 {
     NK_ASSERT(g_d3d.pass_started); // Cannot bind outside of a render pass!
 
@@ -853,7 +894,7 @@ GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
     }
 }
 
-GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
+INTERNAL void backend_bind_texture(Texture texture, Sampler sampler, nkS32 unit)
 {
     NK_ASSERT(g_d3d.pass_started); // Cannot bind outside of a render pass!
 
@@ -867,7 +908,7 @@ GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
     g_d3d.device_context->PSSetSamplers(unit, 1, &sampler->sampler);
 }
 
-GLOBAL void draw_arrays(nkU64 vertex_count)
+INTERNAL void backend_draw_arrays(nkU64 vertex_count)
 {
     NK_ASSERT(g_d3d.pass_started); // Cannot draw outside of a render pass!
 
@@ -876,7 +917,7 @@ GLOBAL void draw_arrays(nkU64 vertex_count)
     g_d3d.device_context->Draw(NK_CAST(UINT,vertex_count), 0);
 }
 
-GLOBAL void draw_elements(nkU64 element_count, ElementType element_type, nkU64 byte_offset)
+INTERNAL void backend_draw_elements(nkU64 element_count, ElementType element_type, nkU64 byte_offset)
 {
     NK_ASSERT(g_d3d.pass_started); // Cannot draw outside of a render pass!
     NK_ASSERT(g_d3d.current_element_buffer); // We need an element buffer bound for indexed drawing.
@@ -44,7 +44,7 @@ DEFINE_PRIVATE_TYPE(Buffer)
     GLuint handle;
 };
 
-GLOBAL Buffer create_buffer(const BufferDesc& desc)
+INTERNAL Buffer backend_create_buffer(const BufferDesc& desc)
 {
     Buffer buffer = ALLOCATE_PRIVATE_TYPE(Buffer);
     if(!buffer) fatal_error("Failed to allocate buffer!");
@@ -61,14 +61,14 @@ GLOBAL Buffer create_buffer(const BufferDesc& desc)
     return buffer;
 }
 
-GLOBAL void free_buffer(Buffer buffer)
+INTERNAL void backend_free_buffer(Buffer buffer)
 {
     NK_ASSERT(buffer);
     glDeleteBuffers(1, &buffer->handle);
     NK_FREE(buffer);
 }
 
-GLOBAL void update_buffer(Buffer buffer, void* data, nkU64 bytes)
+INTERNAL void backend_update_buffer(Buffer buffer, void* data, nkU64 bytes)
 {
     NK_ASSERT(buffer);
 
@@ -129,7 +129,7 @@ INTERNAL GLuint compile_shader(void* data, nkU64 bytes, GLenum type)
     return shader;
 }
 
-GLOBAL Shader create_shader(const ShaderDesc& desc)
+INTERNAL Shader backend_create_shader(const ShaderDesc& desc)
 {
     Shader shader = ALLOCATE_PRIVATE_TYPE(Shader);
     if(!shader) fatal_error("Failed to allocate shader!");
@@ -169,7 +169,7 @@ GLOBAL Shader create_shader(const ShaderDesc& desc)
     return shader;
 }
 
-GLOBAL void free_shader(Shader shader)
+INTERNAL void backend_free_shader(Shader shader)
 {
     NK_ASSERT(shader);
     glDeleteProgram(shader->program);
@@ -200,7 +200,7 @@ DEFINE_PRIVATE_TYPE(Sampler)
     GLuint handle;
 };
 
-GLOBAL Sampler create_sampler(const SamplerDesc& desc)
+INTERNAL Sampler backend_create_sampler(const SamplerDesc& desc)
 {
     Sampler sampler = ALLOCATE_PRIVATE_TYPE(Sampler);
     if(!sampler) fatal_error("Failed to allocate sampler!");
@@ -217,7 +217,7 @@ GLOBAL Sampler create_sampler(const SamplerDesc& desc)
     return sampler;
 }
 
-GLOBAL void free_sampler(Sampler sampler)
+INTERNAL void backend_free_sampler(Sampler sampler)
 {
     NK_ASSERT(sampler);
     glDeleteSamplers(1,&sampler->handle);
@@ -259,7 +259,7 @@ DEFINE_PRIVATE_TYPE(Texture)
     nkS32               height;
 };
 
-GLOBAL Texture create_texture(const TextureDesc& desc)
+INTERNAL Texture backend_create_texture(const TextureDesc& desc)
 {
     Texture texture = ALLOCATE_PRIVATE_TYPE(Texture);
     if(!texture) fatal_error("Failed to allocate texture!");
@@ -292,14 +292,14 @@ GLOBAL Texture create_texture(const TextureDesc& desc)
     return texture;
 }
 
-GLOBAL void free_texture(Texture texture)
+INTERNAL void backend_free_texture(Texture texture)
 {
     NK_ASSERT(texture);
     glDeleteTextures(1,&texture->handle);
     NK_FREE(texture);
 }
 
-GLOBAL void resize_texture(Texture texture, nkS32 width, nkS32 height)
+INTERNAL void backend_resize_texture(Texture texture, nkS32 width, nkS32 height)
 {
     NK_ASSERT(texture);
 
@@ -343,7 +343,7 @@ DEFINE_PRIVATE_TYPE(RenderPass)
     RenderPassDesc desc;
 };
 
-GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
+INTERNAL RenderPass backend_create_render_pass(const RenderPassDesc& desc)
 {
     RenderPass pass = ALLOCATE_PRIVATE_TYPE(RenderPass);
     if(!pass) fatal_error("Failed to allocate render pass!");
@@ -380,7 +380,7 @@ GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
     return pass;
 }
 
-GLOBAL void free_render_pass(RenderPass pass)
+INTERNAL void backend_free_render_pass(RenderPass pass)
 {
     NK_ASSERT(pass);
     if(pass->framebuffer != GL_NONE)
@@ -388,7 +388,7 @@ GLOBAL void free_render_pass(RenderPass pass)
     NK_FREE(pass);
 }
 
-GLOBAL void begin_render_pass(RenderPass pass)
+INTERNAL void backend_begin_render_pass(RenderPass pass)
 {
     NK_ASSERT(!g_ogl.pass_started); // Render pass is already in progress!
 
@@ -415,7 +415,7 @@ GLOBAL void begin_render_pass(RenderPass pass)
     }
 }
 
-GLOBAL void end_render_pass(void)
+INTERNAL void backend_end_render_pass(void)
 {
     NK_ASSERT(g_ogl.pass_started); // Render pass has not been started!
     g_ogl.pass_started = NK_FALSE;
@@ -439,7 +439,7 @@ DEFINE_PRIVATE_TYPE(RenderPipeline)
     nkU64              uniform_count;
 };
 
-GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
+INTERNAL RenderPipeline backend_create_render_pipeline(const RenderPipelineDesc& desc)
 {
     RenderPipeline pipeline = ALLOCATE_PRIVATE_TYPE(RenderPipeline);
     if(!pipeline) fatal_error("Failed to allocate render pipeline!");
@@ -474,7 +474,7 @@ GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
     return pipeline;
 }
 
-GLOBAL void free_render_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_free_render_pipeline(RenderPipeline pipeline)
 {
     NK_ASSERT(pipeline);
     NK_FREE(pipeline);
@@ -574,7 +574,7 @@ GLOBAL void setup_renderer_platform(void)
     #endif // BUILD_WEB
 }
 
-GLOBAL void init_render_system(void)
+INTERNAL void backend_init_render_system(void)
 {
     printf("[OpenGL]: Initializing System\n");
 
@@ -584,10 +584,26 @@ GLOBAL void init_render_system(void)
         fatal_error("Failed to create OpenGL context: %s", SDL_GetError());
     }
 
-    // Enable VSync by default, if we don't get it then oh well.
-    if(SDL_GL_SetSwapInterval(1) == 0)
+    // Adaptive VSync isn't supported everywhere so fall back to regular VSync, if we don't get that then oh well.
+    switch(get_app_desc()->vsync)
     {
-        printf("[OpenGL]: VSync Enabled!\n");
+        case VSyncMode_Off:
+        {
+            if(SDL_GL_SetSwapInterval(0) == 0)
+                printf("[OpenGL]: VSync Disabled!\n");
+        } break;
+        case VSyncMode_On:
+        {
+            if(SDL_GL_SetSwapInterval(1) == 0)
+                printf("[OpenGL]: VSync Enabled!\n");
+        } break;
+        case VSyncMode_Adaptive:
+        {
+            if(SDL_GL_SetSwapInterval(-1) == 0)
+                printf("[OpenGL]: Adaptive VSync Enabled!\n");
+            else if(SDL_GL_SetSwapInterval(1) == 0)
+                printf("[OpenGL]: Adaptive VSync Unsupported, VSync Enabled!\n");
+        } break;
     }
 
     #if defined(BUILD_NATIVE)
@@ -612,7 +628,7 @@ GLOBAL void init_render_system(void)
     #endif // BUILD_NATIVE
 }
 
-GLOBAL void quit_render_system(void)
+INTERNAL void backend_quit_render_system(void)
 {
     #if defined(BUILD_NATIVE)
     glDeleteVertexArrays(1, &g_ogl.vertex_array_object);
@@ -621,17 +637,29 @@ GLOBAL void quit_render_system(void)
     SDL_GL_DeleteContext(g_ogl.context);
 }
 
-GLOBAL void maybe_resize_backbuffer(void)
+INTERNAL void backend_bind_context(nkBool bind)
+{
+    // The context can only be current on one thread at a time, so it has to be released before another can take it.
+    SDL_GL_MakeCurrent(NK_CAST(SDL_Window*, get_window()), (bind) ? g_ogl.context : NULL);
+}
+
+INTERNAL void backend_maybe_resize_backbuffer(void)
 {
     // This does nothing in the OpenGL backend as the backbuffer is handled for us.
 }
 
-GLOBAL void present_renderer(void)
+INTERNAL void backend_present_renderer(void)
 {
     SDL_GL_SwapWindow(NK_CAST(SDL_Window*, get_window()));
+
+    // Drivers will happily queue up a few frames, waiting for the swap to finish keeps latency to a consistent frame.
+    if(get_app_desc()->frame_pacing)
+    {
+        glFinish();
+    }
 }
 
-GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     GLint   vx = NK_CAST(GLint,   x);
     GLint   vy = NK_CAST(GLint,   y);
@@ -641,7 +669,7 @@ GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
     glViewport(vx,vy,vw,vh);
 }
 
-GLOBAL void begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     GLint   sx = NK_CAST(GLint,   x);
     GLint   sy = NK_CAST(GLint,   get_window_height()-(y+h));
@@ -652,12 +680,12 @@ GLOBAL void begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
     glEnable(GL_SCISSOR_TEST);
 }
 
-GLOBAL void end_scissor(void)
+INTERNAL void backend_end_scissor(void)
 {
     glDisable(GL_SCISSOR_TEST);
 }
 
-GLOBAL void bind_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_bind_pipeline(RenderPipeline pipeline)
 {
     NK_ASSERT(g_ogl.pass_started); // Cannot bind outside of a render pass!
     NK_ASSERT(pipeline);
@@ -733,7 +761,7 @@ GLOBAL void bind_pipeline(RenderPipeline pipeline)
     g_ogl.current_draw_mode = pipeline->desc.draw_mode;
 }
 
-GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
+INTERNAL void backend_bind_buffer(Buffer buffer, nkS32 slot)
 {
     NK_ASSERT(g_ogl.pass_started); // Cannot bind outside of a render pass!
     NK_ASSERT(buffer);
@@ -763,7 +791,7 @@ GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
     }
 }
 
-GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
+INTERNAL void backend_bind_texture(Texture texture, Sampler sampler, nkS32 unit)
 {
     NK_ASSERT(g_ogl.pass_started); // Cannot bind outside of a render pass!
     NK_ASSERT(texture);
@@ -774,7 +802,7 @@ GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
     else glBindSampler(unit, GL_NONE);
 }
 
-GLOBAL void draw_arrays(nkU64 vertex_count)
+INTERNAL void backend_draw_arrays(nkU64 vertex_count)
 {
     NK_ASSERT(g_ogl.pass_started); // Cannot draw outside of a render pass!
 
@@ -784,7 +812,7 @@ GLOBAL void draw_arrays(nkU64 vertex_count)
     glDrawArrays(mode, 0, NK_CAST(GLsizei,vertex_count));
 }
 
-GLOBAL void draw_elements(nkU64 element_count, ElementType element_type, nkU64 byte_offset)
+INTERNAL void backend_draw_elements(nkU64 element_count, ElementType element_type, nkU64 byte_offset)
 {
     NK_ASSERT(g_ogl.pass_started); // Cannot draw outside of a render pass!
 
@@ -7,17 +7,19 @@ DEFINE_PRIVATE_TYPE(Buffer)
     // Nothing...
 };
 
-GLOBAL Buffer create_buffer(const BufferDesc& desc)
+INTERNAL Buffer backend_create_buffer(const BufferDesc& desc)
 {
-    return NULL;
+    Buffer buffer = ALLOCATE_PRIVATE_TYPE(Buffer);
+    if(!buffer) fatal_error("Failed to allocate buffer!");
+    return buffer;
 }
 
-GLOBAL void free_buffer(Buffer buffer)
+INTERNAL void backend_free_buffer(Buffer buffer)
 {
-    // Nothing...
+    NK_FREE(buffer);
 }
 
-GLOBAL void update_buffer(Buffer buffer, void* data, nkU64 bytes)
+INTERNAL void backend_update_buffer(Buffer buffer, void* data, nkU64 bytes)
 {
     // Nothing...
 }
@@ -31,14 +33,16 @@ DEFINE_PRIVATE_TYPE(Shader)
     // Nothing...
 };
 
-GLOBAL Shader create_shader(const ShaderDesc& desc)
+INTERNAL Shader backend_create_shader(const ShaderDesc& desc)
 {
-    return NULL;
+    Shader shader = ALLOCATE_PRIVATE_TYPE(Shader);
+    if(!shader) fatal_error("Failed to allocate shader!");
+    return shader;
 }
 
-GLOBAL void free_shader(Shader shader)
+INTERNAL void backend_free_shader(Shader shader)
 {
-    // Nothing...
+    NK_FREE(shader);
 }
 
 // =============================================================================
@@ -50,14 +54,16 @@ DEFINE_PRIVATE_TYPE(Sampler)
     // Nothing...
 };
 
-GLOBAL Sampler create_sampler(const SamplerDesc& desc)
+INTERNAL Sampler backend_create_sampler(const SamplerDesc& desc)
 {
-    return NULL;
+    Sampler sampler = ALLOCATE_PRIVATE_TYPE(Sampler);
+    if(!sampler) fatal_error("Failed to allocate sampler!");
+    return sampler;
 }
 
-GLOBAL void free_sampler(Sampler sampler)
+INTERNAL void backend_free_sampler(Sampler sampler)
 {
-    // Nothing...
+    NK_FREE(sampler);
 }
 
 // =============================================================================
@@ -66,37 +72,50 @@ GLOBAL void free_sampler(Sampler sampler)
 
 DEFINE_PRIVATE_TYPE(Texture)
 {
-    // Nothing...
+    nkS32 width; // We still track the size as game code often lays things out based on it.
+    nkS32 height;
 };
 
-GLOBAL Texture create_texture(const TextureDesc& desc)
+INTERNAL Texture backend_create_texture(const TextureDesc& desc)
 {
-    return NULL;
+    Texture texture = ALLOCATE_PRIVATE_TYPE(Texture);
+    if(!texture) fatal_error("Failed to allocate texture!");
+    texture->width = desc.width;
+    texture->height = desc.height;
+    return texture;
 }
 
-GLOBAL void free_texture(Texture texture)
+INTERNAL void backend_free_texture(Texture texture)
 {
-    // Nothing...
+    NK_FREE(texture);
 }
 
-GLOBAL void resize_texture(Texture texture, nkS32 width, nkS32 height)
+INTERNAL void backend_resize_texture(Texture texture, nkS32 width, nkS32 height)
 {
-    // Nothing...
+    NK_ASSERT(texture);
+    texture->width = width;
+    texture->height = height;
 }
 
 GLOBAL iPoint get_texture_size(Texture texture)
 {
-    return { 0,0 };
+    NK_ASSERT(texture);
+    iPoint size;
+    size.x = texture->width;
+    size.y = texture->height;
+    return size;
 }
 
 GLOBAL nkS32 get_texture_width(Texture texture)
 {
-    return 0;
+    NK_ASSERT(texture);
+    return texture->width;
 }
 
 GLOBAL nkS32 get_texture_height(Texture texture)
 {
-    return 0;
+    NK_ASSERT(texture);
+    return texture->height;
 }
 
 // =============================================================================
@@ -108,22 +127,24 @@ DEFINE_PRIVATE_TYPE(RenderPass)
     // Nothing...
 };
 
-GLOBAL RenderPass create_render_pass(const RenderPassDesc& desc)
+INTERNAL RenderPass backend_create_render_pass(const RenderPassDesc& desc)
 {
-    return NULL;
+    RenderPass pass = ALLOCATE_PRIVATE_TYPE(RenderPass);
+    if(!pass) fatal_error("Failed to allocate render pass!");
+    return pass;
 }
 
-GLOBAL void free_render_pass(RenderPass pass)
+INTERNAL void backend_free_render_pass(RenderPass pass)
 {
-    // Nothing...
+    NK_FREE(pass);
 }
 
-GLOBAL void begin_render_pass(RenderPass pass)
+INTERNAL void backend_begin_render_pass(RenderPass pass)
 {
     // Nothing...
 }
 
-GLOBAL void end_render_pass(void)
+INTERNAL void backend_end_render_pass(void)
 {
     // Nothing...
 }
@@ -137,14 +158,16 @@ DEFINE_PRIVATE_TYPE(RenderPipeline)
     // Nothing...
 };
 
-GLOBAL RenderPipeline create_render_pipeline(const RenderPipelineDesc& desc)
+INTERNAL RenderPipeline backend_create_render_pipeline(const RenderPipelineDesc& desc)
 {
-    return NULL;
+    RenderPipeline pipeline = ALLOCATE_PRIVATE_TYPE(RenderPipeline);
+    if(!pipeline) fatal_error("Failed to allocate render pipeline!");
+    return pipeline;
 }
 
-GLOBAL void free_render_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_free_render_pipeline(RenderPipeline pipeline)
 {
-    // Nothing...
+    NK_FREE(pipeline);
 }
 
 // =============================================================================
@@ -156,62 +179,67 @@ GLOBAL void setup_renderer_platform(void)
     // Nothing...
 }
 
-GLOBAL void init_render_system(void)
+INTERNAL void backend_init_render_system(void)
+{
+    // Nothing...
+}
+
+INTERNAL void backend_quit_render_system(void)
 {
     // Nothing...
 }
 
-GLOBAL void quit_render_system(void)
+INTERNAL void backend_bind_context(nkBool bind)
 {
     // Nothing...
 }
 
-GLOBAL void maybe_resize_backbuffer(void)
+INTERNAL void backend_maybe_resize_backbuffer(void)
 {
     // Nothing...
 }
 
-GLOBAL void present_renderer(void)
+INTERNAL void backend_present_renderer(void)
 {
     // Nothing...
 }
 
-GLOBAL void set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_set_viewport(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     // Nothing...
 }
 
-GLOBAL void begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
+INTERNAL void backend_begin_scissor(nkF32 x, nkF32 y, nkF32 w, nkF32 h)
 {
     // Nothing...
 }
 
-GLOBAL void end_scissor(void)
+INTERNAL void backend_end_scissor(void)
 {
     // Nothing...
 }
 
-GLOBAL void bind_pipeline(RenderPipeline pipeline)
+INTERNAL void backend_bind_pipeline(RenderPipeline pipeline)
 {
     // Nothing...
 }
 
-GLOBAL void bind_buffer(Buffer buffer, nkS32 slot)
+INTERNAL void backend_bind_buffer(Buffer buffer, nkS32 slot)
 {
     // Nothing...
 }
 
-GLOBAL void bind_texture(Texture texture, Sampler sampler, nkS32 unit)
+INTERNAL void backend_bind_texture(Texture texture, Sampler sampler, nkS32 unit)
 {
     // Nothing...
 }
 
-GLOBAL void draw_arrays(nkU64 vertex_count)
+INTERNAL void backend_draw_arrays(nkU64 vertex_count)
 {
     // Nothing...
 }
 
-GLOBAL void draw_elements(nkU64 element_count, ElementType element_type, nkU64 byteOffset)
+INTERNAL void backend_draw_elements(nkU64 element_count, ElementType element_type, nkU64 byteOffset)
 {
     // Nothing...
 }
@@ -3,188 +3,1114 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+// HarfBuzz is optional, when USE_HARFBUZZ is defined fonts created with TrueTypeFontFlags_Shaping will be shaped using
+// it (ligatures, combining marks, complex scripts, etc.). Otherwise we fall back to our own simple shaper which just
+// maps codepoints to glyphs and applies pair kerning, this is the same output as the non-shaped text path.
+#if defined(USE_HARFBUZZ)
+#include <hb.h>
+#include <hb-ft.h>
+#endif // USE_HARFBUZZ
+
 // Converts from FreeType's fixed-point to floating-point.
 #define FT_CEIL(x) ((nkF32)(((x + 63) & -64) / 64))
 
 INTERNAL constexpr nkS32 FONT_ATLAS_SIZE    = 1024;
 INTERNAL constexpr nkS32 FONT_ATLAS_PADDING = 4;
 
-// Glyphs are indexed into a hashmap using this structure because just the codepoint is not enough information. We
-// can cache multiple sizes of the same glyph in one atlas so we need to also know the size for correct lookup.
+INTERNAL constexpr nkU64 SHAPE_CACHE_MAX_RUNS = 512; // Once hit the whole cache is flushed, text is usually the same from frame-to-frame.
+
+// Glyphs are indexed into a hashmap using this structure because just the glyph index is not enough information. We
+// can cache multiple sizes of the same glyph in one atlas so we need to also know the size for correct lookup. We
+// store glyph indices rather than codepoints so that codepoints which map to the same glyph (e.g. all the codepoints
+// that are missing from the font and map to the tofu) only get rasterized once, and so shaped output can be drawn.
 struct GlyphID
 {
-    nkS32   px_size;
-    wchar_t codepoint;
+    nkS32 px_size;
+    nkU32 index;
 };
 
-DEFINE_PRIVATE_TYPE(TrueTypeFont)
+// Kerning is looked up by glyph index and memoized as FT_Get_Kerning has to search the font's kerning table every call.
+struct KerningID
+{
+    nkS32 px_size;
+    nkU32 left;
+    nkU32 right;
+};
+
+// Shaped runs are cached by the hash of their text, the text's length, and the size of the font they were shaped at.
+struct ShapeKey
 {
-    // @Improve: Instead of mapping wchar_t's directly to glyphs we should map wchar_t's to indicies and indicies to
-    // glyphs. That way we don't end up with multiple tofus or other redundant glyphs being rasterized in our atlas.
+    nkU64 hash;
+    nkU64 length;
+    nkS32 px_size;
+    nkS32 padding; // Zeroed so that the whole structure can be hashed.
+};
+
+struct ShapedGlyph
+{
+    nkU32  index; // Glyph index within the font face (not a codepoint).
+    nkF32  advance;
+    nkF32  offset_x;
+    nkF32  offset_y;
+    nkBool line_break;
+};
 
+struct ShapedRun
+{
+    nkArray<ShapedGlyph> glyphs;
+    nkString             text; // A copy of the source text so hash collisions can be detected.
+    nkF32                width;
+};
+
+DEFINE_PRIVATE_TYPE(TrueTypeFont)
+{
     nkHashMap<nkS32,TrueTypeMetrics> metrics; // Store metrics per-size of the font cached.
     nkHashMap<GlyphID,Glyph>         glyphs;
+    nkHashMap<nkU32,nkU32>           char_indices; // Maps codepoints to glyph indices.
+    nkHashMap<KerningID,nkF32>       kerning;
+    nkHashMap<ShapeKey,ShapedRun*>   shape_cache; // Stores pointers as the hashmap does not destruct its values.
+    nkArray<ShapedRun*>              spare_runs;  // Runs from flushing the cache, reused so changing text doesn't allocate.
     nkArray<CharRange>               ranges;
     TrueTypeFontFlags                flags;
     Texture                          atlas_texture;
     nkU8*                            atlas_pixels;
     nkVec2                           atlas_cursor;
     nkF32                            atlas_row_max_height;
+    nkBool                           atlas_dirty; // Glyphs have been baked on-demand and need uploading.
     nkS32                            current_size;
+    nkS32                            face_size; // The size the FreeType face is currently set to.
     FT_Face                          font_face;
     nkU8*                            data_buffer;
     nkU64                            data_size;
     nkBool                           owns_data;
+
+    #if defined(USE_HARFBUZZ)
+    hb_font_t*                       hb_font;
+    #endif // USE_HARFBUZZ
 };
 
 struct TrueTypeFontSystem
 {
     FT_Library freetype;
     Shader     font_shader;
+
+    #if defined(USE_HARFBUZZ)
+    hb_buffer_t* hb_buffer; // Shared between all fonts, shaping only happens on the main thread.
+    #endif // USE_HARFBUZZ
 };
 
 INTERNAL TrueTypeFontSystem g_truetype;
 
-INTERNAL void bake_font_glyph(TrueTypeFont font, nkS32 size, wchar_t codepoint)
+INTERNAL void set_font_face_size(TrueTypeFont font, nkS32 size)
+{
+    NK_ASSERT(font);
+
+    // FT_Set_Pixel_Sizes isn't free so only call it when the size actually changes.
+    if(font->face_size == size) return;
+
+    FT_Error error = FT_Set_Pixel_Sizes(font->font_face, 0, size);
+    if(error != 0)
+        fatal_error("Failed to set font pixel size to %d! (%d)", size, error);
+
+    font->face_size = size;
+
+    #if defined(USE_HARFBUZZ)
+    if(font->hb_font) hb_ft_font_changed(font->hb_font);
+    #endif // USE_HARFBUZZ
+}
+
+INTERNAL void update_font_atlas_texture(TrueTypeFont font)
+{
+    NK_ASSERT(font);
+
+    // @Improve: Add a way of updating a texture's pixels without fully recrating it...
+
+    if(font->atlas_texture) free_texture(font->atlas_texture);
+
+    TextureDesc texture_desc;
+    texture_desc.format = TextureFormat_R;
+    texture_desc.width  = FONT_ATLAS_SIZE;
+    texture_desc.height = FONT_ATLAS_SIZE;
+    texture_desc.data   = font->atlas_pixels;
+    font->atlas_texture = create_texture(texture_desc);
+
+    font->atlas_dirty = NK_FALSE;
+}
+
+INTERNAL nkU32 get_char_index(TrueTypeFont font, nkU32 codepoint)
+{
+    NK_ASSERT(font);
+
+    // Lookup the index from the codepoint, we cache these as FT_Get_Char_Index has to search the font's charmap.
+    nkU32* index = nk_hashmap_getptr(&font->char_indices, codepoint);
+    if(index) return *index;
+
+    nkU32 new_index = FT_Get_Char_Index(font->font_face, codepoint);
+    nk_hashmap_insert(&font->char_indices, codepoint, new_index);
+    return new_index;
+}
+
+// Only codepoints in the baked ranges get cached, anything else (e.g. text using characters that were never baked) is
+// looked up without being added so the cache doesn't keep growing and get_glyph can still treat them as missing.
+INTERNAL nkU32 find_char_index(TrueTypeFont font, nkU32 codepoint)
+{
+    NK_ASSERT(font);
+
+    nkU32* index = nk_hashmap_getptr(&font->char_indices, codepoint);
+    if(index) return *index;
+
+    return FT_Get_Char_Index(font->font_face, codepoint);
+}
+
+// Glyphs are baked in two steps: first they are rasterized into their own bitmap, and then that bitmap is packed into
+// the font's atlas. This split lets us rasterize on worker threads (each with their own FT_Face as faces are not safe to
+// share between threads) while the packing, which needs to be deterministic, stays on the main thread.
+struct GlyphBitmap
+{
+    GlyphInfo info;
+    nkU8*     pixels; // Always unpacked to one byte per pixel, even for monochrome fonts.
+};
+
+// Expects the font face to already be set to the size being rasterized.
+INTERNAL void rasterize_font_glyph(FT_Face face, nkU32 index, nkBool mono, GlyphBitmap* glyph_bitmap)
+{
+    NK_ASSERT(face);
+    NK_ASSERT(glyph_bitmap);
+
+    FT_Int32 load_flags = ((mono) ? FT_LOAD_RENDER|FT_LOAD_TARGET_MONO : FT_LOAD_RENDER);
+    FT_Error error = FT_Load_Glyph(face, index, load_flags);
+    if(error != 0) fatal_error("Failed to load font glyph! (%d)", error);
+
+    FT_GlyphSlot slot = face->glyph;
+    FT_Bitmap* bitmap = &face->glyph->bitmap;
+
+    glyph_bitmap->info.offset_x =  slot->bitmap_left;
+    glyph_bitmap->info.offset_y = -slot->bitmap_top;
+    glyph_bitmap->info.width    =  bitmap->width;
+    glyph_bitmap->info.height   =  bitmap->rows;
+    glyph_bitmap->info.advance  =  FT_CEIL(slot->advance.x);
+
+    glyph_bitmap->pixels = NULL;
+
+    nkS32 width = glyph_bitmap->info.width;
+    nkS32 height = glyph_bitmap->info.height;
+
+    if(width <= 0 || height <= 0) return;
+
+    glyph_bitmap->pixels = NK_MALLOC_TYPES(nkU8, width*height);
+    if(!glyph_bitmap->pixels) fatal_error("Failed to allocate glyph bitmap!");
+
+    for(nkS32 y=0; y<height; ++y)
+    {
+        nkU8* dst = glyph_bitmap->pixels + (y * width);
+        nkU8* src = bitmap->buffer + (y * bitmap->pitch);
+
+        if(!mono)
+        {
+            memcpy(dst, src, width);
+        }
+        else
+        {
+            // When rendering in monochrome, FreeType packs 8 pixels into a single byte.
+            // So, we need to unpack the pixels into our single channel pixel format.
+            for(nkS32 x=0; x<width; ++x)
+            {
+                dst[x] = ((src[x/8] >> (7-(x%8))) & 0x01) * 0xFF;
+            }
+        }
+    }
+}
+
+INTERNAL void pack_font_glyph(TrueTypeFont font, nkS32 size, nkU32 index, const GlyphBitmap& glyph_bitmap)
+{
+    NK_ASSERT(font);
+
+    Glyph glyph = NK_ZERO_MEM;
+
+    glyph.info = glyph_bitmap.info;
+
+    // @Improve: Pull these out so the caller can control how much padding...
+    nkF32 x_padding = NK_CAST(nkF32, FONT_ATLAS_PADDING);
+    nkF32 y_padding = NK_CAST(nkF32, FONT_ATLAS_PADDING);
+
+    if((font->atlas_cursor.x + glyph.info.width) >= FONT_ATLAS_SIZE)
+    {
+        font->atlas_cursor.y += font->atlas_row_max_height + y_padding;
+        font->atlas_cursor.x = 0.0f;
+        font->atlas_row_max_height = 0.0f;
+    }
+
+    // @Improve: Handle no more space to pack glyphs better!
+    NK_ASSERT((font->atlas_cursor.y + glyph.info.height) < FONT_ATLAS_SIZE);
+
+    glyph.bounds.x = font->atlas_cursor.x;
+    glyph.bounds.y = font->atlas_cursor.y;
+    glyph.bounds.w = NK_CAST(nkF32, glyph.info.width);
+    glyph.bounds.h = NK_CAST(nkF32, glyph.info.height);
+
+    for(nkS32 y=0; y<glyph.info.height; ++y)
+    {
+        nkU8* dst = font->atlas_pixels + NK_CAST(nkS32, (((glyph.bounds.y+y) * FONT_ATLAS_SIZE + glyph.bounds.x)));
+        nkU8* src = glyph_bitmap.pixels + (y * glyph.info.width);
+        memcpy(dst, src, glyph.info.width);
+    }
+
+    font->atlas_cursor.x += glyph.bounds.w + x_padding;
+    font->atlas_row_max_height = nk_max(font->atlas_row_max_height, glyph.bounds.h);
+
+    GlyphID glyph_id = NK_ZERO_MEM;
+    glyph_id.px_size = size;
+    glyph_id.index = index;
+
+    nk_hashmap_insert(&font->glyphs, glyph_id, glyph);
+}
+
+// Expects the font face to already be set to the size being baked.
+INTERNAL void bake_font_glyph(TrueTypeFont font, nkS32 size, nkU32 index)
+{
+    NK_ASSERT(font);
+
+    GlyphID glyph_id = NK_ZERO_MEM;
+    glyph_id.px_size = size;
+    glyph_id.index = index;
+
+    // Multiple codepoints can map to the same glyph so it may already be baked.
+    if(nk_hashmap_contains(&font->glyphs, glyph_id)) return;
+
+    nkBool mono = NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Monochrome);
+
+    GlyphBitmap glyph_bitmap;
+    rasterize_font_glyph(font->font_face, index, mono, &glyph_bitmap);
+    pack_font_glyph(font, size, index, glyph_bitmap);
+    NK_FREE(glyph_bitmap.pixels);
+}
+
+// Parallel Baking ============================================================
+
+INTERNAL constexpr nkU64 FONT_BAKE_MIN_GLYPHS  = 128; // Below this it's not worth creating faces for the other job threads.
+INTERNAL constexpr nkS32 FONT_BAKE_BATCH_SIZE  =  16; // How many glyphs a job thread takes at a time.
+
+struct FontBakeItem
+{
+    nkS32       size;
+    nkU32       index;
+    GlyphBitmap bitmap;
+};
+
+struct FontBakeFace
+{
+    FT_Face face;
+    nkS32   size;
+};
+
+struct FontBake
+{
+    FontBakeItem* items;
+    FontBakeFace* faces; // One per job thread, indexed using get_job_thread_index.
+    nkBool        mono;
+};
+
+INTERNAL void rasterize_font_bake_items(nkS32 begin, nkS32 end, void* user_data)
+{
+    FontBake* bake = NK_CAST(FontBake*, user_data);
+    FontBakeFace* face = &bake->faces[get_job_thread_index()];
+
+    for(nkS32 i=begin; i<end; ++i)
+    {
+        FontBakeItem& item = bake->items[i];
+
+        // Items are sorted by size so a thread will rarely have to change its face's size.
+        if(face->size != item.size)
+        {
+            FT_Error error = FT_Set_Pixel_Sizes(face->face, 0, item.size);
+            if(error != 0) fatal_error("Failed to set font pixel size to %d! (%d)", item.size, error);
+            face->size = item.size;
+        }
+
+        rasterize_font_glyph(face->face, item.index, bake->mono, &item.bitmap);
+    }
+}
+
+// Rasterizes all of the glyphs for the given sizes across the available cores and then packs them into the atlas.
+INTERNAL void bake_font_at_sizes(TrueTypeFont font, const nkS32* sizes, nkU64 size_count)
 {
     NK_ASSERT(font);
+    NK_ASSERT(sizes);
+
+    nkArray<FontBakeItem> items;
+
+    // Set up the metrics for each size and gather up all the glyphs that need rasterizing.
+    nkHashMap<GlyphID,nkBool> queued;
+    for(nkU64 i=0; i<size_count; ++i)
+    {
+        nkS32 size = sizes[i];
+
+        if(nk_hashmap_contains(&font->metrics, size))
+        {
+            printf("[Font]: Attempting to bake font size %d that already exists!\n", size);
+            continue;
+        }
+
+        set_font_face_size(font, size);
+
+        // Add the metric information for the size.
+        FT_Size_Metrics ft_metrics = font->font_face->size->metrics;
+
+        TrueTypeMetrics metrics;
+        metrics.ascent       = FT_CEIL(ft_metrics.ascender);
+        metrics.descent      = FT_CEIL(ft_metrics.descender);
+        metrics.line_space   = FT_CEIL(ft_metrics.height);
+        metrics.line_gap     = FT_CEIL(ft_metrics.height - ft_metrics.ascender + ft_metrics.descender);
+        metrics.max_advance  = FT_CEIL(ft_metrics.max_advance);
+        nk_hashmap_insert(&font->metrics, size, metrics);
+
+        for(auto& range: font->ranges)
+        {
+            for(nkU32 codepoint=range.start; codepoint<=range.end; ++codepoint)
+            {
+                GlyphID glyph_id = NK_ZERO_MEM;
+                glyph_id.px_size = size;
+                glyph_id.index = get_char_index(font, codepoint);
+
+                // Multiple codepoints can map to the same glyph so make sure we only rasterize it once.
+                if(nk_hashmap_contains(&font->glyphs, glyph_id)) continue;
+                if(nk_hashmap_contains(&queued, glyph_id)) continue;
+                nk_hashmap_insert(&queued, glyph_id, NK_TRUE);
+
+                FontBakeItem item = NK_ZERO_MEM;
+                item.size = size;
+                item.index = glyph_id.index;
+                nk_array_append(&items, item);
+            }
+        }
+    }
+    nk_hashmap_free(&queued);
+
+    if(items.length == 0) return;
+
+    // Each job thread gets its own face as they can't be shared between threads. The main thread uses the font's own face
+    // and the others get faces created from the same memory, which is fine as FreeType only ever reads from it. Faces have
+    // to be created and destroyed on the main thread as the FT_Library is not thread-safe, so they're all made up front.
+    NK_ASSERT(get_job_thread_index() == 0); // Fonts can only be baked from the main thread!
+
+    nkS32 thread_count = (items.length < FONT_BAKE_MIN_GLYPHS) ? 1 : get_job_thread_count();
+
+    nkArray<FontBakeFace> faces;
+    nk_array_reserve(&faces, thread_count);
+    for(nkS32 i=0; i<thread_count; ++i)
+    {
+        FontBakeFace face = NK_ZERO_MEM;
+        if(i == 0)
+        {
+            face.face = font->font_face;
+            face.size = font->face_size;
+        }
+        else
+        {
+            FT_Error error = FT_New_Memory_Face(g_truetype.freetype, font->data_buffer, NK_CAST(FT_Long, font->data_size), 0, &face.face);
+            if(error != 0) fatal_error("Failed to create new font face! (%d)", error);
+            error = FT_Select_Charmap(face.face, FT_ENCODING_UNICODE);
+            if(error != 0) fatal_error("Failed to select font character map! (%d)", error);
+        }
+        nk_array_append(&faces, face);
+    }
+
+    FontBake bake;
+    bake.items = items.data;
+    bake.faces = faces.data;
+    bake.mono  = NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Monochrome);
+
+    // Without faces for the other threads everything is rasterized right here.
+    if(thread_count == 1) rasterize_font_bake_items(0, NK_CAST(nkS32, items.length), &bake);
+    else parallel_for(NK_CAST(nkS32, items.length), FONT_BAKE_BATCH_SIZE, rasterize_font_bake_items, &bake);
+
+    for(nkS32 i=1; i<thread_count; ++i)
+    {
+        FT_Done_Face(faces[i].face);
+    }
+    nk_array_free(&faces);
+
+    // The main thread changed the font's face size behind our back, so force it to be set again next time.
+    font->face_size = 0;
+
+    // Pack everything in the same order as it was queued so the atlas layout doesn't depend on the thread timings.
+    for(auto& item: items)
+    {
+        pack_font_glyph(font, item.size, item.index, item.bitmap);
+        NK_FREE(item.bitmap.pixels);
+    }
+
+    nk_array_free(&items);
+}
+
+INTERNAL void bake_font_at_size(TrueTypeFont font, nkS32 size)
+{
+    bake_font_at_sizes(font, &size, 1);
+}
+
+// Font Cache =================================================================
+
+// Fonts can optionally save their baked atlas to disk so that later runs can skip rasterizing entirely. The cache file is
+// named using a hash of everything that affects the baked output, so if the font data, flags, sizes, or ranges change a
+// new cache file is made rather than loading a stale one. We still create the FreeType face as it's needed for baking
+// any glyphs on-demand, but creating a face is cheap compared to rasterizing every glyph at every size.
+
+INTERNAL constexpr nkU32         FONT_CACHE_MAGIC              = NK_FOURCC('NKFC');
+INTERNAL constexpr nkU32         FONT_CACHE_VERSION            = 1;
+INTERNAL constexpr nkU64         FONT_CACHE_MAX_KERNING_GLYPHS = 256; // Don't precompute kerning pairs for huge glyph sets.
+INTERNAL constexpr const nkChar* FONT_CACHE_PATH               = "font_cache/";
+
+struct FontCacheHeader
+{
+    nkU32 magic;
+    nkU32 version;
+    nkU64 key;
+    nkU32 atlas_size;
+    nkU32 metrics_count;
+    nkU32 glyphs_count;
+    nkU32 char_indices_count;
+    nkU32 kerning_count;
+    nkF32 atlas_cursor_x;
+    nkF32 atlas_cursor_y;
+    nkF32 atlas_row_max_height;
+};
+
+// The cache is just the header followed by arrays of these entries and then the raw atlas pixels.
+struct FontCacheMetrics    { nkS32     px_size;   TrueTypeMetrics metrics; };
+struct FontCacheGlyph      { GlyphID   id;        Glyph           glyph;   };
+struct FontCacheCharIndex  { nkU32     codepoint; nkU32           index;   };
+struct FontCacheKerning    { KerningID id;        nkF32           kerning; };
+
+INTERNAL nkU64 get_font_cache_key(const TrueTypeFontDesc& desc)
+{
+    nkU64 key = FNV1A_OFFSET_BASIS;
+
+    // Only the flags that change the rasterized output should invalidate the cache.
+    TrueTypeFontFlags flags = desc.flags & TrueTypeFontFlags_Monochrome;
+
+    key = hash_fnv1a(&FONT_CACHE_VERSION, sizeof(FONT_CACHE_VERSION), key);
+    key = hash_fnv1a(&FONT_ATLAS_SIZE, sizeof(FONT_ATLAS_SIZE), key);
+    key = hash_fnv1a(&FONT_ATLAS_PADDING, sizeof(FONT_ATLAS_PADDING), key);
+    key = hash_fnv1a(&flags, sizeof(flags), key);
+    key = hash_fnv1a(desc.px_sizes.data, desc.px_sizes.length * sizeof(nkS32), key);
+    key = hash_fnv1a(desc.ranges.data, desc.ranges.length * sizeof(CharRange), key);
+    key = hash_fnv1a(desc.data, desc.size, key);
+
+    return key;
+}
+
+INTERNAL nkString get_font_cache_file_name(nkU64 key)
+{
+    return format_string("%s%s%016llX.bin", get_base_path(), FONT_CACHE_PATH, NK_CAST(unsigned long long, key));
+}
+
+INTERNAL void precompute_font_kerning(TrueTypeFont font)
+{
+    NK_ASSERT(font);
+
+    if(!NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_HasKerning)) return;
+
+    // Gather up all of the unique glyphs that were baked from the ranges.
+    nkArray<nkU32> indices;
+    nkHashMap<nkU32,nkBool> seen;
+    for(auto& slot: font->char_indices)
+    {
+        if(nk_hashmap_contains(&seen, slot.value)) continue;
+        nk_hashmap_insert(&seen, slot.value, NK_TRUE);
+        nk_array_append(&indices, slot.value);
+    }
+    nk_hashmap_free(&seen);
+
+    if(indices.length <= FONT_CACHE_MAX_KERNING_GLYPHS)
+    {
+        for(auto& metrics_slot: font->metrics)
+        {
+            set_font_face_size(font, metrics_slot.key);
+
+            for(nkU32 left: indices)
+            {
+                for(nkU32 right: indices)
+                {
+                    KerningID kerning_id = NK_ZERO_MEM;
+                    kerning_id.px_size = metrics_slot.key;
+                    kerning_id.left = left;
+                    kerning_id.right = right;
+
+                    if(nk_hashmap_contains(&font->kerning, kerning_id)) continue;
+
+                    FT_Vector vector;
+                    FT_Get_Kerning(font->font_face, left, right, FT_KERNING_DEFAULT, &vector); // @Improve: Handle error???
+                    nk_hashmap_insert(&font->kerning, kerning_id, FT_CEIL(vector.x));
+                }
+            }
+        }
+    }
+
+    nk_array_free(&indices);
+}
+
+INTERNAL nkBool read_font_cache_bytes(const nkU8** cursor, const nkU8* end, void* dst, nkU64 size)
+{
+    if(NK_CAST(nkU64, end - *cursor) < size) return NK_FALSE;
+    memcpy(dst, *cursor, size);
+    *cursor += size;
+    return NK_TRUE;
+}
+
+INTERNAL nkBool load_font_cache(TrueTypeFont font, const nkChar* file_name, nkU64 key)
+{
+    NK_ASSERT(font);
+    NK_ASSERT(file_name);
+
+    if(!nk_file_exists(file_name)) return NK_FALSE;
+
+    nkFileContent file_content = NK_ZERO_MEM;
+    if(!nk_read_file_content(&file_content, file_name, nkFileReadMode_Binary))
+    {
+        printf("[Font]: Failed to read font cache file: %s\n", file_name);
+        return NK_FALSE;
+    }
+
+    const nkU8* cursor = NK_CAST(const nkU8*, file_content.data);
+    const nkU8* end = cursor + file_content.size;
+
+    // Validate the whole file before touching the font so that a bad cache leaves nothing half-loaded.
+    FontCacheHeader header = NK_ZERO_MEM;
+    nkBool valid = read_font_cache_bytes(&cursor, end, &header, sizeof(header));
+    if(valid)
+    {
+        nkU64 expected_size = 0;
+        expected_size += header.metrics_count      * sizeof(FontCacheMetrics);
+        expected_size += header.glyphs_count       * sizeof(FontCacheGlyph);
+        expected_size += header.char_indices_count * sizeof(FontCacheCharIndex);
+        expected_size += header.kerning_count      * sizeof(FontCacheKerning);
+        expected_size += FONT_ATLAS_SIZE * FONT_ATLAS_SIZE;
+
+        valid = (header.magic == FONT_CACHE_MAGIC &&
+                 header.version == FONT_CACHE_VERSION &&
+                 header.key == key &&
+                 header.atlas_size == FONT_ATLAS_SIZE &&
+                 NK_CAST(nkU64, end - cursor) == expected_size);
+    }
+    if(!valid)
+    {
+        printf("[Font]: Font cache file is invalid or out of date: %s\n", file_name);
+        nk_free_file_content(&file_content);
+        return NK_FALSE;
+    }
+
+    for(nkU32 i=0; i<header.metrics_count; ++i)
+    {
+        FontCacheMetrics entry;
+        read_font_cache_bytes(&cursor, end, &entry, sizeof(entry));
+        nk_hashmap_insert(&font->metrics, entry.px_size, entry.metrics);
+    }
+    for(nkU32 i=0; i<header.glyphs_count; ++i)
+    {
+        FontCacheGlyph entry;
+        read_font_cache_bytes(&cursor, end, &entry, sizeof(entry));
+        nk_hashmap_insert(&font->glyphs, entry.id, entry.glyph);
+    }
+    for(nkU32 i=0; i<header.char_indices_count; ++i)
+    {
+        FontCacheCharIndex entry;
+        read_font_cache_bytes(&cursor, end, &entry, sizeof(entry));
+        nk_hashmap_insert(&font->char_indices, entry.codepoint, entry.index);
+    }
+    for(nkU32 i=0; i<header.kerning_count; ++i)
+    {
+        FontCacheKerning entry;
+        read_font_cache_bytes(&cursor, end, &entry, sizeof(entry));
+        nk_hashmap_insert(&font->kerning, entry.id, entry.kerning);
+    }
+
+    read_font_cache_bytes(&cursor, end, font->atlas_pixels, FONT_ATLAS_SIZE * FONT_ATLAS_SIZE);
+
+    font->atlas_cursor.x = header.atlas_cursor_x;
+    font->atlas_cursor.y = header.atlas_cursor_y;
+    font->atlas_row_max_height = header.atlas_row_max_height;
+
+    nk_free_file_content(&file_content);
+
+    return NK_TRUE;
+}
+
+INTERNAL void save_font_cache(TrueTypeFont font, const nkChar* file_name, nkU64 key)
+{
+    NK_ASSERT(font);
+    NK_ASSERT(file_name);
+
+    nkString cache_path = format_string("%s%s", get_base_path(), FONT_CACHE_PATH);
+    if(!nk_path_exists(cache_path.cstr))
+    {
+        nk_create_path(cache_path.cstr);
+    }
+
+    // Only non-zero kerning pairs get saved, any missing pairs will just get looked up again when needed.
+    nkU32 kerning_count = 0;
+    for(auto& slot: font->kerning)
+    {
+        if(slot.value != 0.0f) kerning_count++;
+    }
+
+    FontCacheHeader header = NK_ZERO_MEM;
+    header.magic                = FONT_CACHE_MAGIC;
+    header.version              = FONT_CACHE_VERSION;
+    header.key                  = key;
+    header.atlas_size           = FONT_ATLAS_SIZE;
+    header.metrics_count        = NK_CAST(nkU32, font->metrics.count);
+    header.glyphs_count         = NK_CAST(nkU32, font->glyphs.count);
+    header.char_indices_count   = NK_CAST(nkU32, font->char_indices.count);
+    header.kerning_count        = kerning_count;
+    header.atlas_cursor_x       = font->atlas_cursor.x;
+    header.atlas_cursor_y       = font->atlas_cursor.y;
+    header.atlas_row_max_height = font->atlas_row_max_height;
+
+    FILE* file = fopen(file_name, "wb");
+    if(!file)
+    {
+        printf("[Font]: Failed to open font cache file: %s\n", file_name);
+        return;
+    }
+
+    nkBool success = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    for(auto& slot: font->metrics)
+    {
+        FontCacheMetrics entry = NK_ZERO_MEM;
+        entry.px_size = slot.key;
+        entry.metrics = slot.value;
+        success = success && (fwrite(&entry, sizeof(entry), 1, file) == 1);
+    }
+    for(auto& slot: font->glyphs)
+    {
+        FontCacheGlyph entry = NK_ZERO_MEM;
+        entry.id = slot.key;
+        entry.glyph = slot.value;
+        success = success && (fwrite(&entry, sizeof(entry), 1, file) == 1);
+    }
+    for(auto& slot: font->char_indices)
+    {
+        FontCacheCharIndex entry = NK_ZERO_MEM;
+        entry.codepoint = slot.key;
+        entry.index = slot.value;
+        success = success && (fwrite(&entry, sizeof(entry), 1, file) == 1);
+    }
+    for(auto& slot: font->kerning)
+    {
+        if(slot.value == 0.0f) continue;
+        FontCacheKerning entry = NK_ZERO_MEM;
+        entry.id = slot.key;
+        entry.kerning = slot.value;
+        success = success && (fwrite(&entry, sizeof(entry), 1, file) == 1);
+    }
+
+    success = success && (fwrite(font->atlas_pixels, FONT_ATLAS_SIZE * FONT_ATLAS_SIZE, 1, file) == 1);
+
+    fclose(file);
+
+    // Don't leave a broken cache around, it would just get rejected every launch.
+    if(!success)
+    {
+        printf("[Font]: Failed to write font cache file: %s\n", file_name);
+        nk_delete_file(file_name);
+    }
+}
+
+INTERNAL Glyph get_glyph_by_index(TrueTypeFont font, nkU32 index)
+{
+    NK_ASSERT(font);
+
+    GlyphID glyph_id = NK_ZERO_MEM; // NOTE: The zeroing of the memory is important here or else bytes used in hashing could be random!!!
+                                    //       We should probably just implement a custom hashing function for the GlyphID function instead...
+    glyph_id.px_size = font->current_size;
+    glyph_id.index = index;
+
+    if(nk_hashmap_contains(&font->glyphs, glyph_id))
+    {
+        return nk_hashmap_getref(&font->glyphs, glyph_id);
+    }
+    else
+    {
+        // If we don't have a glyph that has been requested then just return an empty glyph...
+        // Maybe we want to do something else here? Return a tofu glyph or something instead?
+        Glyph glyph = NK_ZERO_MEM;
+        return glyph;
+    }
+}
+
+INTERNAL void draw_truetype_glyph(const Glyph& glyph, nkF32 x, nkF32 y, nkF32 atlas_w, nkF32 atlas_h, nkVec4 color)
+{
+    nkF32 x1 = x  + glyph.info.offset_x;
+    nkF32 y1 = y  + glyph.info.offset_y;
+    nkF32 x2 = x1 + glyph.info.width;
+    nkF32 y2 = y1 + glyph.info.height;
+
+    nkF32 s1 =      (glyph.bounds.x / atlas_w);
+    nkF32 t1 =      (glyph.bounds.y / atlas_h);
+    nkF32 s2 = s1 + (glyph.bounds.w / atlas_w);
+    nkF32 t2 = t1 + (glyph.bounds.h / atlas_h);
+
+    imm_position(x1,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t2);
+    imm_position(x1,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t1);
+    imm_position(x2,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t2);
+    imm_position(x2,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t2);
+    imm_position(x1,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t1);
+    imm_position(x2,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t1);
+}
+
+// Shaping ====================================================================
+
+// Text is shaped one line at a time into a run of positioned glyph indices, the runs are then cached so that text which
+// is drawn every frame (which is most text) only ever has to be shaped once. Shaping is only done for UTF-8 text.
+
+INTERNAL nkF32 shape_truetype_line(TrueTypeFont font, const nkChar* text, nkU64 length, ShapedRun* run)
+{
+    NK_ASSERT(font);
+    NK_ASSERT(run);
+
+    nkF32 width = 0.0f;
+
+    #if defined(USE_HARFBUZZ)
+    hb_buffer_t* buffer = g_truetype.hb_buffer;
+
+    hb_buffer_reset(buffer);
+    hb_buffer_add_utf8(buffer, text, NK_CAST(int, length), 0, NK_CAST(int, length));
+    hb_buffer_guess_segment_properties(buffer);
+    hb_shape(font->hb_font, buffer, NULL, 0);
+
+    unsigned int glyph_count = 0;
+    hb_glyph_info_t* infos = hb_buffer_get_glyph_infos(buffer, &glyph_count);
+    hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, &glyph_count);
+
+    for(unsigned int i=0; i<glyph_count; ++i)
+    {
+        // HarfBuzz can produce glyphs that aren't in any of the baked ranges (e.g. ligatures) so bake them on-demand.
+        GlyphID glyph_id = NK_ZERO_MEM;
+        glyph_id.px_size = font->current_size;
+        glyph_id.index = infos[i].codepoint;
+        if(!nk_hashmap_contains(&font->glyphs, glyph_id))
+        {
+            bake_font_glyph(font, font->current_size, glyph_id.index);
+            font->atlas_dirty = NK_TRUE;
+        }
+
+        // HarfBuzz positions are in 26.6 fixed-point and y-up.
+        ShapedGlyph shaped_glyph = NK_ZERO_MEM;
+        shaped_glyph.index    =  infos[i].codepoint;
+        shaped_glyph.advance  =  NK_CAST(nkF32, positions[i].x_advance) / 64.0f;
+        shaped_glyph.offset_x =  NK_CAST(nkF32, positions[i].x_offset) / 64.0f;
+        shaped_glyph.offset_y = -NK_CAST(nkF32, positions[i].y_offset) / 64.0f;
+        nk_array_append(&run->glyphs, shaped_glyph);
+
+        width += shaped_glyph.advance;
+    }
+    #else
+    TextIterator iter = text_iterator_begin(text, length);
+
+    nkU32 curr_char = 0;
+    nkU32 next_char = 0;
+
+    nkBool has_curr = text_iterator_next(&iter, &curr_char);
+    while(has_curr)
+    {
+        nkBool has_next = text_iterator_next(&iter, &next_char);
+        if(!has_next) next_char = 0;
+
+        ShapedGlyph shaped_glyph = NK_ZERO_MEM;
+        shaped_glyph.index   = find_char_index(font, curr_char);
+        shaped_glyph.advance = get_glyph(font, curr_char).info.advance + get_kerning(font, curr_char, next_char);
+        nk_array_append(&run->glyphs, shaped_glyph);
+
+        width += shaped_glyph.advance;
+
+        curr_char = next_char;
+        has_curr = has_next;
+    }
+    #endif // USE_HARFBUZZ
+
+    return width;
+}
+
+INTERNAL void flush_shape_cache(TrueTypeFont font)
+{
+    NK_ASSERT(font);
+
+    // The runs and the map's slots are kept hold of so that once the cache has filled up once it stops allocating.
+    for(auto& slot: font->shape_cache)
+        nk_array_append(&font->spare_runs, slot.value);
+    nk_hashmap_clear(&font->shape_cache);
+}
+
+INTERNAL void free_shape_cache(TrueTypeFont font)
+{
+    NK_ASSERT(font);
+
+    // The hashmap does not handle deleting our pointers so we have to do that manually.
+    flush_shape_cache(font);
+    for(ShapedRun* run: font->spare_runs)
+        delete run;
+    nk_array_free(&font->spare_runs);
+    nk_hashmap_free(&font->shape_cache);
+}
+
+INTERNAL const ShapedRun* shape_truetype_text(TrueTypeFont font, const nkChar* text, nkU64 length)
+{
+    NK_ASSERT(font);
+    NK_ASSERT(text);
+
+    if(length == NK_U64_MAX) length = strlen(text);
+
+    ShapeKey key = NK_ZERO_MEM;
+    key.hash    = hash_fnv1a(text, length);
+    key.length  = length;
+    key.px_size = font->current_size;
+
+    ShapedRun* run = NULL;
+
+    ShapedRun** cached = nk_hashmap_getptr(&font->shape_cache, key);
+    if(cached)
+    {
+        run = *cached;
+        if(length == 0 || memcmp(run->text.cstr, text, length) == 0)
+        {
+            return run;
+        }
+        // If the text doesn't match then we have a hash collision, just reshape into the existing run.
+        nk_array_clear(&run->glyphs);
+    }
+    else
+    {
+        if(font->shape_cache.count >= SHAPE_CACHE_MAX_RUNS)
+        {
+            flush_shape_cache(font);
+        }
+        if(font->spare_runs.length > 0)
+        {
+            run = font->spare_runs[--font->spare_runs.length];
+            nk_array_clear(&run->glyphs);
+        }
+        else
+        {
+            run = new ShapedRun;
+        }
+        nk_hashmap_insert(&font->shape_cache, key, run);
+    }
+
+    nk_string_assign(&run->text, text, length);
+
+    set_font_face_size(font, font->current_size);
+
+    // Shape each line separately, the line breaks are stored in the run so we know where to move down.
+    run->width = 0.0f;
 
-    FT_Error error;
+    const nkChar* line_start = text;
+    const nkChar* text_end = text + length;
 
-    nkBool mono = NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Monochrome);
+    for(const nkChar* c=text; ; ++c)
+    {
+        if(c == text_end || *c == '\n')
+        {
+            nkF32 line_width = shape_truetype_line(font, line_start, NK_CAST(nkU64, c - line_start), run);
+            run->width = nk_max(run->width, line_width);
 
-    FT_UInt index = FT_Get_Char_Index(font->font_face, codepoint);
-    FT_Int32 load_flags = ((mono) ? FT_LOAD_RENDER|FT_LOAD_TARGET_MONO : FT_LOAD_RENDER);
-    error = FT_Load_Glyph(font->font_face, index, load_flags);
-    if(error != 0) fatal_error("Failed to load font glyph! (%d)", error);
+            if(c == text_end) break;
 
-    FT_GlyphSlot slot = font->font_face->glyph;
-    FT_Bitmap* bitmap = &font->font_face->glyph->bitmap;
+            ShapedGlyph line_break = NK_ZERO_MEM;
+            line_break.line_break = NK_TRUE;
+            nk_array_append(&run->glyphs, line_break);
 
-    Glyph glyph = NK_ZERO_MEM;
+            line_start = c+1;
+        }
+    }
 
-    glyph.info.offset_x =  font->font_face->glyph->bitmap_left;
-    glyph.info.offset_y = -font->font_face->glyph->bitmap_top;
-    glyph.info.width    =  bitmap->width;
-    glyph.info.height   =  bitmap->rows;
-    glyph.info.advance  =  FT_CEIL(slot->advance.x);
+    return run;
+}
 
-    // @Improve: Pull these out so the caller can control how much padding...
-    nkF32 x_padding = NK_CAST(nkF32, FONT_ATLAS_PADDING);
-    nkF32 y_padding = NK_CAST(nkF32, FONT_ATLAS_PADDING);
+INTERNAL void draw_truetype_shaped_run(TrueTypeFont font, nkF32 x, nkF32 y, const ShapedRun* run, nkVec4 color)
+{
+    NK_ASSERT(font);
+    NK_ASSERT(run);
 
-    if((font->atlas_cursor.x + glyph.info.width) >= FONT_ATLAS_SIZE)
+    if(run->glyphs.length == 0)
     {
-        font->atlas_cursor.y += font->atlas_row_max_height + y_padding;
-        font->atlas_cursor.x = 0.0f;
-        font->atlas_row_max_height = 0.0f;
+        return;
     }
 
-    // @Improve: Handle no more space to pack glyphs better!
-    NK_ASSERT((font->atlas_cursor.y + glyph.info.height) < FONT_ATLAS_SIZE);
+    if(font->atlas_dirty)
+    {
+        update_font_atlas_texture(font);
+    }
 
-    glyph.bounds.x = font->atlas_cursor.x;
-    glyph.bounds.y = font->atlas_cursor.y;
-    glyph.bounds.w = NK_CAST(nkF32, glyph.info.width);
-    glyph.bounds.h = NK_CAST(nkF32, glyph.info.height);
+    TrueTypeMetrics metrics = get_truetype_font_metrics(font);
 
-    for(FT_UInt y=0; y<glyph.bounds.h; ++y)
-    {
-        nkU8* dst = font->atlas_pixels + NK_CAST(nkS32, (((glyph.bounds.y+y) * FONT_ATLAS_SIZE + glyph.bounds.x)));
-        nkU8* src = bitmap->buffer + (y * bitmap->pitch);
+    nkF32 tx = x;
+    nkF32 ty = y;
 
-        if(!mono)
+    nkF32 atlas_w = NK_CAST(nkF32, get_texture_width(font->atlas_texture));
+    nkF32 atlas_h = NK_CAST(nkF32, get_texture_height(font->atlas_texture));
+
+    Texture old_texture = imm_get_texture();
+    Shader old_shader = imm_get_shader();
+
+    imm_set_texture(font->atlas_texture);
+    imm_set_shader(g_truetype.font_shader);
+
+    imm_begin(DrawMode_Triangles);
+
+    for(auto& shaped_glyph: run->glyphs)
+    {
+        if(shaped_glyph.line_break)
         {
-            memcpy(dst, src, bitmap->pitch);
+            tx = x;
+            ty += roundf(metrics.ascent - metrics.descent);
         }
         else
         {
-            // When rendering in monochrome, FreeType packs 8 pixels into a single byte.
-            // So, we need to unpack the pixels into our single channel pixel format.
-            for(FT_Int x=0; x<bitmap->pitch; ++x)
-            {
-                nkU8 packed_pixels = src[x];
-
-                dst[(x*8)+7] = ((packed_pixels & 0x01) >> 0) * 0xFF;
-                dst[(x*8)+6] = ((packed_pixels & 0x02) >> 1) * 0xFF;
-                dst[(x*8)+5] = ((packed_pixels & 0x04) >> 2) * 0xFF;
-                dst[(x*8)+4] = ((packed_pixels & 0x08) >> 3) * 0xFF;
-                dst[(x*8)+3] = ((packed_pixels & 0x10) >> 4) * 0xFF;
-                dst[(x*8)+2] = ((packed_pixels & 0x20) >> 5) * 0xFF;
-                dst[(x*8)+1] = ((packed_pixels & 0x40) >> 6) * 0xFF;
-                dst[(x*8)+0] = ((packed_pixels & 0x80) >> 7) * 0xFF;
-            }
+            Glyph glyph = get_glyph_by_index(font, shaped_glyph.index);
+            nkF32 gx = roundf(tx + shaped_glyph.offset_x);
+            nkF32 gy = roundf(ty + shaped_glyph.offset_y);
+            draw_truetype_glyph(glyph, gx, gy, atlas_w, atlas_h, color);
+            tx += roundf(shaped_glyph.advance);
         }
     }
 
-    font->atlas_cursor.x += glyph.bounds.w + x_padding;
-    font->atlas_row_max_height = nk_max(font->atlas_row_max_height, glyph.bounds.h);
+    imm_end();
 
-    GlyphID glyph_id = { size, codepoint };
-    nk_hashmap_insert(&font->glyphs, glyph_id, glyph);
+    imm_set_shader(old_shader);
+    imm_set_texture(old_texture);
 }
 
-INTERNAL void bake_font_at_size(TrueTypeFont font, nkS32 size)
+// Text =======================================================================
+
+// All of the text measuring and drawing functions go through these, the public string overloads just wrap the text in
+// an iterator which decodes the codepoints in place. That way nothing needs to be converted or allocated per call.
+
+INTERNAL nkF32 get_truetype_text_width(TrueTypeFont font, TextIterator iter)
 {
     NK_ASSERT(font);
 
-    if(nk_hashmap_contains(&font->metrics, size))
+    nkF32 line_width = 0.0f;
+    nkF32 width = 0.0f;
+
+    // We need to look one codepoint ahead in order to apply kerning.
+    nkU32 curr_char = 0;
+    nkU32 next_char = 0;
+
+    nkBool has_curr = text_iterator_next(&iter, &curr_char);
+    while(has_curr)
     {
-        printf("[Font]: Attempting to bake font size %d that already exists!\n", size);
-        return;
+        nkBool has_next = text_iterator_next(&iter, &next_char);
+        if(!has_next) next_char = 0;
+
+        if(curr_char == '\n')
+        {
+            width = nk_max(width, line_width);
+            line_width = 0.0f;
+        }
+        else
+        {
+            Glyph glyph = get_glyph(font, curr_char);
+            nkF32 advance = glyph.info.advance;
+            nkF32 kerning = get_kerning(font, curr_char, next_char);
+            line_width += advance + kerning;
+        }
+
+        curr_char = next_char;
+        has_curr = has_next;
     }
 
-    FT_Error error = FT_Set_Pixel_Sizes(font->font_face, 0, size);
-    if(error != 0)
-        fatal_error("Failed to set font pixel size to %d! (%d)", size, error);
+    return nk_max(width, line_width);
+}
+
+INTERNAL nkF32 get_truetype_text_height(TrueTypeFont font, TextIterator iter)
+{
+    NK_ASSERT(font);
 
-    // Add the metric information for the size.
-    FT_Size_Metrics ft_metrics = font->font_face->size->metrics;
+    TrueTypeMetrics metrics = get_truetype_font_metrics(font);
 
-    TrueTypeMetrics metrics;
-    metrics.ascent       = FT_CEIL(ft_metrics.ascender);
-    metrics.descent      = FT_CEIL(ft_metrics.descender);
-    metrics.line_space   = FT_CEIL(ft_metrics.height);
-    metrics.line_gap     = FT_CEIL(ft_metrics.height - ft_metrics.ascender + ft_metrics.descender);
-    metrics.max_advance  = FT_CEIL(ft_metrics.max_advance);
-    nk_hashmap_insert(&font->metrics, size, metrics);
+    nkF32 line_height = metrics.ascent - metrics.descent;
+    nkF32 height = 0.0f;
 
-    // Bake the glyph ranges at the size.
-    for(auto& range: font->ranges)
+    nkU32 codepoint = 0;
+    if(text_iterator_next(&iter, &codepoint))
     {
-        for(wchar_t codepoint=range.start; codepoint<=range.end; ++codepoint)
+        height = line_height;
+        do
         {
-            bake_font_glyph(font, size, codepoint);
+            if(codepoint == '\n')
+            {
+                height += line_height;
+            }
         }
+        while(text_iterator_next(&iter, &codepoint));
     }
+
+    return height;
 }
 
-INTERNAL nkF32 get_truetype_line_width(TrueTypeFont font, const wchar_t* text)
+INTERNAL void draw_truetype_text(TrueTypeFont font, nkF32 x, nkF32 y, TextIterator iter, nkVec4 color)
 {
     NK_ASSERT(font);
-    NK_ASSERT(text);
 
-    if(!text) return 0.0f;
+    nkU32 curr_char = 0;
+    nkU32 next_char = 0;
 
-    nkF32 line_width = 0.0f;
-    nkU64 length = wcslen(text);
+    nkBool has_curr = text_iterator_next(&iter, &curr_char);
+    if(!has_curr)
+    {
+        return;
+    }
 
-    for(nkU64 i=0; i<length; ++i)
+    if(font->atlas_dirty)
     {
-        if(text[i] == L'\n')
+        update_font_atlas_texture(font);
+    }
+
+    TrueTypeMetrics metrics = get_truetype_font_metrics(font);
+
+    nkF32 start_x = x;
+    nkF32 start_y = y;
+    nkF32 tx = start_x;
+    nkF32 ty = start_y;
+
+    nkF32 atlas_w = NK_CAST(nkF32, get_texture_width(font->atlas_texture));
+    nkF32 atlas_h = NK_CAST(nkF32, get_texture_height(font->atlas_texture));
+
+    Texture old_texture = imm_get_texture();
+    Shader old_shader = imm_get_shader();
+
+    imm_set_texture(font->atlas_texture);
+    imm_set_shader(g_truetype.font_shader);
+
+    imm_begin(DrawMode_Triangles);
+
+    while(has_curr)
+    {
+        nkBool has_next = text_iterator_next(&iter, &next_char);
+        if(!has_next) next_char = 0;
+
+        if(curr_char == '\n')
         {
-            break;
+            tx = start_x;
+            ty += roundf(metrics.ascent - metrics.descent);
         }
         else
         {
-            Glyph glyph = get_glyph(font, text[i]);
-            nkF32 advance = glyph.info.advance;
-            nkF32 kerning = get_kerning(font, text[i], text[i+1]);
-            line_width += advance + kerning;
+            Glyph glyph = get_glyph(font, curr_char);
+            nkF32 advance = glyph.info.advance + get_kerning(font, curr_char, next_char);
+            draw_truetype_glyph(glyph, roundf(tx), roundf(ty), atlas_w, atlas_h, color);
+            tx += roundf(advance);
         }
+
+        curr_char = next_char;
+        has_curr = has_next;
     }
 
-    return line_width;
+    imm_end();
+
+    imm_set_shader(old_shader);
+    imm_set_texture(old_texture);
 }
 
 GLOBAL void init_truetype_font_system(void)
@@ -196,10 +1122,22 @@ GLOBAL void init_truetype_font_system(void)
     {
         fatal_error("Failed to initialize FreeType!");
     }
+
+    #if defined(USE_HARFBUZZ)
+    g_truetype.hb_buffer = hb_buffer_create();
+    if(!hb_buffer_allocation_successful(g_truetype.hb_buffer))
+    {
+        fatal_error("Failed to create HarfBuzz buffer!");
+    }
+    #endif // USE_HARFBUZZ
 }
 
 GLOBAL void quit_truetype_font_system(void)
 {
+    #if defined(USE_HARFBUZZ)
+    hb_buffer_destroy(g_truetype.hb_buffer);
+    #endif // USE_HARFBUZZ
+
     FT_Done_FreeType(g_truetype.freetype);
 }
 
@@ -231,6 +1169,13 @@ GLOBAL TrueTypeFont create_truetype_font(const TrueTypeFontDesc& desc)
         NK_SET_FLAGS(font->flags, TrueTypeFontFlags_HasKerning);
     }
 
+    #if defined(USE_HARFBUZZ)
+    if(NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Shaping))
+    {
+        font->hb_font = hb_ft_font_create_referenced(font->font_face);
+    }
+    #endif // USE_HARFBUZZ
+
     // @Improve: For now we just use a very simple packing algorithm where we place glyphs linearly from left-to-right
     // and top-to-bottom. We also add a small amount of padding between each glyph. In the future we will want to pack
     // these glyphs more tightly using a better algorithm so that we can fit more glyphs into a single atlas.
@@ -240,17 +1185,30 @@ GLOBAL TrueTypeFont create_truetype_font(const TrueTypeFontDesc& desc)
     font->atlas_cursor = NK_V2_ZERO;
 
     nk_hashmap_init(&font->glyphs);
-    for(nkU64 i=0; i<desc.px_sizes.length; ++i)
+
+    nkBool loaded_from_cache = NK_FALSE;
+    nkU64 cache_key = 0;
+    nkString cache_file_name;
+
+    if(desc.cache_atlas)
     {
-        bake_font_at_size(font, desc.px_sizes[i]);
+        cache_key = get_font_cache_key(desc);
+        cache_file_name = get_font_cache_file_name(cache_key);
+        loaded_from_cache = load_font_cache(font, cache_file_name.cstr, cache_key);
     }
 
-    TextureDesc texture_desc;
-    texture_desc.format = TextureFormat_R;
-    texture_desc.width  = FONT_ATLAS_SIZE;
-    texture_desc.height = FONT_ATLAS_SIZE;
-    texture_desc.data   = font->atlas_pixels;
-    font->atlas_texture = create_texture(texture_desc);
+    if(!loaded_from_cache)
+    {
+        bake_font_at_sizes(font, desc.px_sizes.data, desc.px_sizes.length);
+
+        if(desc.cache_atlas)
+        {
+            precompute_font_kerning(font);
+            save_font_cache(font, cache_file_name.cstr, cache_key);
+        }
+    }
+
+    update_font_atlas_texture(font);
 
     font->current_size = desc.px_sizes[0];
 
@@ -266,11 +1224,19 @@ GLOBAL void free_truetype_font(TrueTypeFont font)
 
     nk_array_free(&font->ranges);
 
+    free_shape_cache(font);
+
+    nk_hashmap_free(&font->kerning);
+    nk_hashmap_free(&font->char_indices);
     nk_hashmap_free(&font->glyphs);
     nk_hashmap_free(&font->metrics);
 
     if(font->owns_data) NK_FREE(font->data_buffer);
 
+    #if defined(USE_HARFBUZZ)
+    if(font->hb_font) hb_font_destroy(font->hb_font);
+    #endif // USE_HARFBUZZ
+
     FT_Done_Face(font->font_face);
 
     NK_FREE(font);
@@ -291,17 +1257,8 @@ GLOBAL void set_truetype_font_size(TrueTypeFont font, nkS32 new_size)
         printf("[Font]: Attempting to set font to unbaked size (%d), baking now...\n", new_size);
         bake_font_at_size(font, font->current_size);
 
-        // @Improve: Add a way of updating a texture's pixels without fully recrating it...
-
         // We need to update the texture with the new font data.
-        free_texture(font->atlas_texture);
-
-        TextureDesc texture_desc;
-        texture_desc.format = TextureFormat_R;
-        texture_desc.width  = FONT_ATLAS_SIZE;
-        texture_desc.height = FONT_ATLAS_SIZE;
-        texture_desc.data   = font->atlas_pixels;
-        font->atlas_texture = create_texture(texture_desc);
+        update_font_atlas_texture(font);
     }
 }
 
@@ -317,138 +1274,93 @@ GLOBAL TrueTypeMetrics get_truetype_font_metrics(TrueTypeFont font)
     return nk_hashmap_getref(&font->metrics, font->current_size);
 }
 
-GLOBAL nkBool has_glyph(TrueTypeFont font, wchar_t codepoint)
+GLOBAL nkBool has_glyph(TrueTypeFont font, nkU32 codepoint)
 {
     NK_ASSERT(font);
 
-    GlyphID glyph_id = { font->current_size, codepoint };
+    nkU32* index = nk_hashmap_getptr(&font->char_indices, codepoint);
+    if(!index) return NK_FALSE;
+
+    GlyphID glyph_id = NK_ZERO_MEM;
+    glyph_id.px_size = font->current_size;
+    glyph_id.index = *index;
     return nk_hashmap_contains(&font->glyphs, glyph_id);
 }
 
-GLOBAL Glyph get_glyph(TrueTypeFont font, wchar_t codepoint)
+GLOBAL Glyph get_glyph(TrueTypeFont font, nkU32 codepoint)
 {
     NK_ASSERT(font);
 
-    GlyphID glyph_id = NK_ZERO_MEM; // NOTE: The zeroing of the memory is important here or else bytes used in hashing could be random!!!
-                                    //       We should probably just implement a custom hashing function for the GlyphID function instead...
-    glyph_id.px_size = font->current_size;
-    glyph_id.codepoint = codepoint;
-
-    if(nk_hashmap_contains(&font->glyphs, glyph_id))
-    {
-        return nk_hashmap_getref(&font->glyphs, glyph_id);
-    }
-    else
+    // Codepoints outside of the baked ranges won't have an index cached so we treat them as missing.
+    nkU32* index = nk_hashmap_getptr(&font->char_indices, codepoint);
+    if(!index)
     {
-        // If we don't have a glyph that has been requested then just return an empty glyph...
-        // Maybe we want to do something else here? Return a tofu glyph or something instead?
         Glyph glyph = NK_ZERO_MEM;
         return glyph;
     }
+
+    return get_glyph_by_index(font, *index);
 }
 
-GLOBAL nkF32 get_kerning(TrueTypeFont font, wchar_t left, wchar_t right)
+GLOBAL nkF32 get_kerning(TrueTypeFont font, nkU32 left, nkU32 right)
 {
     NK_ASSERT(font);
 
-    if(!NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_HasKerning))
+    // A codepoint of zero is passed when there is no next character, so there's nothing to kern against.
+    if(!NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_HasKerning) || left == 0 || right == 0)
     {
         return 0.0f;
     }
     else
     {
-        FT_UInt l = FT_Get_Char_Index(font->font_face, left);
-        FT_UInt r = FT_Get_Char_Index(font->font_face, right);
+        KerningID kerning_id = NK_ZERO_MEM;
+        kerning_id.px_size = font->current_size;
+        kerning_id.left = find_char_index(font, left);
+        kerning_id.right = find_char_index(font, right);
+
+        nkF32* cached = nk_hashmap_getptr(&font->kerning, kerning_id);
+        if(cached) return *cached;
+
+        // Kerning is scaled by the face's current size, which is whatever size was last baked, so set it first.
+        set_font_face_size(font, font->current_size);
+
         FT_Vector vector;
-        FT_Get_Kerning(font->font_face, l, r, FT_KERNING_DEFAULT, &vector); // @Improve: Handle error???
-        return FT_CEIL(vector.x);
+        FT_Get_Kerning(font->font_face, kerning_id.left, kerning_id.right, FT_KERNING_DEFAULT, &vector); // @Improve: Handle error???
+        nkF32 kerning = FT_CEIL(vector.x);
+
+        nk_hashmap_insert(&font->kerning, kerning_id, kerning);
+        return kerning;
     }
 }
 
 GLOBAL nkF32 get_truetype_text_width(TrueTypeFont font, const wchar_t* text, nkU64 length)
 {
     NK_ASSERT(font);
-
     if(!text) return 0.0f;
-
-    nkF32 line_width = 0.0f;
-    nkF32 width = 0.0f;
-
-    if(length == NK_U64_MAX)
-    {
-        length = wcslen(text);
-    }
-
-    for(nkU64 i=0; i<length; ++i)
-    {
-        if(text[i] == L'\n')
-        {
-            width = nk_max(width, line_width);
-            line_width = 0.0f;
-        }
-        else
-        {
-            Glyph glyph = get_glyph(font, text[i]);
-            nkF32 advance = glyph.info.advance;
-            nkF32 kerning = get_kerning(font, text[i], text[i+1]);
-            line_width += advance + kerning;
-        }
-    }
-
-    return nk_max(width, line_width);
+    return get_truetype_text_width(font, text_iterator_begin(text, length));
 }
 
 GLOBAL nkF32 get_truetype_text_height(TrueTypeFont font, const wchar_t* text, nkU64 length)
 {
     NK_ASSERT(font);
-
     if(!text) return 0.0f;
-
-    TrueTypeMetrics metrics = get_truetype_font_metrics(font);
-
-    nkF32 line_height = metrics.ascent - metrics.descent;
-    nkF32 height = 0.0f;
-
-    if(length == NK_U64_MAX)
-    {
-        length = wcslen(text);
-    }
-
-    if(text && (length > 0))
-    {
-        height = line_height;
-        for(nkU64 i=0; i<length; ++i)
-        {
-            if(text[i] == L'\n')
-            {
-                height += line_height;
-            }
-        }
-    }
-
-    return height;
+    return get_truetype_text_height(font, text_iterator_begin(text, length));
 }
 
 GLOBAL nkF32 get_truetype_text_width(TrueTypeFont font, const nkChar* text, nkU64 length)
 {
     NK_ASSERT(font);
-
     if(!text) return 0.0f;
-
-    wchar_t* wtext = convert_string_to_wide(text);
-    NK_DEFER(NK_FREE(wtext));
-    return get_truetype_text_width(font, wtext, length);
+    if(NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Shaping))
+        return shape_truetype_text(font, text, length)->width;
+    return get_truetype_text_width(font, text_iterator_begin(text, length));
 }
 
 GLOBAL nkF32 get_truetype_text_height(TrueTypeFont font, const nkChar* text, nkU64 length)
 {
     NK_ASSERT(font);
-
     if(!text) return 0.0f;
-
-    wchar_t* wtext = convert_string_to_wide(text);
-    NK_DEFER(NK_FREE(wtext));
-    return get_truetype_text_height(font, wtext, length);
+    return get_truetype_text_height(font, text_iterator_begin(text, length));
 }
 
 GLOBAL nkF32 get_truetype_line_height(TrueTypeFont font)
@@ -461,67 +1373,8 @@ GLOBAL nkF32 get_truetype_line_height(TrueTypeFont font)
 GLOBAL void draw_truetype_text(TrueTypeFont font, nkF32 x, nkF32 y, const wchar_t* text, nkVec4 color)
 {
     NK_ASSERT(font);
-
     if(!text) return;
-
-    if(wcslen(text) == 0)
-    {
-        return;
-    }
-
-    TrueTypeMetrics metrics = get_truetype_font_metrics(font);
-
-    nkF32 start_x = x;
-    nkF32 start_y = y;
-    nkF32 tx = start_x;
-    nkF32 ty = start_y;
-
-    Texture old_texture = imm_get_texture();
-    Shader old_shader = imm_get_shader();
-
-    imm_set_texture(font->atlas_texture);
-    imm_set_shader(g_truetype.font_shader);
-
-    imm_begin(DrawMode_Triangles);
-
-    for(nkU64 i=0,n=wcslen(text); i<n; ++i)
-    {
-        wchar_t current_char = text[i];
-        if(current_char == L'\n')
-        {
-            tx = start_x;
-            ty += roundf(metrics.ascent - metrics.descent);
-        }
-        else
-        {
-            Glyph glyph = get_glyph(font, current_char);
-            nkF32 advance = glyph.info.advance + get_kerning(font, current_char, text[i+1]);
-
-            nkF32 x1 = roundf(tx) + glyph.info.offset_x;
-            nkF32 y1 = roundf(ty) + glyph.info.offset_y;
-            nkF32 x2 = x1         + glyph.info.width;
-            nkF32 y2 = y1         + glyph.info.height;
-
-            nkF32 s1 =      (glyph.bounds.x / get_texture_width(font->atlas_texture));
-            nkF32 t1 =      (glyph.bounds.y / get_texture_height(font->atlas_texture));
-            nkF32 s2 = s1 + (glyph.bounds.w / get_texture_width(font->atlas_texture));
-            nkF32 t2 = t1 + (glyph.bounds.h / get_texture_height(font->atlas_texture));
-
-            imm_position(x1,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t2);
-            imm_position(x1,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t1);
-            imm_position(x2,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t2);
-            imm_position(x2,y2); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t2);
-            imm_position(x1,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s1,t1);
-            imm_position(x2,y1); imm_color(color.r,color.g,color.b,color.a); imm_texcoord(s2,t1);
-
-            tx += roundf(advance);
-        }
-    }
-
-    imm_end();
-
-    imm_set_shader(old_shader);
-    imm_set_texture(old_texture);
+    draw_truetype_text(font, x,y, text_iterator_begin(text), color);
 }
 
 GLOBAL void draw_truetype_char(TrueTypeFont font, nkF32 x, nkF32 y, wchar_t chr, nkVec4 color)
@@ -533,12 +1386,13 @@ GLOBAL void draw_truetype_char(TrueTypeFont font, nkF32 x, nkF32 y, wchar_t chr,
 GLOBAL void draw_truetype_text(TrueTypeFont font, nkF32 x, nkF32 y, const nkChar* text, nkVec4 color)
 {
     NK_ASSERT(font);
-
     if(!text) return;
-
-    wchar_t* wtext = convert_string_to_wide(text);
-    NK_DEFER(NK_FREE(wtext));
-    draw_truetype_text(font, x,y, wtext, color);
+    if(NK_CHECK_FLAGS(font->flags, TrueTypeFontFlags_Shaping))
+    {
+        draw_truetype_shaped_run(font, x,y, shape_truetype_text(font, text, NK_U64_MAX), color);
+        return;
+    }
+    draw_truetype_text(font, x,y, text_iterator_begin(text), color);
 }
 
 GLOBAL void draw_truetype_char(TrueTypeFont font, nkF32 x, nkF32 y, nkChar chr, nkVec4 color)
@@ -7,6 +7,7 @@ NK_ENUM(TrueTypeFontFlags, nkU32)
     TrueTypeFontFlags_None       = (   0),
     TrueTypeFontFlags_Monochrome = (1<<0), // Rasterize the font with monochrome output (no anti-aliasing).
     TrueTypeFontFlags_HasKerning = (1<<1), // Whether the font has kerning data or not (automatically assigned on font creation).
+    TrueTypeFontFlags_Shaping    = (1<<2), // Shape UTF-8 text before drawing and cache the shaped runs (uses HarfBuzz when built with USE_HARFBUZZ).
 };
 
 struct GlyphInfo
@@ -31,8 +32,8 @@ struct Glyph
 
 struct CharRange
 {
-    wchar_t start;
-    wchar_t end;
+    nkU32 start; // Unicode codepoints (inclusive).
+    nkU32 end;
 };
 
 struct TrueTypeMetrics
@@ -46,12 +47,13 @@ struct TrueTypeMetrics
 
 struct TrueTypeFontDesc
 {
-    TrueTypeFontFlags  flags     = TrueTypeFontFlags_None;
-    void*              data      = NULL;
-    nkU64              size      = 0;
-    nkBool             owns_data = NK_FALSE;
-    nkArray<nkS32>     px_sizes  = { 12 };
-    nkArray<CharRange> ranges    = { { L'\u0020', L'\u007E' } };
+    TrueTypeFontFlags  flags       = TrueTypeFontFlags_None;
+    void*              data        = NULL;
+    nkU64              size        = 0;
+    nkBool             owns_data   = NK_FALSE;
+    nkArray<nkS32>     px_sizes    = { 12 };
+    nkArray<CharRange> ranges      = { { 0x0020, 0x007E } };
+    nkBool             cache_atlas = NK_FALSE; // Save the baked atlas to disk and load it from there on later runs instead of rasterizing.
 };
 
 GLOBAL void            init_truetype_font_system(void);
@@ -61,17 +63,17 @@ GLOBAL void            free_truetype_font       (TrueTypeFont font);
 GLOBAL void            set_truetype_font_size   (TrueTypeFont font, nkS32 new_size);
 GLOBAL nkS32           get_truetype_font_size   (TrueTypeFont font);
 GLOBAL TrueTypeMetrics get_truetype_font_metrics(TrueTypeFont font);
-GLOBAL nkBool          has_glyph                (TrueTypeFont font, wchar_t codepoint);
-GLOBAL Glyph           get_glyph                (TrueTypeFont font, wchar_t codepoint);
-GLOBAL nkF32           get_kerning              (TrueTypeFont font, wchar_t left, wchar_t right);
+GLOBAL nkBool          has_glyph                (TrueTypeFont font, nkU32 codepoint);
+GLOBAL Glyph           get_glyph                (TrueTypeFont font, nkU32 codepoint);
+GLOBAL nkF32           get_kerning              (TrueTypeFont font, nkU32 left, nkU32 right);
 GLOBAL nkF32           get_truetype_text_width  (TrueTypeFont font, const wchar_t* text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string.
 GLOBAL nkF32           get_truetype_text_height (TrueTypeFont font, const wchar_t* text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string.
-GLOBAL nkF32           get_truetype_text_width  (TrueTypeFont font, const nkChar*  text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string.
-GLOBAL nkF32           get_truetype_text_height (TrueTypeFont font, const nkChar*  text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string.
+GLOBAL nkF32           get_truetype_text_width  (TrueTypeFont font, const nkChar*  text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string (UTF-8, length in bytes).
+GLOBAL nkF32           get_truetype_text_height (TrueTypeFont font, const nkChar*  text, nkU64 length = NK_U64_MAX); // Default length value means scan the whole string (UTF-8, length in bytes).
 GLOBAL nkF32           get_truetype_line_height (TrueTypeFont font);
 GLOBAL void            draw_truetype_text       (TrueTypeFont font, nkF32 x, nkF32 y, const wchar_t* text, nkVec4 color = NK_V4_WHITE);
 GLOBAL void            draw_truetype_char       (TrueTypeFont font, nkF32 x, nkF32 y, wchar_t chr,         nkVec4 color = NK_V4_WHITE);
-GLOBAL void            draw_truetype_text       (TrueTypeFont font, nkF32 x, nkF32 y, const nkChar*  text, nkVec4 color = NK_V4_WHITE);
+GLOBAL void            draw_truetype_text       (TrueTypeFont font, nkF32 x, nkF32 y, const nkChar*  text, nkVec4 color = NK_V4_WHITE); // UTF-8 text.
 GLOBAL void            draw_truetype_char       (TrueTypeFont font, nkF32 x, nkF32 y, nkChar  chr,         nkVec4 color = NK_V4_WHITE);
 
 /*////////////////////////////////////////////////////////////////////////////*/
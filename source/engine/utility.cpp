@@ -6,9 +6,9 @@
 
 GLOBAL wchar_t* convert_string_to_wide(const nkChar* str)
 {
+    // A multi-byte character never turns into more than one wide character so the length is always enough.
     nkU64 length = strlen(str);
-    wchar_t* wstr = NK_MALLOC_TYPES(wchar_t, ((length+1)*4));
-    if(!wstr) return NULL;
+    wchar_t* wstr = frame_alloc_types<wchar_t>(length+1);
     mbstowcs(wstr, str, length);
     wstr[length] = L'\0';
     return wstr;
@@ -42,6 +42,140 @@ GLOBAL nkString format_string_v(const nkChar* fmt, va_list args0)
     return str;
 }
 
+//
+// Text decoding helpers.
+//
+
+INTERNAL constexpr nkU32 REPLACEMENT_CODEPOINT = 0xFFFD;
+
+INTERNAL nkBool is_valid_codepoint(nkU32 codepoint)
+{
+    return ((codepoint <= 0x10FFFF) && !(codepoint >= 0xD800 && codepoint <= 0xDFFF));
+}
+
+INTERNAL nkU32 decode_utf8_codepoint(TextIterator* iter)
+{
+    const nkU8* s = NK_CAST(const nkU8*, iter->utf8);
+
+    // The lead byte tells us how many continuation bytes follow and the smallest codepoint the
+    // sequence is allowed to encode, anything below that is an overlong encoding and is rejected.
+    nkU32 codepoint = s[0];
+    nkU32 extra = 0;
+    nkU32 min = 0;
+    nkBool valid = NK_TRUE;
+
+    if     ((codepoint & 0x80) == 0x00) { extra = 0;                                  }
+    else if((codepoint & 0xE0) == 0xC0) { extra = 1; codepoint &= 0x1F; min = 0x00080; }
+    else if((codepoint & 0xF0) == 0xE0) { extra = 2; codepoint &= 0x0F; min = 0x00800; }
+    else if((codepoint & 0xF8) == 0xF0) { extra = 3; codepoint &= 0x07; min = 0x10000; }
+    else                                { extra = 0; valid = NK_FALSE;                  }
+
+    // A truncated sequence (including one cut short by the null-terminator) only consumes the bytes
+    // that were actually part of it, so the next call resumes at the byte that broke the sequence.
+    nkU64 consumed = 1;
+    for(; consumed<=extra; ++consumed)
+    {
+        if(consumed >= iter->length || (s[consumed] & 0xC0) != 0x80)
+        {
+            valid = NK_FALSE;
+            break;
+        }
+        codepoint = (codepoint << 6) | (s[consumed] & 0x3F);
+    }
+
+    iter->utf8 += consumed;
+    if(iter->length != NK_U64_MAX)
+        iter->length -= consumed;
+
+    if(!valid || codepoint < min || !is_valid_codepoint(codepoint))
+        return REPLACEMENT_CODEPOINT;
+    return codepoint;
+}
+
+INTERNAL nkU32 decode_wide_codepoint(TextIterator* iter)
+{
+    nkU32 codepoint = NK_CAST(nkU32, iter->wide[0]);
+    nkU64 consumed = 1;
+
+    // On platforms where wchar_t is 16-bit (Windows) codepoints above the BMP are stored as surrogate pairs.
+    #if (WCHAR_MAX <= 0xFFFF)
+    codepoint &= 0xFFFF;
+    if(codepoint >= 0xD800 && codepoint <= 0xDBFF && iter->length > 1)
+    {
+        nkU32 low = NK_CAST(nkU32, iter->wide[1]) & 0xFFFF;
+        if(low >= 0xDC00 && low <= 0xDFFF)
+        {
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            consumed = 2;
+        }
+    }
+    #endif // WCHAR_MAX
+
+    iter->wide += consumed;
+    if(iter->length != NK_U64_MAX)
+        iter->length -= consumed;
+
+    if(!is_valid_codepoint(codepoint))
+        return REPLACEMENT_CODEPOINT;
+    return codepoint;
+}
+
+GLOBAL TextIterator text_iterator_begin(const nkChar* text, nkU64 length)
+{
+    TextIterator iter;
+    iter.utf8   = text;
+    iter.length = length;
+    return iter;
+}
+
+GLOBAL TextIterator text_iterator_begin(const wchar_t* text, nkU64 length)
+{
+    TextIterator iter;
+    iter.wide   = text;
+    iter.length = length;
+    return iter;
+}
+
+GLOBAL nkBool text_iterator_next(TextIterator* iter, nkU32* codepoint)
+{
+    NK_ASSERT(iter);
+    NK_ASSERT(codepoint);
+
+    if(iter->length == 0) return NK_FALSE;
+
+    if(iter->utf8)
+    {
+        if(*iter->utf8 == '\0') return NK_FALSE;
+        *codepoint = decode_utf8_codepoint(iter);
+        return NK_TRUE;
+    }
+    if(iter->wide)
+    {
+        if(*iter->wide == L'\0') return NK_FALSE;
+        *codepoint = decode_wide_codepoint(iter);
+        return NK_TRUE;
+    }
+
+    return NK_FALSE;
+}
+
+//
+// Hashing helpers.
+//
+
+INTERNAL constexpr nkU64 FNV1A_PRIME = 0x100000001B3ull;
+
+GLOBAL nkU64 hash_fnv1a(const void* data, nkU64 size, nkU64 hash)
+{
+    const nkU8* bytes = NK_CAST(const nkU8*, data);
+    for(nkU64 i=0; i<size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
 //
 // File name/path helpers.
 //
@@ -77,86 +211,304 @@ GLOBAL nkString potentially_append_slash(const nkChar* file_path)
 // Random number generation.
 //
 
+// PCG32 (XSH RR) from https://www.pcg-random.org, a 64-bit LCG with a permuted 32-bit output. Everything is integer
+// maths until the final conversion to float, which is exact, so the same seed gives the same numbers everywhere.
+
+INTERNAL constexpr nkU64 PCG32_MULTIPLIER = 6364136223846793005ull;
+
+INTERNAL RngState g_rng = { 0xB0A3E85A992AFE5Bull, 0x1ull }; // Same as rng_seed(1), like rand() before srand is called.
+
+INTERNAL NKFORCEINLINE nkU32 pcg32_output(nkU64 state)
+{
+    nkU32 xorshifted = NK_CAST(nkU32, ((state >> 18u) ^ state) >> 27u);
+    nkU32 rot = NK_CAST(nkU32, state >> 59u);
+    return ((xorshifted >> rot) | (xorshifted << ((0u - rot) & 31u)));
+}
+
+// Works out the multiplier and increment that step the LCG forward by steps at once.
+INTERNAL void pcg32_get_jump(nkU64 inc, nkU64 steps, nkU64* out_mult, nkU64* out_plus)
+{
+    nkU64 acc_mult = 1;
+    nkU64 acc_plus = 0;
+    nkU64 cur_mult = PCG32_MULTIPLIER;
+    nkU64 cur_plus = inc;
+
+    while(steps > 0)
+    {
+        if(steps & 1)
+        {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        steps >>= 1;
+    }
+
+    *out_mult = acc_mult;
+    *out_plus = acc_plus;
+}
+
+// A float in [0,1) made from the top 24 bits, so every value is exactly representable.
+INTERNAL NKFORCEINLINE nkF32 rng_u32_to_f32(nkU32 x)
+{
+    return (NK_CAST(nkF32, x >> 8) * (1.0f / 16777216.0f));
+}
+
+GLOBAL RngState rng_create(nkU64 seed, nkU64 stream)
+{
+    RngState rng;
+    rng.state = 0;
+    rng.inc = (stream << 1u) | 1u;
+    rng_u32(&rng);
+    rng.state += seed;
+    rng_u32(&rng);
+    return rng;
+}
+
+GLOBAL RngState rng_split(RngState* rng)
+{
+    NK_ASSERT(rng);
+    // Drawn one at a time so the order is fixed, evaluation order within an expression isn't.
+    nkU32 seed_hi   = rng_u32(rng);
+    nkU32 seed_lo   = rng_u32(rng);
+    nkU32 stream_hi = rng_u32(rng);
+    nkU32 stream_lo = rng_u32(rng);
+    nkU64 seed   = (NK_CAST(nkU64, seed_hi)   << 32) | seed_lo;
+    nkU64 stream = (NK_CAST(nkU64, stream_hi) << 32) | stream_lo;
+    return rng_create(seed, stream);
+}
+
+GLOBAL void rng_jump(RngState* rng, nkU64 steps)
+{
+    NK_ASSERT(rng);
+    nkU64 mult, plus;
+    pcg32_get_jump(rng->inc, steps, &mult, &plus);
+    rng->state = rng->state * mult + plus;
+}
+
 GLOBAL void rng_seed(nkU32 seed)
 {
-    srand(seed);
+    g_rng = rng_create(seed);
+}
+
+GLOBAL nkU32 rng_u32(void)
+{
+    return rng_u32(&g_rng);
 }
 
 GLOBAL nkS32 rng_s32(void)
 {
-    return rand();
+    return rng_s32(&g_rng);
 }
 
 GLOBAL nkF32 rng_f32(void)
 {
-    return (NK_CAST(nkF32,rng_s32()) / NK_CAST(nkF32,RAND_MAX));
+    return rng_f32(&g_rng);
 }
 
 GLOBAL nkVec2 rng_v2(void)
+{
+    return rng_v2(&g_rng);
+}
+
+GLOBAL nkVec3 rng_v3(void)
+{
+    return rng_v3(&g_rng);
+}
+
+GLOBAL nkVec4 rng_v4(void)
+{
+    return rng_v4(&g_rng);
+}
+
+GLOBAL nkS32 rng_s32(nkS32 min, nkS32 max)
+{
+    return rng_s32(&g_rng, min, max);
+}
+
+GLOBAL nkF32 rng_f32(nkF32 min, nkF32 max)
+{
+    return rng_f32(&g_rng, min, max);
+}
+
+GLOBAL nkVec2 rng_v2(nkVec2 min, nkVec2 max)
+{
+    return rng_v2(&g_rng, min, max);
+}
+
+GLOBAL nkVec3 rng_v3(nkVec3 min, nkVec3 max)
+{
+    return rng_v3(&g_rng, min, max);
+}
+
+GLOBAL nkVec4 rng_v4(nkVec4 min, nkVec4 max)
+{
+    return rng_v4(&g_rng, min, max);
+}
+
+GLOBAL nkU32 rng_u32(RngState* rng)
+{
+    NK_ASSERT(rng);
+    nkU64 old = rng->state;
+    rng->state = old * PCG32_MULTIPLIER + rng->inc;
+    return pcg32_output(old);
+}
+
+GLOBAL nkS32 rng_s32(RngState* rng)
+{
+    return NK_CAST(nkS32, rng_u32(rng) >> 1);
+}
+
+GLOBAL nkF32 rng_f32(RngState* rng)
+{
+    return rng_u32_to_f32(rng_u32(rng));
+}
+
+GLOBAL nkVec2 rng_v2(RngState* rng)
 {
     nkVec2 v;
-    v.x = rng_f32();
-    v.y = rng_f32();
+    v.x = rng_f32(rng);
+    v.y = rng_f32(rng);
     return v;
 }
 
-GLOBAL nkVec3 rng_v3(void)
+GLOBAL nkVec3 rng_v3(RngState* rng)
 {
     nkVec3 v;
-    v.x = rng_f32();
-    v.y = rng_f32();
-    v.z = rng_f32();
+    v.x = rng_f32(rng);
+    v.y = rng_f32(rng);
+    v.z = rng_f32(rng);
     return v;
 }
 
-GLOBAL nkVec4 rng_v4(void)
+GLOBAL nkVec4 rng_v4(RngState* rng)
 {
     nkVec4 v;
-    v.x = rng_f32();
-    v.y = rng_f32();
-    v.z = rng_f32();
-    v.w = rng_f32();
+    v.x = rng_f32(rng);
+    v.y = rng_f32(rng);
+    v.z = rng_f32(rng);
+    v.w = rng_f32(rng);
     return v;
 }
 
-GLOBAL nkS32 rng_s32(nkS32 min, nkS32 max)
+GLOBAL nkS32 rng_s32(RngState* rng, nkS32 min, nkS32 max)
 {
     if(min > max) NK_SWAP(nkS32,min,max);
-    return ((rng_s32() % ((max+1)-min)) + min);
+
+    // Lemire's multiply and shift, numbers from the small slice at the bottom that would bias the result are thrown
+    // away and redrawn. A range of 0 means the full 32-bit range, where every number can be used as is.
+    nkU32 range = NK_CAST(nkU32, NK_CAST(nkS64,max) - NK_CAST(nkS64,min) + 1);
+    if(range == 0)
+        return NK_CAST(nkS32, rng_u32(rng));
+
+    nkU64 m = NK_CAST(nkU64, rng_u32(rng)) * range;
+    if(NK_CAST(nkU32, m) < range)
+    {
+        nkU32 threshold = (0u - range) % range;
+        while(NK_CAST(nkU32, m) < threshold)
+            m = NK_CAST(nkU64, rng_u32(rng)) * range;
+    }
+    return NK_CAST(nkS32, NK_CAST(nkS64,min) + NK_CAST(nkS64, m >> 32));
 }
 
-GLOBAL nkF32 rng_f32(nkF32 min, nkF32 max)
+GLOBAL nkF32 rng_f32(RngState* rng, nkF32 min, nkF32 max)
 {
-    return (min + NK_CAST(nkF32,rng_s32()) / (NK_CAST(nkF32,RAND_MAX) / (max-min)));
+    return (min + (max-min) * rng_f32(rng));
 }
 
-GLOBAL nkVec2 rng_v2(nkVec2 min, nkVec2 max)
+GLOBAL nkVec2 rng_v2(RngState* rng, nkVec2 min, nkVec2 max)
 {
     nkVec2 v;
-    v.x = rng_f32(min.x,max.x);
-    v.y = rng_f32(min.y,max.y);
+    v.x = rng_f32(rng, min.x,max.x);
+    v.y = rng_f32(rng, min.y,max.y);
     return v;
 }
 
-GLOBAL nkVec3 rng_v3(nkVec3 min, nkVec3 max)
+GLOBAL nkVec3 rng_v3(RngState* rng, nkVec3 min, nkVec3 max)
 {
     nkVec3 v;
-    v.x = rng_f32(min.x,max.x);
-    v.y = rng_f32(min.y,max.y);
-    v.z = rng_f32(min.z,max.z);
+    v.x = rng_f32(rng, min.x,max.x);
+    v.y = rng_f32(rng, min.y,max.y);
+    v.z = rng_f32(rng, min.z,max.z);
     return v;
 }
 
-GLOBAL nkVec4 rng_v4(nkVec4 min, nkVec4 max)
+GLOBAL nkVec4 rng_v4(RngState* rng, nkVec4 min, nkVec4 max)
 {
     nkVec4 v;
-    v.x = rng_f32(min.x,max.x);
-    v.y = rng_f32(min.y,max.y);
-    v.z = rng_f32(min.z,max.z);
-    v.w = rng_f32(min.w,max.w);
+    v.x = rng_f32(rng, min.x,max.x);
+    v.y = rng_f32(rng, min.y,max.y);
+    v.z = rng_f32(rng, min.z,max.z);
+    v.w = rng_f32(rng, min.w,max.w);
     return v;
 }
 
+GLOBAL void rng_fill_u32(RngState* rng, nkU32* out, nkU64 count)
+{
+    NK_ASSERT(rng);
+    NK_ASSERT(out || count == 0);
+
+    // Generating one at a time means every number waits on the 64-bit multiply before it. Instead run four copies of
+    // the generator each a step apart and step them all by four at a time, the chains don't depend on each other so
+    // they overlap in the pipeline and the output is the same sequence in the same order. (A SIMD version would need
+    // 64-bit multiplies which SSE2 and Wasm SIMD don't have, so this gets most of the win while staying portable).
+    nkU64 i = 0;
+    if(count >= 4)
+    {
+        nkU64 mult1, plus1, mult4, plus4;
+        pcg32_get_jump(rng->inc, 1, &mult1, &plus1);
+        pcg32_get_jump(rng->inc, 4, &mult4, &plus4);
+
+        nkU64 s0 = rng->state;
+        nkU64 s1 = s0 * mult1 + plus1;
+        nkU64 s2 = s1 * mult1 + plus1;
+        nkU64 s3 = s2 * mult1 + plus1;
+
+        for(; i+4<=count; i+=4)
+        {
+            out[i+0] = pcg32_output(s0);
+            out[i+1] = pcg32_output(s1);
+            out[i+2] = pcg32_output(s2);
+            out[i+3] = pcg32_output(s3);
+
+            s0 = s0 * mult4 + plus4;
+            s1 = s1 * mult4 + plus4;
+            s2 = s2 * mult4 + plus4;
+            s3 = s3 * mult4 + plus4;
+        }
+
+        rng->state = s0;
+    }
+    for(; i<count; ++i)
+    {
+        out[i] = rng_u32(rng);
+    }
+}
+
+GLOBAL void rng_fill_f32(RngState* rng, nkF32* out, nkU64 count)
+{
+    // Generate in chunks then convert, the conversion is a simple loop the compiler will vectorize.
+    nkU32 bits[256];
+    for(nkU64 i=0; i<count; i+=NK_ARRAY_SIZE(bits))
+    {
+        nkU64 n = nk_min(count-i, NK_CAST(nkU64, NK_ARRAY_SIZE(bits)));
+        rng_fill_u32(rng, bits, n);
+        for(nkU64 j=0; j<n; ++j)
+            out[i+j] = rng_u32_to_f32(bits[j]);
+    }
+}
+
+GLOBAL void rng_fill_f32(RngState* rng, nkF32* out, nkU64 count, nkF32 min, nkF32 max)
+{
+    rng_fill_f32(rng, out, count);
+    nkF32 range = max - min;
+    for(nkU64 i=0; i<count; ++i)
+    {
+        out[i] = min + range * out[i];
+    }
+}
+
 //
 // String parsing helpers.
 //
@@ -18,26 +18,71 @@ struct iRect   { nkS32 x,y,w,h;     };
 struct fRect   { nkF32 x,y,w,h;     };
 
 // String helpers.
-GLOBAL wchar_t* convert_string_to_wide(const nkChar* str);
+GLOBAL wchar_t* convert_string_to_wide(const nkChar* str); // The result lives in the frame arena, don't free it.
 GLOBAL nkString format_string         (const nkChar* fmt, ...);
 GLOBAL nkString format_string_v       (const nkChar* fmt, va_list args);
 
+// Text decoding helpers. These walk a string one codepoint at a time without allocating anything. Narrow strings are
+// decoded as UTF-8 and wide strings as UTF-16 or UTF-32 depending on the size of wchar_t on the current platform.
+// Malformed sequences are decoded as U+FFFD so callers never have to deal with invalid codepoints.
+struct TextIterator
+{
+    const nkChar*  utf8   = NULL;
+    const wchar_t* wide   = NULL;
+    nkU64          length = NK_U64_MAX; // Remaining code units, NK_U64_MAX means scan until the null-terminator.
+};
+
+GLOBAL TextIterator text_iterator_begin(const nkChar*  text, nkU64 length = NK_U64_MAX);
+GLOBAL TextIterator text_iterator_begin(const wchar_t* text, nkU64 length = NK_U64_MAX);
+GLOBAL nkBool       text_iterator_next (TextIterator* iter, nkU32* codepoint); // Returns false once the end of the text is reached.
+
+// Hashing helpers.
+INTERNAL constexpr nkU64 FNV1A_OFFSET_BASIS = 0xCBF29CE484222325ull;
+
+GLOBAL nkU64 hash_fnv1a(const void* data, nkU64 size, nkU64 hash = FNV1A_OFFSET_BASIS); // Pass a previous result as the hash to continue hashing.
+
 // File name/path helpers.
 GLOBAL void     potentially_append_slash(nkChar* file_path, nkU64 size);
 GLOBAL nkString potentially_append_slash(const nkChar* file_path);
 
-// Random number generation.
-GLOBAL void   rng_seed(nkU32 seed);
-GLOBAL nkS32  rng_s32 (void);
-GLOBAL nkF32  rng_f32 (void);
-GLOBAL nkVec2 rng_v2  (void);
-GLOBAL nkVec3 rng_v3  (void);
-GLOBAL nkVec4 rng_v4  (void);
-GLOBAL nkS32  rng_s32 (nkS32  min, nkS32  max);
-GLOBAL nkF32  rng_f32 (nkF32  min, nkF32  max);
-GLOBAL nkVec2 rng_v2  (nkVec2 min, nkVec2 max);
-GLOBAL nkVec3 rng_v3  (nkVec3 min, nkVec3 max);
-GLOBAL nkVec4 rng_v4  (nkVec4 min, nkVec4 max);
+// Random number generation. Generators are PCG32, so sequences are the same on every platform given the same seed.
+// The functions without an RngState use one global generator seeded by rng_seed, that isn't safe to use from the job
+// threads so give each job its own state instead, either from rng_split or by seeding with a different stream.
+struct RngState
+{
+    nkU64 state;
+    nkU64 inc; // Picks the stream, always odd.
+};
+
+GLOBAL RngState rng_create  (nkU64 seed, nkU64 stream = 0); // States with the same seed and different streams give unrelated sequences.
+GLOBAL RngState rng_split   (RngState* rng); // Makes a new state on its own stream, seeded from the given one.
+GLOBAL void     rng_jump    (RngState* rng, nkU64 steps); // Skips ahead as if steps numbers had been generated, in O(log steps).
+GLOBAL void     rng_seed    (nkU32 seed);
+GLOBAL nkU32    rng_u32     (void);
+GLOBAL nkS32    rng_s32     (void); // From 0 to NK_S32_MAX.
+GLOBAL nkF32    rng_f32     (void); // From 0 up to but not including 1.
+GLOBAL nkVec2   rng_v2      (void);
+GLOBAL nkVec3   rng_v3      (void);
+GLOBAL nkVec4   rng_v4      (void);
+GLOBAL nkS32    rng_s32     (nkS32  min, nkS32  max); // Inclusive of max and without modulo bias.
+GLOBAL nkF32    rng_f32     (nkF32  min, nkF32  max);
+GLOBAL nkVec2   rng_v2      (nkVec2 min, nkVec2 max);
+GLOBAL nkVec3   rng_v3      (nkVec3 min, nkVec3 max);
+GLOBAL nkVec4   rng_v4      (nkVec4 min, nkVec4 max);
+GLOBAL nkU32    rng_u32     (RngState* rng);
+GLOBAL nkS32    rng_s32     (RngState* rng);
+GLOBAL nkF32    rng_f32     (RngState* rng);
+GLOBAL nkVec2   rng_v2      (RngState* rng);
+GLOBAL nkVec3   rng_v3      (RngState* rng);
+GLOBAL nkVec4   rng_v4      (RngState* rng);
+GLOBAL nkS32    rng_s32     (RngState* rng, nkS32  min, nkS32  max);
+GLOBAL nkF32    rng_f32     (RngState* rng, nkF32  min, nkF32  max);
+GLOBAL nkVec2   rng_v2      (RngState* rng, nkVec2 min, nkVec2 max);
+GLOBAL nkVec3   rng_v3      (RngState* rng, nkVec3 min, nkVec3 max);
+GLOBAL nkVec4   rng_v4      (RngState* rng, nkVec4 min, nkVec4 max);
+GLOBAL void     rng_fill_u32(RngState* rng, nkU32* out, nkU64 count); // The bulk fills give the same numbers as calling
+GLOBAL void     rng_fill_f32(RngState* rng, nkF32* out, nkU64 count); // the single versions count times, just faster.
+GLOBAL void     rng_fill_f32(RngState* rng, nkF32* out, nkU64 count, nkF32 min, nkF32 max);
 
 // String parsing helpers.
 GLOBAL nkChar* str_eat_space(nkChar** str);
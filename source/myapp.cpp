@@ -36,10 +36,10 @@ GLOBAL void app_tick(nkF32 dt)
     g_face_angle = nk_sin_range(MIN_FACE_ROTATION, MAX_FACE_ROTATION, g_face_timer * ROTATION_SPEED);
     g_face_angle = nk_clamp(g_face_angle * 2.5f, MIN_FACE_ROTATION, MAX_FACE_ROTATION);
 
-    #if defined(BUILD_DEBUG)
+    #if defined(BUILD_DEBUG) && !defined(BUILD_HEADLESS)
     if(is_debug_ui_enabled())
         ImGui::ShowDemoWindow();
-    #endif // BUILD_DEBUG
+    #endif // BUILD_DEBUG && !BUILD_HEADLESS
 }
 
 GLOBAL void app_draw(void)
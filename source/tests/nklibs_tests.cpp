@@ -0,0 +1,69 @@
+/*////////////////////////////////////////////////////////////////////////////*/
+
+#define NK_TEST_IMPLEMENTATION
+#define NK_PRINT_IMPLEMENTATION
+
+#define NK_STATIC
+
+#include <stdio.h>
+
+#include <nk_test.h>
+#include <nk_print.h>
+#include <nk_array.h>
+#include <nk_string.h>
+
+// Short strings point into themselves so arrays of them have to move each
+// string with its move constructor, rather than copying the bytes around.
+static nkBool test_array_of_short_strings(void)
+{
+    nkTestContext ctx = {};
+    NK_TEST_BEGIN(&ctx, "nkArray<nkString> of short strings");
+
+    nkArray<nkString> array;
+
+    // Enough appends to make the array grow a couple of times.
+    for(nkS32 i=0; i<40; ++i)
+        nk_array_append(&array, nkString("short"));
+
+    NK_TEST_CHECK(&ctx, array.length == 40);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[0].cstr, "short") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[39].cstr, "short") == 0);
+
+    nkString strings[2] = { nkString("first"), nkString("second") };
+    nk_array_insert(&array, 0, strings, 2);
+    nk_array_insert(&array, 20, nkString("middle"));
+    nk_array_append(&array, nkString("a string long enough to not fit inside of the string itself"));
+
+    NK_TEST_CHECK(&ctx, array.length == 44);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[0].cstr, "first") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[1].cstr, "second") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[20].cstr, "middle") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[42].cstr, "short") == 0);
+
+    nk_array_remove(&array, 0, 2);
+    nk_array_remove(&array, 18);
+
+    NK_TEST_CHECK(&ctx, array.length == 41);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[0].cstr, "short") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(array.data[18].cstr, "short") == 0);
+    NK_TEST_CHECK(&ctx, strcmp(nk_array_last(&array).cstr, "a string long enough to not fit inside of the string itself") == 0);
+
+    nkArray<nkString> copy = array;
+    nk_array_clear(&array);
+
+    NK_TEST_CHECK(&ctx, copy.length == 41);
+    NK_TEST_CHECK(&ctx, strcmp(copy.data[40].cstr, "a string long enough to not fit inside of the string itself") == 0);
+
+    NK_TEST_END(&ctx);
+
+    return (ctx.checks_passed == ctx.checks_performed);
+}
+
+int main(int argc, char** argv)
+{
+    nkBool success = NK_TRUE;
+    success &= test_array_of_short_strings();
+    return (success) ? 0 : 1;
+}
+
+/*////////////////////////////////////////////////////////////////////////////*/